@@ -0,0 +1,869 @@
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+    #define _POSIX_C_SOURCE 199309L
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <gl2d.h>
+
+#if defined(_WIN32)
+    #define WIN32_LEAN_AND_MEAN
+    #include <windows.h>
+#else
+    #include <time.h>
+    #include <EGL/egl.h>
+    #include <EGL/eglext.h>
+#endif
+
+// output is one "benchmark,metric,value" row per measurement so CI can diff runs
+
+#define POINT_COUNT 100000
+#define ITERATIONS 200
+#define MATRIX_COUNT 10000
+
+#define TARGET_WIDTH 640
+#define TARGET_HEIGHT 360
+#define SPRITE_COUNT 10000
+#define COMMAND_COUNT 1000
+#define TEXTURE_COUNT 64
+#define SHADER_COUNT 16
+#define WARMUP_FRAMES 10
+#define FRAME_COUNT 100
+
+#define SPATIAL_MAX_SPRITES 1000000
+#define SPATIAL_AREA_PER_SPRITE 576.0f
+#define SPATIAL_CELL_SIZE 64.0f
+#define SPATIAL_VIEW_WIDTH 1280.0f
+#define SPATIAL_VIEW_HEIGHT 720.0f
+#define SPATIAL_QUERIES 200
+
+#define TILEMAP_SIZE 1024
+#define TILEMAP_TILE_SIZE 16.0f
+#define TILESET_COLUMNS 4
+#define PRIMITIVE_COUNT 1000
+
+#define CHECK_MATRIX_COUNT 1000
+#define CHECK_TOLERANCE 1e-5
+
+static volatile double sink;
+
+static double Now() {
+#if defined(_WIN32)
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart / (double)frequency.QuadPart;
+#else
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double)time.tv_sec + (double)time.tv_nsec * 1e-9;
+#endif
+}
+
+static void Report(const char* name, const char* metric, double value) {
+    printf("%s,%s,%.4f\n", name, metric, value);
+}
+
+static void ReportKernel(const char* name, double seconds, double operations, double checksum) {
+    // the checksum only keeps the work from being optimized away
+    sink += checksum;
+    Report(name, "ns_per_op", seconds * 1e9 / operations);
+}
+
+static uint32_t NextRandom(uint32_t* state) {
+    *state = *state * 1664525u + 1013904223u;
+    return *state >> 8;
+}
+
+static float RandomRange(uint32_t* state, float range) {
+    return (float)NextRandom(state) / (float)(1u << 24) * range;
+}
+
+// Multiply and transform keep the scalar code's operation order in every SIMD path, so they're
+// checked against the same formulas here. The SIMD inverse is a different formulation and is
+// checked against a double precision elimination instead. Errors are relative to the largest
+// element of the expected result, the tolerance leaves room for FMA contraction of the reference.
+static void ReferenceMat4Mult(GL2D_Matrix4f* result, const GL2D_Matrix4f* matrix1, const GL2D_Matrix4f* matrix2) {
+    for (uint32_t i = 0; i < 4; i++) {
+        for (uint32_t j = 0; j < 4; j++) {
+            result->data[i][j] = matrix1->data[0][j] * matrix2->data[i][0] +
+                                 matrix1->data[1][j] * matrix2->data[i][1] +
+                                 matrix1->data[2][j] * matrix2->data[i][2] +
+                                 matrix1->data[3][j] * matrix2->data[i][3];
+        }
+    }
+}
+
+static void ReferenceMat4Inverse(double result[4][4], const GL2D_Matrix4f* matrix) {
+    double work[4][8];
+
+    for (uint32_t i = 0; i < 4; i++) {
+        for (uint32_t j = 0; j < 4; j++) {
+            work[i][j] = matrix->data[i][j];
+            work[i][j + 4] = i == j;
+        }
+    }
+
+    for (uint32_t column = 0; column < 4; column++) {
+        uint32_t pivot = column;
+
+        for (uint32_t i = column + 1; i < 4; i++) {
+            pivot = fabs(work[i][column]) > fabs(work[pivot][column]) ? i : pivot;
+        }
+
+        for (uint32_t j = 0; j < 8; j++) {
+            double swap = work[column][j];
+            work[column][j] = work[pivot][j];
+            work[pivot][j] = swap;
+        }
+
+        double scale = 1.0 / work[column][column];
+
+        for (uint32_t j = 0; j < 8; j++) {
+            work[column][j] *= scale;
+        }
+
+        for (uint32_t i = 0; i < 4; i++) {
+            double factor = work[i][column];
+
+            for (uint32_t j = 0; j < 8 && i != column; j++) {
+                work[i][j] -= factor * work[column][j];
+            }
+        }
+    }
+
+    for (uint32_t i = 0; i < 4; i++) {
+        for (uint32_t j = 0; j < 4; j++) {
+            result[i][j] = work[i][j + 4];
+        }
+    }
+}
+
+static double RelativeError(const float* values, const double* expected, uint32_t count) {
+    double error = 0;
+    double magnitude = 1;
+
+    for (uint32_t i = 0; i < count; i++) {
+        double difference = fabs(values[i] - expected[i]);
+        error = difference > error ? difference : error;
+        magnitude = fabs(expected[i]) > magnitude ? fabs(expected[i]) : magnitude;
+    }
+
+    return error / magnitude;
+}
+
+static bool CheckKernel(const char* name, double error, double tolerance) {
+    if (error > tolerance) {
+        fprintf(stderr, "ERROR: %s differs from the scalar reference, relative error %g\n", name, error);
+        return false;
+    }
+
+    return true;
+}
+
+static bool CheckMathKernels() {
+    uint32_t random = 7;
+    double multError = 0, inverseError = 0, transformError = 0, arrayError = 0, soaError = 0;
+
+    for (uint32_t n = 0; n < CHECK_MATRIX_COUNT; n++) {
+        GL2D_Matrix4f matrix1, matrix2, product, expected, inverse;
+        double expectedInverse[4][4];
+
+        // diagonally dominant, so every matrix is comfortably invertible
+        for (uint32_t i = 0; i < 16; i++) {
+            (&matrix1.data[0][0])[i] = RandomRange(&random, 4) - 2 + (i % 5 == 0 ? 8 : 0);
+            (&matrix2.data[0][0])[i] = RandomRange(&random, 200) - 100;
+        }
+
+        GL2D_Mat4MultTo(&product, &matrix1, &matrix2);
+        ReferenceMat4Mult(&expected, &matrix1, &matrix2);
+
+        double expectedProduct[16];
+
+        for (uint32_t i = 0; i < 16; i++) {
+            expectedProduct[i] = (&expected.data[0][0])[i];
+        }
+
+        double error = RelativeError(&product.data[0][0], expectedProduct, 16);
+        multError = error > multError ? error : multError;
+
+        if (!GL2D_Mat4InverseTo(&inverse, &matrix1)) {
+            fprintf(stderr, "ERROR: GL2D_Mat4InverseTo rejected an invertible matrix\n");
+            return false;
+        }
+
+        ReferenceMat4Inverse(expectedInverse, &matrix1);
+        error = RelativeError(&inverse.data[0][0], &expectedInverse[0][0], 16);
+        inverseError = error > inverseError ? error : inverseError;
+
+        // odd counts so the SIMD bodies and the scalar tails both run
+        GL2D_Vector2f points[7], results[7];
+        float x[7], y[7], resultX[7], resultY[7];
+        const float* m = &matrix2.data[0][0];
+
+        for (uint32_t i = 0; i < 7; i++) {
+            points[i].x = x[i] = RandomRange(&random, 1000) - 500;
+            points[i].y = y[i] = RandomRange(&random, 1000) - 500;
+        }
+
+        GL2D_Mat4TransformPoints(&matrix2, points, results, 7);
+        GL2D_Mat4TransformPointsSoA(&matrix2, x, y, resultX, resultY, 7);
+
+        for (uint32_t i = 0; i < 7; i++) {
+            double expectedPoint[2] = { m[0] * points[i].x + m[4] * points[i].y + m[8] + m[12], m[1] * points[i].x + m[5] * points[i].y + m[9] + m[13] };
+            GL2D_Vector2f single = GL2D_Mat4Vec2Mult(matrix2, points[i]);
+            float soa[2] = { resultX[i], resultY[i] };
+
+            error = RelativeError(&single.x, expectedPoint, 2);
+            transformError = error > transformError ? error : transformError;
+            error = RelativeError(&results[i].x, expectedPoint, 2);
+            arrayError = error > arrayError ? error : arrayError;
+            error = RelativeError(soa, expectedPoint, 2);
+            soaError = error > soaError ? error : soaError;
+        }
+    }
+
+    bool passed = CheckKernel("GL2D_Mat4MultTo", multError, CHECK_TOLERANCE);
+    passed = CheckKernel("GL2D_Mat4InverseTo", inverseError, CHECK_TOLERANCE) && passed;
+    passed = CheckKernel("GL2D_Mat4Vec2Mult", transformError, CHECK_TOLERANCE) && passed;
+    passed = CheckKernel("GL2D_Mat4TransformPoints", arrayError, CHECK_TOLERANCE) && passed;
+    passed = CheckKernel("GL2D_Mat4TransformPointsSoA", soaError, CHECK_TOLERANCE) && passed;
+
+    return passed;
+}
+
+static void RunMathBenchmarks() {
+    GL2D_Vector2f* points = malloc(POINT_COUNT * sizeof(GL2D_Vector2f));
+    GL2D_Vector2f* results = malloc(POINT_COUNT * sizeof(GL2D_Vector2f));
+    float* x = malloc(POINT_COUNT * sizeof(float));
+    float* y = malloc(POINT_COUNT * sizeof(float));
+    float* resultX = malloc(POINT_COUNT * sizeof(float));
+    float* resultY = malloc(POINT_COUNT * sizeof(float));
+    GL2D_Matrix4f* matrices = malloc(MATRIX_COUNT * sizeof(GL2D_Matrix4f));
+    GL2D_Affine2D* affines = malloc(MATRIX_COUNT * sizeof(GL2D_Affine2D));
+
+    if (points == NULL || results == NULL || x == NULL || y == NULL || resultX == NULL || resultY == NULL || matrices == NULL || affines == NULL) {
+        fprintf(stderr, "ERROR: Couldn't allocate benchmark data\n");
+        exit(1);
+    }
+
+    for (uint32_t i = 0; i < POINT_COUNT; i++) {
+        points[i].x = x[i] = (float)(i % 1000) - 500.0f;
+        points[i].y = y[i] = (float)(i / 1000) - 50.0f;
+    }
+
+    GL2D_Matrix4f matrix = GL2D_Mat4InitIdentity();
+    matrix = GL2D_Mat4Scale(matrix, (GL2D_Vector2f) { 2, 3 });
+    matrix = GL2D_Mat4Translate(matrix, (GL2D_Vector2f) { 10, -4 });
+
+    for (uint32_t i = 0; i < MATRIX_COUNT; i++) {
+        GL2D_Transform transform = { { (float)i, (float)(i % 100) }, { (float)(i % 360), 0 }, { 1, 1 } };
+        affines[i] = GL2D_TransformToAffine(transform);
+        matrices[i] = GL2D_AffineToMat4(affines[i]);
+    }
+
+    const double pointOps = (double)POINT_COUNT * ITERATIONS;
+    const double matrixOps = (double)MATRIX_COUNT * ITERATIONS;
+    double start = Now();
+    for (uint32_t n = 0; n < ITERATIONS; n++) {
+        for (uint32_t i = 0; i < POINT_COUNT; i++) {
+            results[i] = GL2D_Mat4Vec2Mult(matrix, points[i]);
+        }
+    }
+    ReportKernel("transform_per_element", Now() - start, pointOps, results[POINT_COUNT - 1].x);
+
+    start = Now();
+    for (uint32_t n = 0; n < ITERATIONS; n++) {
+        GL2D_Mat4TransformPoints(&matrix, points, results, POINT_COUNT);
+    }
+    ReportKernel("transform_array", Now() - start, pointOps, results[POINT_COUNT - 1].x);
+
+    start = Now();
+    for (uint32_t n = 0; n < ITERATIONS; n++) {
+        GL2D_Mat4TransformPointsSoA(&matrix, x, y, resultX, resultY, POINT_COUNT);
+    }
+    ReportKernel("transform_array_soa", Now() - start, pointOps, resultX[POINT_COUNT - 1]);
+
+    start = Now();
+    for (uint32_t n = 0; n < ITERATIONS; n++) {
+        for (uint32_t i = 0; i < POINT_COUNT; i++) {
+            results[i] = GL2D_VecRotate(points[i], 30.0f);
+        }
+    }
+    ReportKernel("rotate_per_element", Now() - start, pointOps, results[POINT_COUNT - 1].x);
+
+    start = Now();
+    for (uint32_t n = 0; n < ITERATIONS; n++) {
+        GL2D_VecArrayRotate(points, 30.0f, results, POINT_COUNT);
+    }
+    ReportKernel("rotate_array", Now() - start, pointOps, results[POINT_COUNT - 1].x);
+
+    start = Now();
+    for (uint32_t n = 0; n < ITERATIONS; n++) {
+        for (uint32_t i = 0; i < POINT_COUNT; i++) {
+            results[i] = GL2D_VecNormalize(points[i]);
+        }
+    }
+    ReportKernel("normalize_per_element", Now() - start, pointOps, results[POINT_COUNT - 1].x);
+
+    start = Now();
+    for (uint32_t n = 0; n < ITERATIONS; n++) {
+        GL2D_VecArrayNormalize(points, results, POINT_COUNT);
+    }
+    ReportKernel("normalize_array", Now() - start, pointOps, results[POINT_COUNT - 1].x);
+
+    start = Now();
+    for (uint32_t n = 0; n < ITERATIONS; n++) {
+        GL2D_VecArrayNormalizeSoA(x, y, resultX, resultY, POINT_COUNT);
+    }
+    ReportKernel("normalize_array_soa", Now() - start, pointOps, resultX[POINT_COUNT - 1]);
+
+    start = Now();
+    for (uint32_t n = 0; n < ITERATIONS; n++) {
+        for (uint32_t i = 0; i < MATRIX_COUNT; i++) {
+            matrix = GL2D_Mat4Mult(matrices[i], matrix);
+        }
+    }
+    ReportKernel("mat4_mult", Now() - start, matrixOps, matrix.data[3][0]);
+
+    GL2D_Matrix4f product = GL2D_Mat4InitIdentity();
+
+    start = Now();
+    for (uint32_t n = 0; n < ITERATIONS; n++) {
+        for (uint32_t i = 0; i < MATRIX_COUNT; i++) {
+            GL2D_Mat4MultTo(&product, &matrices[i], &product);
+        }
+    }
+    ReportKernel("mat4_mult_to", Now() - start, matrixOps, product.data[3][0]);
+
+    GL2D_Affine2D affine = GL2D_AffineIdentity();
+
+    start = Now();
+    for (uint32_t n = 0; n < ITERATIONS; n++) {
+        for (uint32_t i = 0; i < MATRIX_COUNT; i++) {
+            GL2D_AffineMultTo(&affine, &affines[i], &affine);
+        }
+    }
+    ReportKernel("affine_mult", Now() - start, matrixOps, affine.data[2][0]);
+
+    start = Now();
+    for (uint32_t n = 0; n < ITERATIONS; n++) {
+        for (uint32_t i = 0; i < MATRIX_COUNT; i++) {
+            GL2D_Transform transform = { { (float)i, (float)n }, { (float)(i + n), 0 }, { 1, 1 } };
+            affines[i] = GL2D_TransformToAffine(transform);
+        }
+    }
+    ReportKernel("transform_to_affine", Now() - start, matrixOps, affines[MATRIX_COUNT - 1].data[2][0]);
+
+    free(points);
+    free(results);
+    free(x);
+    free(y);
+    free(resultX);
+    free(resultY);
+    free(matrices);
+    free(affines);
+}
+
+// World area grows with the sprite count at a fixed density, so the camera sees about the same
+// number of sprites at every size. The grid's query time should stay flat while a linear scan grows.
+static void RunSpatialBenchmarks() {
+    const uint32_t worldSizes[] = { 10000, 100000, 1000000 };
+    GL2D_Rectf* bounds = malloc(SPATIAL_MAX_SPRITES * sizeof(GL2D_Rectf));
+    GL2D_SpatialItem* items = malloc(SPATIAL_MAX_SPRITES * sizeof(GL2D_SpatialItem));
+    uint32_t* visible = malloc(SPATIAL_MAX_SPRITES * sizeof(uint32_t));
+
+    if (bounds == NULL || items == NULL || visible == NULL) {
+        fprintf(stderr, "ERROR: Couldn't allocate benchmark data\n");
+        exit(1);
+    }
+
+    for (uint32_t size = 0; size < sizeof(worldSizes) / sizeof(worldSizes[0]); size++) {
+        uint32_t count = worldSizes[size];
+        float side = sqrtf((float)count * SPATIAL_AREA_PER_SPRITE);
+        GL2D_SpatialGrid grid = GL2D_CreateSpatialGrid((GL2D_Rectf) { 0, 0, side, side }, SPATIAL_CELL_SIZE);
+        uint32_t random = 1;
+        char name[64];
+
+        for (uint32_t i = 0; i < count; i++) {
+            bounds[i] = (GL2D_Rectf) { RandomRange(&random, side), RandomRange(&random, side), 8 + RandomRange(&random, 24), 8 + RandomRange(&random, 24) };
+            items[i] = GL2D_SpatialGridInsert(grid, bounds[i], i);
+        }
+
+        GL2D_Camera camera = { { 0, 0 }, { SPATIAL_VIEW_WIDTH, SPATIAL_VIEW_HEIGHT }, 1, 0 };
+        uint64_t visibleTotal = 0;
+        double start = Now();
+
+        for (uint32_t n = 0; n < SPATIAL_QUERIES; n++) {
+            camera.position = (GL2D_Vector2f) { RandomRange(&random, side), RandomRange(&random, side) };
+            visibleTotal += GL2D_CameraQueryVisible(&camera, grid, visible, SPATIAL_MAX_SPRITES);
+        }
+
+        snprintf(name, sizeof(name), "spatial_query_%u", count);
+        Report(name, "ns_per_query", (Now() - start) * 1e9 / SPATIAL_QUERIES);
+        Report(name, "visible_per_query", (double)visibleTotal / SPATIAL_QUERIES);
+
+        // the same views answered by testing every sprite, what submitting everything costs at best
+        uint64_t linearTotal = 0;
+        start = Now();
+
+        for (uint32_t n = 0; n < SPATIAL_QUERIES; n++) {
+            camera.position = (GL2D_Vector2f) { RandomRange(&random, side), RandomRange(&random, side) };
+            GL2D_Rectf view = GL2D_CameraGetVisibleRect(&camera);
+
+            for (uint32_t i = 0; i < count; i++) {
+                const GL2D_Rectf* box = &bounds[i];
+
+                if (box->x + box->width >= view.x && box->x <= view.x + view.width && box->y + box->height >= view.y && box->y <= view.y + view.height) {
+                    visible[linearTotal++ % SPATIAL_MAX_SPRITES] = i;
+                }
+            }
+        }
+
+        Report(name, "linear_ns_per_query", (Now() - start) * 1e9 / SPATIAL_QUERIES);
+
+        start = Now();
+
+        for (uint32_t i = 0; i < count; i++) {
+            bounds[i].x += RandomRange(&random, 8) - 4;
+            bounds[i].y += RandomRange(&random, 8) - 4;
+            GL2D_SpatialGridMove(grid, items[i], bounds[i]);
+        }
+
+        snprintf(name, sizeof(name), "spatial_move_%u", count);
+        ReportKernel(name, Now() - start, count, visible[0]);
+
+        GL2D_DestroySpatialGrid(grid);
+    }
+
+    free(bounds);
+    free(items);
+    free(visible);
+}
+
+#if !defined(_WIN32)
+
+typedef struct Scene {
+    GL2D_Renderer renderer;
+    GL2D_Matrix4f projection;
+    GL2D_Texture textures[TEXTURE_COUNT];
+    GL2D_Shader shaders[SHADER_COUNT];
+    GL2D_Uniform transformUniforms[SHADER_COUNT];
+    GL2D_VertexBuffer quadVbo;
+    GL2D_IndexBuffer quadIbo;
+    GL2D_VertexArray quadVao;
+    GL2D_RenderQueue queue;
+    GL2D_Transform* sprites;
+    GL2D_Vector2f* velocities;
+    GL2D_SpriteInstance* instances;
+    GL2D_Tilemap tilemap;
+} Scene;
+
+typedef void (*SceneFrameProc)(Scene* scene, uint32_t frame);
+
+static const char* commandVertexSource =
+    "#version 330 core\n"
+    "layout (location = 0) in vec2 aPos;\n"
+    "uniform mat4 uTransform;\n"
+    "void main() {\n"
+    "    gl_Position = uTransform * vec4(aPos, 0.0, 1.0);\n"
+    "}\n";
+
+static const char* commandFragmentFormat =
+    "#version 330 core\n"
+    "out vec4 FragColor;\n"
+    "void main() {\n"
+    "    FragColor = vec4(%f, %f, %f, 1.0);\n"
+    "}\n";
+
+// llvmpipe works without a GPU or a display server, the surfaceless platform avoids needing X at all
+static bool CreateHeadlessContext() {
+    PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    EGLDisplay display = EGL_NO_DISPLAY;
+
+    if (getPlatformDisplay != NULL) {
+        display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+    }
+
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, NULL, NULL)) {
+        display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+        if (display == EGL_NO_DISPLAY || !eglInitialize(display, NULL, NULL)) {
+            fprintf(stderr, "ERROR: Couldn't initialize an EGL display\n");
+            return false;
+        }
+    }
+
+    if (!eglBindAPI(EGL_OPENGL_API)) {
+        fprintf(stderr, "ERROR: EGL display doesn't support desktop OpenGL\n");
+        return false;
+    }
+
+    const EGLint configAttributes[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8,
+        EGL_GREEN_SIZE, 8,
+        EGL_BLUE_SIZE, 8,
+        EGL_ALPHA_SIZE, 8,
+        EGL_DEPTH_SIZE, 24,
+        EGL_NONE,
+    };
+
+    EGLConfig config;
+    EGLint configCount = 0;
+
+    if (!eglChooseConfig(display, configAttributes, &config, 1, &configCount) || configCount == 0) {
+        fprintf(stderr, "ERROR: No pbuffer capable EGL config\n");
+        return false;
+    }
+
+    const EGLint surfaceAttributes[] = { EGL_WIDTH, TARGET_WIDTH, EGL_HEIGHT, TARGET_HEIGHT, EGL_NONE };
+    EGLSurface surface = eglCreatePbufferSurface(display, config, surfaceAttributes);
+
+    const EGLint contextAttributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE,
+    };
+
+    EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+
+    if (surface == EGL_NO_SURFACE || context == EGL_NO_CONTEXT || !eglMakeCurrent(display, surface, surface, context)) {
+        fprintf(stderr, "ERROR: Couldn't create a GL 3.3 core context: 0x%x\n", eglGetError());
+        return false;
+    }
+
+    return true;
+}
+
+static bool CreateScene(Scene* scene) {
+    memset(scene, 0, sizeof(Scene));
+
+    GL2D_RendererDesc desc = { 0 };
+    desc.loadProc = (GL2D_GLLoadProc)eglGetProcAddress;
+    scene->renderer = GL2D_CreateRendererEx(&desc);
+
+    if (scene->renderer == NULL) {
+        return false;
+    }
+
+    GL2D_SetViewport((GL2D_Rect) { 0, 0, TARGET_WIDTH, TARGET_HEIGHT });
+    scene->projection = GL2D_Mat4Ortho(0, TARGET_WIDTH, 0, TARGET_HEIGHT);
+
+    uint8_t pixels[16 * 16 * 4];
+
+    for (uint32_t i = 0; i < TEXTURE_COUNT; i++) {
+        memset(pixels, (int)(i * 4), sizeof(pixels));
+        scene->textures[i] = GL2D_CreateTextureFromPixels(pixels, 16, 16);
+    }
+
+    char fragmentSource[256];
+
+    for (uint32_t i = 0; i < SHADER_COUNT; i++) {
+        float shade = (float)i / SHADER_COUNT;
+        snprintf(fragmentSource, sizeof(fragmentSource), commandFragmentFormat, shade, 1.0f - shade, 0.5f);
+        scene->shaders[i] = GL2D_CreateShaderFromSource(commandVertexSource, fragmentSource);
+        scene->transformUniforms[i] = GL2D_ShaderGetUniform(scene->shaders[i], "uTransform");
+    }
+
+    const float vertices[] = { -0.5f, -0.5f, 0.5f, -0.5f, 0.5f, 0.5f, -0.5f, 0.5f };
+    // clockwise, the renderer culls counter-clockwise faces
+    const uint32_t indices[] = { 0, 3, 2, 2, 1, 0 };
+
+    scene->quadVbo = GL2D_CreateVertexBuffer(vertices, sizeof(vertices));
+    scene->quadIbo = GL2D_CreateIndexBuffer(indices, sizeof(indices));
+
+    GL2D_VertexLayout layout = { 0 };
+    GL2D_VertexLayoutAdd(&layout, 0, GL2D_ATTRIBUTE_FLOAT, 2, false);
+    scene->quadVao = GL2D_GetVertexArray(&layout, scene->quadVbo, scene->quadIbo);
+
+    scene->queue = GL2D_CreateRenderQueue(COMMAND_COUNT);
+    scene->sprites = malloc(SPRITE_COUNT * sizeof(GL2D_Transform));
+    scene->velocities = malloc(SPRITE_COUNT * sizeof(GL2D_Vector2f));
+    scene->instances = malloc(SPRITE_COUNT * sizeof(GL2D_SpriteInstance));
+
+    if (scene->queue == NULL || scene->sprites == NULL || scene->velocities == NULL || scene->instances == NULL) {
+        fprintf(stderr, "ERROR: Couldn't allocate scene data\n");
+        return false;
+    }
+
+    // fixed seed so every run draws the same scene
+    srand(1234);
+
+    for (uint32_t i = 0; i < SPRITE_COUNT; i++) {
+        scene->sprites[i].position = (GL2D_Vector2f) { (float)(rand() % TARGET_WIDTH), (float)(rand() % TARGET_HEIGHT) };
+        scene->sprites[i].rotation = (GL2D_Vector2f) { (float)(rand() % 360), 0 };
+        scene->sprites[i].scale = (GL2D_Vector2f) { 16, 16 };
+        scene->velocities[i] = (GL2D_Vector2f) { (float)(rand() % 200 - 100) * 0.05f, (float)(rand() % 200 - 100) * 0.05f };
+
+        scene->instances[i].transform = GL2D_TransformToAffine(scene->sprites[i]);
+        scene->instances[i].uv = (GL2D_Rectf) { 0, 0, 1, 1 };
+        scene->instances[i].color = (GL2D_Color) { 255, 255, 255, 255 };
+    }
+
+    GL2D_TilemapDesc tilemapDesc = { 0 };
+    tilemapDesc.width = TILEMAP_SIZE;
+    tilemapDesc.height = TILEMAP_SIZE;
+    tilemapDesc.tileSize = TILEMAP_TILE_SIZE;
+    tilemapDesc.tileset = scene->textures[1];
+    tilemapDesc.tilesetColumns = TILESET_COLUMNS;
+    tilemapDesc.tilesetRows = TILESET_COLUMNS;
+    scene->tilemap = GL2D_CreateTilemap(&tilemapDesc);
+
+    if (scene->tilemap == NULL) {
+        return false;
+    }
+
+    for (uint32_t y = 0; y < TILEMAP_SIZE; y++) {
+        for (uint32_t x = 0; x < TILEMAP_SIZE; x++) {
+            GL2D_TilemapSetTile(scene->tilemap, x, y, (uint16_t)(rand() % (TILESET_COLUMNS * TILESET_COLUMNS + 1)));
+        }
+    }
+
+    GL2D_TilemapSetAnimation(scene->tilemap, 1, TILESET_COLUMNS, 0.25f);
+
+    return true;
+}
+
+static void DestroyScene(Scene* scene) {
+    if (scene->renderer == NULL) {
+        return;
+    }
+
+    for (uint32_t i = 0; i < TEXTURE_COUNT; i++) {
+        GL2D_DestroyTexture(scene->textures[i]);
+    }
+
+    for (uint32_t i = 0; i < SHADER_COUNT; i++) {
+        GL2D_DestroyShader(scene->shaders[i]);
+    }
+
+    GL2D_DestroyVertexBuffer(scene->quadVbo);
+    GL2D_DestroyIndexBuffer(scene->quadIbo);
+
+    if (scene->queue != NULL) {
+        GL2D_DestroyRenderQueue(scene->queue);
+    }
+
+    free(scene->sprites);
+    free(scene->velocities);
+    free(scene->instances);
+
+    GL2D_DestroyTilemap(scene->tilemap);
+    GL2D_DestroyRenderer(scene->renderer);
+}
+
+static void StaticSpritesFrame(Scene* scene, uint32_t frame) {
+    (void)frame;
+
+    GL2D_BeginBatch(scene->renderer, scene->projection);
+
+    for (uint32_t i = 0; i < SPRITE_COUNT; i++) {
+        GL2D_DrawQuad(scene->renderer, scene->sprites[i], scene->textures[0], (GL2D_Color) { 255, 255, 255, 255 });
+    }
+
+    GL2D_EndBatch(scene->renderer);
+}
+
+static void MovingSpritesFrame(Scene* scene, uint32_t frame) {
+    (void)frame;
+
+    for (uint32_t i = 0; i < SPRITE_COUNT; i++) {
+        GL2D_Transform* sprite = &scene->sprites[i];
+        GL2D_Vector2f* velocity = &scene->velocities[i];
+
+        sprite->position = GL2D_VecAdd(sprite->position, *velocity);
+        sprite->rotation.x += 1.0f;
+
+        if (sprite->position.x < 0 || sprite->position.x > TARGET_WIDTH) {
+            velocity->x = -velocity->x;
+        }
+
+        if (sprite->position.y < 0 || sprite->position.y > TARGET_HEIGHT) {
+            velocity->y = -velocity->y;
+        }
+    }
+
+    StaticSpritesFrame(scene, frame);
+}
+
+static void InstancedSpritesFrame(Scene* scene, uint32_t frame) {
+    (void)frame;
+
+    GL2D_BeginBatch(scene->renderer, scene->projection);
+    GL2D_DrawInstanced(scene->renderer, scene->textures[0], scene->instances, SPRITE_COUNT);
+    GL2D_EndBatch(scene->renderer);
+}
+
+static void TextureSwitchFrame(Scene* scene, uint32_t frame) {
+    (void)frame;
+
+    GL2D_BeginBatch(scene->renderer, scene->projection);
+
+    // more textures than batch slots, so the batch keeps flushing
+    for (uint32_t i = 0; i < SPRITE_COUNT; i++) {
+        GL2D_DrawQuad(scene->renderer, scene->sprites[i], scene->textures[i % TEXTURE_COUNT], (GL2D_Color) { 255, 255, 255, 255 });
+    }
+
+    GL2D_EndBatch(scene->renderer);
+}
+
+static void ShaderSwitchFrame(Scene* scene, uint32_t frame) {
+    (void)frame;
+
+    for (uint32_t i = 0; i < COMMAND_COUNT; i++) {
+        const GL2D_Transform* sprite = &scene->sprites[i];
+        GL2D_DrawCommand command = { 0 };
+
+        command.shader = scene->shaders[i % SHADER_COUNT];
+        command.vertexArray = scene->quadVao;
+        command.count = 6;
+        command.indexed = true;
+        command.depth = (float)i / COMMAND_COUNT;
+        command.transformUniform = scene->transformUniforms[i % SHADER_COUNT];
+        command.transform = GL2D_Mat4Mult(scene->projection, GL2D_AffineToMat4(GL2D_TransformToAffine(*sprite)));
+
+        GL2D_RenderQueuePush(scene->queue, &command);
+    }
+
+    GL2D_RenderQueueSubmit(scene->renderer, scene->queue);
+}
+
+// Scrolls across the map with animated tiles, one tile changes every frame to keep a chunk dirty
+static void TilemapFrame(Scene* scene, uint32_t frame) {
+    GL2D_Camera camera = { { TARGET_WIDTH * 0.5f + frame * 7.0f, TARGET_HEIGHT * 0.5f + frame * 3.0f }, { TARGET_WIDTH, TARGET_HEIGHT }, 1.0f, 0.0f };
+    uint32_t tileX = (uint32_t)(camera.position.x / TILEMAP_TILE_SIZE);
+    uint32_t tileY = (uint32_t)(camera.position.y / TILEMAP_TILE_SIZE);
+
+    GL2D_TilemapSetTile(scene->tilemap, tileX, tileY, (uint16_t)(frame % (TILESET_COLUMNS * TILESET_COLUMNS) + 1));
+    GL2D_TilemapAdvance(scene->tilemap, 1.0f / 60.0f);
+
+    GL2D_BeginBatch(scene->renderer, GL2D_CameraGetMatrix(&camera));
+    GL2D_DrawTilemap(scene->renderer, scene->tilemap, (GL2D_Vector2f) { 0, 0 });
+    GL2D_EndBatch(scene->renderer);
+}
+
+// Static shapes hit the tessellation cache, the polylines follow the sprites and are rebuilt
+static void PrimitivesFrame(Scene* scene, uint32_t frame) {
+    (void)frame;
+
+    GL2D_BeginBatch(scene->renderer, scene->projection);
+
+    for (uint32_t i = 0; i < PRIMITIVE_COUNT; i++) {
+        const GL2D_Transform* sprite = &scene->sprites[i];
+        GL2D_Color color = { 255, 255, 255, 128 };
+
+        switch (i % 4) {
+            case 0:
+                GL2D_DrawCircle(scene->renderer, sprite->position, 4.0f + i % 8, color);
+                break;
+            case 1:
+                GL2D_DrawCircleOutline(scene->renderer, sprite->position, 8.0f, 2.0f, color);
+                break;
+            case 2:
+                GL2D_DrawRoundedRect(scene->renderer, (GL2D_Rectf) { sprite->position.x, sprite->position.y, 24, 16 }, 4, color);
+                break;
+            default: {
+                const GL2D_Vector2f points[3] = { sprite->position, scene->sprites[i + 1].position, scene->sprites[i + 2].position };
+                GL2D_DrawPolyline(scene->renderer, points, 3, 2.0f, false, color);
+                break;
+            }
+        }
+
+        GL2D_DrawQuad(scene->renderer, *sprite, scene->textures[0], color);
+    }
+
+    GL2D_EndBatch(scene->renderer);
+}
+
+static void RunScene(Scene* scene, const char* name, SceneFrameProc frameProc) {
+    double cpuTime = 0;
+    double wallStart = 0;
+    uint64_t allocations = 0;
+    uint64_t drawCalls = 0;
+    uint64_t stateChanges = 0;
+
+    for (uint32_t frame = 0; frame < WARMUP_FRAMES + FRAME_COUNT; frame++) {
+        if (frame == WARMUP_FRAMES) {
+            cpuTime = 0;
+            allocations = drawCalls = stateChanges = 0;
+            wallStart = Now();
+        }
+
+        double start = Now();
+
+        frameProc(scene, frame);
+        GL2D_UpdateRenderer(scene->renderer);
+
+        cpuTime += Now() - start;
+
+        // stats describe the frame UpdateRenderer just closed
+        GL2D_FrameStats stats = GL2D_GetFrameStats(scene->renderer);
+        allocations += stats.heapAllocations;
+        drawCalls += stats.drawCalls;
+        stateChanges += stats.programChanges + stats.vertexArrayChanges + stats.bufferChanges + stats.textureChanges + stats.renderStateChanges;
+
+        // nothing is presented from a pbuffer, finish the frame so fps includes the rasterizer
+        eglWaitClient();
+    }
+
+    double wallTime = Now() - wallStart;
+
+    Report(name, "fps", FRAME_COUNT / wallTime);
+    Report(name, "cpu_ms_per_frame", cpuTime * 1000 / FRAME_COUNT);
+    Report(name, "allocations_per_frame", (double)allocations / FRAME_COUNT);
+    Report(name, "draw_calls_per_frame", (double)drawCalls / FRAME_COUNT);
+    Report(name, "state_changes_per_frame", (double)stateChanges / FRAME_COUNT);
+}
+
+static bool RunRenderBenchmarks() {
+    if (!CreateHeadlessContext()) {
+        return false;
+    }
+
+    Scene scene;
+
+    if (!CreateScene(&scene)) {
+        DestroyScene(&scene);
+        return false;
+    }
+
+    RunScene(&scene, "static_sprites", StaticSpritesFrame);
+    RunScene(&scene, "instanced_sprites", InstancedSpritesFrame);
+    RunScene(&scene, "texture_switch", TextureSwitchFrame);
+    RunScene(&scene, "shader_switch", ShaderSwitchFrame);
+    RunScene(&scene, "moving_sprites", MovingSpritesFrame);
+    RunScene(&scene, "tilemap", TilemapFrame);
+    RunScene(&scene, "primitives", PrimitivesFrame);
+
+    DestroyScene(&scene);
+    return true;
+}
+
+#else
+
+static bool RunRenderBenchmarks() {
+    fprintf(stderr, "Render benchmarks need EGL, skipping\n");
+    return true;
+}
+
+#endif
+
+int main() {
+    printf("benchmark,metric,value\n");
+
+    // timings of wrong results are worthless, stop before measuring anything
+    if (!CheckMathKernels()) {
+        return 1;
+    }
+
+    RunMathBenchmarks();
+    RunSpatialBenchmarks();
+
+    return RunRenderBenchmarks() ? 0 : 1;
+}
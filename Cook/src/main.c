@@ -0,0 +1,60 @@
+#include <stdio.h>
+#include <string.h>
+
+#include <gl2d.h>
+
+// gl2d-cook [--force] <source> <cooked> [<source> <cooked> ...]
+// gl2d-cook --pack <pack> <root> <file> [<file> ...]
+// Entries whose cooked file still matches the source content are skipped unless --force is given.
+// Packed files keep their path relative to root as their name inside the pack.
+int main(int argc, char** argv) {
+    if (argc > 1 && strcmp(argv[1], "--pack") == 0) {
+        if (argc < 5) {
+            fprintf(stderr, "usage: gl2d-cook --pack <pack> <root> <file> [<file> ...]\n");
+            return 1;
+        }
+
+        if (!GL2D_WriteAssetPack(argv[2], argv[3], (const char* const*)&argv[4], (uint32_t)(argc - 4))) {
+            return 1;
+        }
+
+        printf("%d files -> %s\n", argc - 4, argv[2]);
+
+        return 0;
+    }
+
+    bool force = false;
+    int first = 1;
+
+    if (argc > 1 && strcmp(argv[1], "--force") == 0) {
+        force = true;
+        first++;
+    }
+
+    if (argc - first < 2 || (argc - first) % 2 != 0) {
+        fprintf(stderr, "usage: gl2d-cook [--force] <source> <cooked> [<source> <cooked> ...]\n");
+        fprintf(stderr, "       gl2d-cook --pack <pack> <root> <file> [<file> ...]\n");
+        return 1;
+    }
+
+    int cooked = 0, skipped = 0, failed = 0;
+
+    for (int i = first; i < argc; i += 2) {
+        if (!force && !GL2D_CookedTextureIsStale(argv[i], argv[i + 1])) {
+            skipped++;
+            continue;
+        }
+
+        if (GL2D_CookTexture(argv[i], argv[i + 1])) {
+            printf("%s -> %s\n", argv[i], argv[i + 1]);
+            cooked++;
+        }
+        else {
+            failed++;
+        }
+    }
+
+    printf("%d cooked, %d up to date, %d failed\n", cooked, skipped, failed);
+
+    return failed > 0 ? 1 : 0;
+}
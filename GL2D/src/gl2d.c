@@ -2,15 +2,58 @@
     #define GL2D_USE_DLL
 #endif
 
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+    #define _POSIX_C_SOURCE 200809L
+#endif
+
 #include "gl2d.h"
 
 #include <stdint.h>
+#include <stddef.h>
 #include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
 #include <memory.h>
 #include <math.h>
+#include <errno.h>
+
+#ifdef GL2D_PLATFORM_WINDOWS
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+#else
+    #include <pthread.h>
+    #include <unistd.h>
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <dlfcn.h>
+    #include <time.h>
+#endif
+
+static void* MemAlloc(size_t size);
+static void* MemRealloc(void* memory, size_t size);
+static void MemFree(void* memory);
+
 #include <glad/glad.h>
 #define STB_IMAGE_IMPLEMENTATION
+#define STBI_MALLOC(size) MemAlloc(size)
+#define STBI_REALLOC(memory, size) MemRealloc(memory, size)
+#define STBI_FREE(memory) MemFree(memory)
 #include <stb/stb_image.h>
+#define STB_TRUETYPE_IMPLEMENTATION
+#define STBTT_STATIC
+#define STBTT_malloc(size, context) ((void)(context), MemAlloc(size))
+#define STBTT_free(memory, context) ((void)(context), MemFree(memory))
+// static keeps it private to gl2d.c, which only uses part of the API
+#if defined(__GNUC__)
+    #pragma GCC diagnostic push
+    #pragma GCC diagnostic ignored "-Wunused-function"
+#endif
+#include <stb/stb_truetype.h>
+#if defined(__GNUC__)
+    #pragma GCC diagnostic pop
+#endif
 
 #undef GL2D_API
 #ifdef GL2D_DLL_BUILD 
@@ -27,9 +70,92 @@
     #pragma warning(disable:4996)
 #endif
 
+// SIMD path is picked at compile time, define GL2D_NO_SIMD to force the scalar code
+#ifndef GL2D_NO_SIMD
+    #if defined(__AVX__)
+        #define GL2D_SIMD_AVX
+    #endif
+    #if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+        #define GL2D_SIMD_SSE2
+        #include <emmintrin.h>
+        #ifdef GL2D_SIMD_AVX
+            #include <immintrin.h>
+        #endif
+    #elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+        #define GL2D_SIMD_NEON
+        #include <arm_neon.h>
+    #endif
+#endif
+
 #define PI 3.14159265359
 
-static char* ReadFile(const char* path) {
+// every heap allocation in the library goes through these so allocation churn shows up in the stats,
+// worker threads allocate too so the counters are bumped atomically
+static volatile int64_t heapAllocations;
+static volatile int64_t heapFrees;
+
+// returns the value before the add
+static int64_t AtomicAdd(volatile int64_t* value, int64_t amount) {
+#ifdef GL2D_PLATFORM_WINDOWS
+    return InterlockedExchangeAdd64((volatile LONG64*)value, amount);
+#else
+    return __atomic_fetch_add(value, amount, __ATOMIC_RELAXED);
+#endif
+}
+
+static void CountHeap(volatile int64_t* counter) {
+    AtomicAdd(counter, 1);
+}
+
+static void* MemAlloc(size_t size) {
+    CountHeap(&heapAllocations);
+    return malloc(size);
+}
+
+static void* MemCalloc(size_t count, size_t size) {
+    CountHeap(&heapAllocations);
+    return calloc(count, size);
+}
+
+static void* MemRealloc(void* memory, size_t size) {
+    CountHeap(&heapAllocations);
+    return realloc(memory, size);
+}
+
+static void MemFree(void* memory) {
+    if (memory != NULL) {
+        CountHeap(&heapFrees);
+        free(memory);
+    }
+}
+
+static uint32_t HashString(const char* string) {
+    uint32_t hash = 2166136261u;
+
+    for (; *string != '\0'; string++) {
+        hash ^= (uint8_t)*string;
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+static uint64_t HashBytesContinue(uint64_t hash, const void* data, uint64_t size) {
+    const uint8_t* bytes = data;
+
+    for (uint64_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+static uint64_t HashBytes(const void* data, uint64_t size) {
+    return HashBytesContinue(14695981039346656037ULL, data, size);
+}
+
+static char* ReadEntireFile(const char* path, uint64_t* size) {
     FILE* file = fopen(path, "rb");
 
     if (file == NULL) {
@@ -41,10 +167,11 @@ static char* ReadFile(const char* path) {
     uint64_t fileSize = ftell(file);
     fseek(file, 0, SEEK_SET);
 
-    char* buffer = malloc(fileSize + 1);
+    char* buffer = MemAlloc(fileSize + 1);
 
     if (buffer == NULL) {
         fprintf(stderr, "Error: Couldn't allocate buffer: %s\n", strerror(errno));
+        fclose(file);
         return NULL;
     }
 
@@ -54,473 +181,8947 @@ static char* ReadFile(const char* path) {
 
     if (n != fileSize) {
         fprintf(stderr, "ERROR: Couldn't read file %s: %s\n", path, strerror(errno));
+        fclose(file);
+        MemFree(buffer);
         return NULL;
     }
 
     fclose(file);
 
+    if (size != NULL) {
+        *size = fileSize;
+    }
+
     return buffer;
 }
 
-struct GL2D_Renderer {
-    int unused;
-};
+typedef struct MappedFile {
+    const uint8_t* data;
+    uint64_t size;
+#ifdef GL2D_PLATFORM_WINDOWS
+    HANDLE file;
+    HANDLE mapping;
+#endif
+} MappedFile;
 
-struct GL2D_Shader {
-    uint32_t id;
-};
+static bool MapFile(MappedFile* mapped, const char* path) {
+    memset(mapped, 0, sizeof(MappedFile));
 
-struct GL2D_Texture {
-    uint32_t id;
-    uint8_t slot;
-    GL2D_Vector2f size;
-};
+#ifdef GL2D_PLATFORM_WINDOWS
+    mapped->file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
 
-struct GL2D_VertexArray {
-    uint32_t id;
-};
+    if (mapped->file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
 
-struct GL2D_VertexBuffer {
-    uint32_t id;
-};
+    LARGE_INTEGER size;
 
-struct GL2D_IndexBuffer {
-    uint32_t id;
-};
+    if (!GetFileSizeEx(mapped->file, &size) || size.QuadPart == 0) {
+        CloseHandle(mapped->file);
+        return false;
+    }
 
-GL2D_API bool GL2D_VecEqual(GL2D_Vector2f vector1, GL2D_Vector2f vector2) {
-    return (vector1.x == vector2.x && vector1.y == vector2.y);
-}
+    mapped->mapping = CreateFileMappingA(mapped->file, NULL, PAGE_READONLY, 0, 0, NULL);
 
-GL2D_API GL2D_Vector2f GL2D_VecScalarAdd(GL2D_Vector2f vector, float value) {
-    return (GL2D_Vector2f) { vector.x + value, vector.y + value };
-}
+    if (mapped->mapping == NULL) {
+        CloseHandle(mapped->file);
+        return false;
+    }
 
-GL2D_API GL2D_Vector2f GL2D_VecScalarSub(GL2D_Vector2f vector, float value) {
-    return (GL2D_Vector2f) { vector.x - value, vector.y - value };
-}
+    mapped->data = MapViewOfFile(mapped->mapping, FILE_MAP_READ, 0, 0, 0);
 
-GL2D_API GL2D_Vector2f GL2D_VecScalarMult(GL2D_Vector2f vector, float value) {
-    return (GL2D_Vector2f) { vector.x * value, vector.y * value };
-}
+    if (mapped->data == NULL) {
+        CloseHandle(mapped->mapping);
+        CloseHandle(mapped->file);
+        return false;
+    }
 
-GL2D_API GL2D_Vector2f GL2D_VecScalarDiv(GL2D_Vector2f vector, float value) {
-    return (GL2D_Vector2f) { vector.x / value, vector.y / value };
-}
+    mapped->size = (uint64_t)size.QuadPart;
+#else
+    int file = open(path, O_RDONLY);
 
-GL2D_API GL2D_Vector2f GL2D_VecPower(GL2D_Vector2f vector, float value) {
-    return (GL2D_Vector2f) { powf(vector.x, value), powf(vector.y, value) };
-}
+    if (file < 0) {
+        return false;
+    }
 
-GL2D_API GL2D_Vector2f GL2D_VecAdd(GL2D_Vector2f vector1, GL2D_Vector2f vector2) {
-    return (GL2D_Vector2f) { vector1.x + vector2.x, vector1.y + vector2.y };
-}
+    struct stat info;
 
-GL2D_API GL2D_Vector2f GL2D_VecSub(GL2D_Vector2f vector1, GL2D_Vector2f vector2) {
-    return (GL2D_Vector2f) { vector1.x - vector2.x, vector1.y - vector2.y };
-}
+    if (fstat(file, &info) != 0 || info.st_size == 0) {
+        close(file);
+        return false;
+    }
 
-GL2D_API GL2D_Vector2f GL2D_VecMult(GL2D_Vector2f vector1, GL2D_Vector2f vector2) {
-    return (GL2D_Vector2f) { vector1.x * vector2.x, vector1.y * vector2.y };
-}
+    void* data = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
 
-GL2D_API GL2D_Vector2f GL2D_VecDiv(GL2D_Vector2f vector1, GL2D_Vector2f vector2) {
-    return (GL2D_Vector2f) { vector1.x / vector2.x, vector1.y / vector2.y };
-}
+    if (data == MAP_FAILED) {
+        return false;
+    }
 
-GL2D_API float GL2D_VecDotProduct(GL2D_Vector2f vector1, GL2D_Vector2f vector2) {
-    return (vector1.x * vector2.x + vector1.y * vector2.y);
-}
+    mapped->data = data;
+    mapped->size = (uint64_t)info.st_size;
+#endif
 
-GL2D_API float GL2D_VecMagnitude(GL2D_Vector2f vector) {
-    return sqrtf(GL2D_VecMagnitudeSquared(vector));
+    return true;
 }
 
-GL2D_API float GL2D_VecMagnitudeSquared(GL2D_Vector2f vector) {
-    return (vector.x * vector.x + vector.y * vector.y);
-}
+static void UnmapFile(MappedFile* mapped) {
+    if (mapped->data == NULL) {
+        return;
+    }
 
-GL2D_API GL2D_Vector2f GL2D_VecNormalize(GL2D_Vector2f vector) {
-    float magnitude = GL2D_VecMagnitude(vector);
+#ifdef GL2D_PLATFORM_WINDOWS
+    UnmapViewOfFile(mapped->data);
+    CloseHandle(mapped->mapping);
+    CloseHandle(mapped->file);
+#else
+    munmap((void*)mapped->data, (size_t)mapped->size);
+#endif
 
-    return (GL2D_Vector2f) { vector.x / magnitude, vector.y / magnitude };
+    memset(mapped, 0, sizeof(MappedFile));
 }
 
-GL2D_API GL2D_Vector2f GL2D_VecRotate(GL2D_Vector2f vector, float angle) {
-    float radians = angle * (PI / 180);
-    float radCos = cosf(radians);
-    float radSine = sinf(radians);
+static GL2D_GLLoadProc glLoadProc = NULL;
 
-    return (GL2D_Vector2f) { vector.x * radCos - vector.y * radSine, vector.x * radSine + vector.y * radCos };
-}
+// glad only loads the 3.3 core entry points, anything newer or from an extension is fetched here.
+static void* GetGLProc(const char* name) {
+    if (glLoadProc != NULL) {
+        return glLoadProc(name);
+    }
 
-GL2D_API GL2D_Matrix4f GL2D_Mat4InitIdentity() {
-    GL2D_Matrix4f matrix;
+#ifdef GL2D_PLATFORM_WINDOWS
+    void* proc = (void*)wglGetProcAddress(name);
 
-    matrix.data[0][0] = 1;    matrix.data[1][0] = 0;    matrix.data[2][0] = 0;    matrix.data[3][0] = 0;
-    matrix.data[0][1] = 0;    matrix.data[1][1] = 1;    matrix.data[2][1] = 0;    matrix.data[3][1] = 0;
-    matrix.data[0][2] = 0;    matrix.data[1][2] = 0;    matrix.data[2][2] = 1;    matrix.data[3][2] = 0;
-    matrix.data[0][3] = 0;    matrix.data[1][3] = 0;    matrix.data[2][3] = 0;    matrix.data[3][3] = 1;
+    // wglGetProcAddress signals failure with a few small values besides NULL
+    if (proc == NULL || proc == (void*)1 || proc == (void*)2 || proc == (void*)3 || proc == (void*)-1) {
+        proc = (void*)GetProcAddress(GetModuleHandleA("opengl32.dll"), name);
+    }
 
-    return matrix;
-}
+    return proc;
+#else
+    typedef void* (*GetProcAddressProc)(const char* name);
 
-GL2D_API GL2D_Matrix4f GL2D_Mat4Translate(GL2D_Matrix4f matrix, GL2D_Vector2f vector) {
-    GL2D_Matrix4f result = { 0 };
+    static GetProcAddressProc getProcAddress = NULL;
 
-    result.data[0][0] = 1;    result.data[1][0];        result.data[2][0];        result.data[3][0] = vector.x;
-    result.data[0][1];        result.data[1][1] = 1;    result.data[2][1];        result.data[3][1] = vector.y;
-    result.data[0][2];        result.data[1][2];        result.data[2][2] = 1;    result.data[3][2];
-    result.data[0][3];        result.data[1][3];        result.data[2][3];        result.data[3][3] = 1;
+    if (getProcAddress == NULL) {
+        void* library = dlopen(NULL, RTLD_LAZY);
+        void* symbol = library != NULL ? dlsym(library, "glXGetProcAddressARB") : NULL;
 
-    return GL2D_Mat4Mult(matrix, result);
-}
+        if (symbol == NULL && library != NULL) {
+            symbol = dlsym(library, "eglGetProcAddress");
+        }
 
-GL2D_API GL2D_Matrix4f GL2D_Mat4Scale(GL2D_Matrix4f matrix, GL2D_Vector2f vector) {
-    GL2D_Matrix4f result = { 0 };
+        if (symbol == NULL && (library = dlopen("libGL.so.1", RTLD_LAZY)) != NULL) {
+            symbol = dlsym(library, "glXGetProcAddressARB");
+        }
+
+        if (symbol == NULL) {
+            return NULL;
+        }
 
-    result.data[0][0] = vector.x;    result.data[1][0];               result.data[2][0];        result.data[3][0];
-    result.data[0][1];               result.data[1][1] = vector.y;    result.data[2][1];        result.data[3][1];
-    result.data[0][2];               result.data[1][2];               result.data[2][2] = 1;    result.data[3][2];
-    result.data[0][3];               result.data[1][3];               result.data[2][3];        result.data[3][3] = 1;
+        memcpy(&getProcAddress, &symbol, sizeof(void*));
+    }
 
-    return GL2D_Mat4Mult(matrix, result);
+    return getProcAddress(name);
+#endif
 }
 
-//WTF DID I DO
-//FUCK YOU LEARN OPENGL
-GL2D_API GL2D_Matrix4f GL2D_Mat4Rotate(GL2D_Matrix4f matrix, float angle, GL2D_Vector2f vector) {
-    GL2D_Matrix4f result = { 0 };
-    float z = 0.5f;
-    float radians = angle * (PI / 180);
+static bool HasGLExtension(const char* name) {
+    int count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
 
-    float r00 = cosf(radians) + powf(vector.x, 2) * (1 - cosf(radians));
-    float r10 = vector.x * vector.y * (1 - cosf(radians)) - z * sinf(radians);
-    float r20 = vector.x * z * (1 - cosf(radians)) + vector.y * sinf(radians);
-    float r01 = vector.y * vector.y * (1 - cosf(radians)) + z * sinf(radians);
-    float r11 = cosf(radians) + powf(vector.y, 2) * (1 - cosf(radians));
-    float r21 = vector.y * z * (1 - cosf(radians)) - vector.x * sinf(radians);
-    float r02 = z * vector.x * (1 - cosf(radians)) - vector.y * sinf(radians);
-    float r12 = z * vector.y * (1 - cosf(radians)) + vector.x * sinf(radians);
-    float r22 = cosf(radians) + powf(z, 2) * (1 - cosf(radians));
+    for (int i = 0; i < count; i++) {
+        const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, i);
 
-    result.data[0][0] = r00;    result.data[1][0] = r10;    result.data[2][0] = r20;    result.data[3][0];
-    result.data[0][1] = r01;    result.data[1][1] = r11;    result.data[2][1] = r21;    result.data[3][1];
-    result.data[0][2] = r02;    result.data[1][2] = r12;    result.data[2][2] = r22;    result.data[3][2];
-    result.data[0][3];          result.data[1][3];          result.data[2][3];          result.data[3][3] = 1;
+        if (extension != NULL && strcmp(extension, name) == 0) {
+            return true;
+        }
+    }
 
-    return GL2D_Mat4Mult(matrix, result);
+    return false;
 }
 
-GL2D_API GL2D_Matrix4f GL2D_Mat4Add(GL2D_Matrix4f matrix1, GL2D_Matrix4f matrix2) {
-    GL2D_Matrix4f result = { 0 };
+static double ProfileNow(void) {
+#ifdef GL2D_PLATFORM_WINDOWS
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart / (double)frequency.QuadPart;
+#else
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double)time.tv_sec + (double)time.tv_nsec * 1e-9;
+#endif
+}
 
-    for (uint32_t i = 0; i < 4; i++) {
-        for (uint32_t j = 0; j < 4; j++) {
-            result.data[i][j] = matrix1.data[i][j] + matrix2.data[i][j];
-        }
-    }
+static bool HasGLVersion(int major, int minor) {
+    int currentMajor = 0, currentMinor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &currentMajor);
+    glGetIntegerv(GL_MINOR_VERSION, &currentMinor);
 
-    return result;
+    return currentMajor > major || (currentMajor == major && currentMinor >= minor);
 }
 
-GL2D_API GL2D_Matrix4f GL2D_Mat4Sub(GL2D_Matrix4f matrix1, GL2D_Matrix4f matrix2) {
-    GL2D_Matrix4f result = { 0 };
+#ifdef GL2D_PLATFORM_WINDOWS
+typedef HANDLE Thread;
+typedef CRITICAL_SECTION Mutex;
+typedef CONDITION_VARIABLE Condition;
+#else
+typedef pthread_t Thread;
+typedef pthread_mutex_t Mutex;
+typedef pthread_cond_t Condition;
+#endif
 
-    for (uint32_t i = 0; i < 4; i++) {
-        for (uint32_t j = 0; j < 4; j++) {
-            result.data[i][j] = matrix1.data[i][j] - matrix2.data[i][j];
-        }
-    }
+typedef void (*ThreadFunction)(void* data);
 
-    return result;
+typedef struct ThreadStart {
+    ThreadFunction function;
+    void* data;
+} ThreadStart;
+
+#ifdef GL2D_PLATFORM_WINDOWS
+static DWORD WINAPI ThreadEntry(LPVOID parameter) {
+#else
+static void* ThreadEntry(void* parameter) {
+#endif
+    ThreadStart start = *(ThreadStart*)parameter;
+    MemFree(parameter);
+    start.function(start.data);
+
+    return 0;
 }
 
-GL2D_API GL2D_Matrix4f GL2D_Mat4Mult(GL2D_Matrix4f matrix1, GL2D_Matrix4f matrix2) {
-    GL2D_Matrix4f result = { 0 };
+static bool ThreadCreate(Thread* thread, ThreadFunction function, void* data) {
+    ThreadStart* start = MemAlloc(sizeof(ThreadStart));
 
-    for (uint32_t i = 0; i < 4; i++) {
-        for (uint32_t j = 0; j < 4; j++) {
-            result.data[i][j] = matrix1.data[0][j] * matrix2.data[i][0] +
-                                matrix1.data[1][j] * matrix2.data[i][1] +
-                                matrix1.data[2][j] * matrix2.data[i][2] +
-                                matrix1.data[3][j] * matrix2.data[i][3];
-        }
+    if (start == NULL) {
+        return false;
     }
 
-    return result;
-}
+    start->function = function;
+    start->data = data;
 
-GL2D_API GL2D_Vector2f GL2D_Mat4Vec2Mult(GL2D_Matrix4f matrix, GL2D_Vector2f vector) {
-    float result[4] = { 0, 0, 0, 0 };
-    float vec[4] = { vector.x, vector.y, 1, 1 };
+#ifdef GL2D_PLATFORM_WINDOWS
+    *thread = CreateThread(NULL, 0, ThreadEntry, start, 0, NULL);
 
-    for (uint32_t i = 0; i < 4; i++) {
-        for (uint32_t j = 0; j < 4; j++) {
-            result[i] += matrix.data[j][i] * vec[j];
-        }
+    if (*thread == NULL) {
+        MemFree(start);
+        return false;
+    }
+#else
+    if (pthread_create(thread, NULL, ThreadEntry, start) != 0) {
+        MemFree(start);
+        return false;
     }
+#endif
 
-    return (GL2D_Vector2f) { result[0], result[1] };
+    return true;
 }
 
-GL2D_API GL2D_Matrix4f GL2D_MatTransform(GL2D_Matrix4f matrix, GL2D_Vector2f vector);
-GL2D_API GL2D_Matrix4f GL2D_MatScale(GL2D_Matrix4f matrix, GL2D_Vector2f vector);
-GL2D_API GL2D_Matrix4f GL2D_MatRotate(GL2D_Matrix4f matrix, GL2D_Vector2f vector);
+static void ThreadJoin(Thread thread) {
+#ifdef GL2D_PLATFORM_WINDOWS
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+#else
+    pthread_join(thread, NULL);
+#endif
+}
 
-GL2D_API void GL2D_SetViewport(GL2D_Rect rect) {
-    glViewport(rect.x, rect.y, rect.z, rect.w);
+static uint32_t ProcessorCount(void) {
+#ifdef GL2D_PLATFORM_WINDOWS
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (uint32_t)info.dwNumberOfProcessors : 1;
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (uint32_t)count : 1;
+#endif
 }
 
-GL2D_API void GL2D_SetClearColor(GL2D_Color color) {
-    float r = (float)color.r / 255;
-    float g = (float)color.g / 255;
-    float b = (float)color.b / 255;
-    float a = (float)color.a / 255;
+static void MutexInit(Mutex* mutex) {
+#ifdef GL2D_PLATFORM_WINDOWS
+    InitializeCriticalSection(mutex);
+#else
+    pthread_mutex_init(mutex, NULL);
+#endif
+}
 
-    glClearColor(r, g, b, a);
+static void MutexDestroy(Mutex* mutex) {
+#ifdef GL2D_PLATFORM_WINDOWS
+    DeleteCriticalSection(mutex);
+#else
+    pthread_mutex_destroy(mutex);
+#endif
 }
 
-GL2D_API GL2D_Renderer GL2D_CreateRenderer() {
-    if (!gladLoadGL()) {
-        fprintf(stderr, "Failed to initialize GLAD\n");
-        return NULL;
-    }
+static void MutexLock(Mutex* mutex) {
+#ifdef GL2D_PLATFORM_WINDOWS
+    EnterCriticalSection(mutex);
+#else
+    pthread_mutex_lock(mutex);
+#endif
+}
 
-    glFrontFace(GL_CW);
-    glCullFace(GL_BACK);
-    glEnable(GL_CULL_FACE);
-    glEnable(GL_DEPTH_TEST);
-    //glEnable(GL_FRAMEBUFFER_SRGB);
+static void MutexUnlock(Mutex* mutex) {
+#ifdef GL2D_PLATFORM_WINDOWS
+    LeaveCriticalSection(mutex);
+#else
+    pthread_mutex_unlock(mutex);
+#endif
+}
 
-    GL2D_Renderer renderer = malloc(sizeof(struct GL2D_Renderer));
+static void ConditionInit(Condition* condition) {
+#ifdef GL2D_PLATFORM_WINDOWS
+    InitializeConditionVariable(condition);
+#else
+    pthread_cond_init(condition, NULL);
+#endif
+}
 
-    if (renderer == NULL) {
-        fprintf(stderr, "ERROR: Failed to allocate renderer\n");
-        return NULL;
-    }
+static void ConditionDestroy(Condition* condition) {
+#ifdef GL2D_PLATFORM_WINDOWS
+    (void)condition;
+#else
+    pthread_cond_destroy(condition);
+#endif
+}
 
-    memset(renderer, 0, sizeof(struct GL2D_Renderer));
+static void ConditionWait(Condition* condition, Mutex* mutex) {
+#ifdef GL2D_PLATFORM_WINDOWS
+    SleepConditionVariableCS(condition, mutex, INFINITE);
+#else
+    pthread_cond_wait(condition, mutex);
+#endif
+}
 
-    return renderer;
+static void ConditionSignal(Condition* condition) {
+#ifdef GL2D_PLATFORM_WINDOWS
+    WakeConditionVariable(condition);
+#else
+    pthread_cond_signal(condition);
+#endif
 }
 
-GL2D_API void GL2D_UpdateRenderer(GL2D_Renderer renderer) {
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+static void ConditionBroadcast(Condition* condition) {
+#ifdef GL2D_PLATFORM_WINDOWS
+    WakeAllConditionVariable(condition);
+#else
+    pthread_cond_broadcast(condition);
+#endif
+}
+
+typedef struct Job {
+    ThreadFunction function;
+    void* data;
+} Job;
+
+// One pool shared by everything that wants background work, started on first use.
+typedef struct WorkerPool {
+    Thread* threads;
+    uint32_t threadCount;
+    Mutex mutex;
+    Condition wake;
+    Job* jobs;
+    uint32_t jobHead;
+    uint32_t jobCount;
+    uint32_t jobCapacity;
+    bool running;
+} WorkerPool;
+
+static WorkerPool workerPool;
+
+static void WorkerMain(void* data) {
+    (void)data;
+
+    MutexLock(&workerPool.mutex);
+
+    while (true) {
+        while (workerPool.running && workerPool.jobCount == 0) {
+            ConditionWait(&workerPool.wake, &workerPool.mutex);
+        }
+
+        if (!workerPool.running) {
+            break;
+        }
+
+        Job job = workerPool.jobs[workerPool.jobHead];
+        workerPool.jobHead = (workerPool.jobHead + 1) % workerPool.jobCapacity;
+        workerPool.jobCount--;
+
+        MutexUnlock(&workerPool.mutex);
+        job.function(job.data);
+        MutexLock(&workerPool.mutex);
+    }
+
+    MutexUnlock(&workerPool.mutex);
+}
+
+static bool StartWorkerPool(void) {
+    if (workerPool.running) {
+        return true;
+    }
+
+    uint32_t processors = ProcessorCount();
+    uint32_t threadCount = processors > 1 ? processors - 1 : 1;
+
+    workerPool.threads = MemAlloc(threadCount * sizeof(Thread));
+
+    if (workerPool.threads == NULL) {
+        fprintf(stderr, "ERROR: Couldn't allocate worker threads\n");
+        return false;
+    }
+
+    MutexInit(&workerPool.mutex);
+    ConditionInit(&workerPool.wake);
+    workerPool.running = true;
+    workerPool.threadCount = 0;
+
+    for (uint32_t i = 0; i < threadCount; i++) {
+        if (!ThreadCreate(&workerPool.threads[workerPool.threadCount], WorkerMain, NULL)) {
+            fprintf(stderr, "ERROR: Couldn't start worker thread\n");
+            break;
+        }
+
+        workerPool.threadCount++;
+    }
+
+    return workerPool.threadCount > 0;
+}
+
+// jobs still queued when the pool stops are dropped, their owners clean up after them
+static void StopWorkerPool(void) {
+    if (!workerPool.running) {
+        return;
+    }
+
+    MutexLock(&workerPool.mutex);
+    workerPool.running = false;
+    ConditionBroadcast(&workerPool.wake);
+    MutexUnlock(&workerPool.mutex);
+
+    for (uint32_t i = 0; i < workerPool.threadCount; i++) {
+        ThreadJoin(workerPool.threads[i]);
+    }
+
+    MutexDestroy(&workerPool.mutex);
+    ConditionDestroy(&workerPool.wake);
+    MemFree(workerPool.threads);
+    MemFree(workerPool.jobs);
+    memset(&workerPool, 0, sizeof(WorkerPool));
+}
+
+static bool SubmitJob(ThreadFunction function, void* data) {
+    if (!StartWorkerPool()) {
+        return false;
+    }
+
+    MutexLock(&workerPool.mutex);
+
+    if (workerPool.jobCount == workerPool.jobCapacity) {
+        uint32_t capacity = workerPool.jobCapacity == 0 ? 64 : workerPool.jobCapacity * 2;
+        Job* jobs = MemAlloc(capacity * sizeof(Job));
+
+        if (jobs == NULL) {
+            MutexUnlock(&workerPool.mutex);
+            return false;
+        }
+
+        for (uint32_t i = 0; i < workerPool.jobCount; i++) {
+            jobs[i] = workerPool.jobs[(workerPool.jobHead + i) % workerPool.jobCapacity];
+        }
+
+        MemFree(workerPool.jobs);
+        workerPool.jobs = jobs;
+        workerPool.jobHead = 0;
+        workerPool.jobCapacity = capacity;
+    }
+
+    workerPool.jobs[(workerPool.jobHead + workerPool.jobCount) % workerPool.jobCapacity] = (Job) { function, data };
+    workerPool.jobCount++;
+    ConditionSignal(&workerPool.wake);
+    MutexUnlock(&workerPool.mutex);
+
+    return true;
+}
+
+#define GL2D_BATCH_MAX_QUADS 10000
+#define GL2D_BATCH_MAX_VERTICES (GL2D_BATCH_MAX_QUADS * 4)
+#define GL2D_BATCH_MAX_INDICES (GL2D_BATCH_MAX_QUADS * 6)
+#define GL2D_BATCH_MAX_TEXTURES 16
+
+// 24 bytes, color and texture index go up as bytes. Texture coordinates stay float since
+// repeating uvs leave the unorm range and large atlases need sub-texel precision.
+typedef struct BatchVertex {
+    float position[2];
+    float texCoord[2];
+    GL2D_Color color;
+    uint8_t texIndex;
+    uint8_t padding[3];
+} BatchVertex;
+
+static const char* batchVertexSource = "#version 330 core\n"
+"layout (location = 0) in vec2 aPos;\n"
+"layout (location = 1) in vec4 aColor;\n"
+"layout (location = 2) in vec2 aTexCoord;\n"
+"layout (location = 3) in float aTexIndex;\n"
+"out vec4 ourColor;\n"
+"out vec2 TexCoord;\n"
+"flat out int TexIndex;\n"
+"uniform mat4 projection;\n"
+"void main() {\n"
+"    gl_Position = projection * vec4(aPos, 0.0, 1.0);\n"
+"    ourColor = aColor;\n"
+"    TexCoord = aTexCoord;\n"
+"    TexIndex = int(aTexIndex);\n"
+"}";
+
+// GLSL 3.30 only allows constant indices into sampler arrays, hence the switch
+static const char* batchFragmentSource = "#version 330 core\n"
+"out vec4 FragColor;\n"
+"in vec4 ourColor;\n"
+"in vec2 TexCoord;\n"
+"flat in int TexIndex;\n"
+"uniform sampler2D textures[16];\n"
+"void main() {\n"
+"    vec4 texel;\n"
+"    switch (TexIndex) {\n"
+"        case 0: texel = texture(textures[0], TexCoord); break;\n"
+"        case 1: texel = texture(textures[1], TexCoord); break;\n"
+"        case 2: texel = texture(textures[2], TexCoord); break;\n"
+"        case 3: texel = texture(textures[3], TexCoord); break;\n"
+"        case 4: texel = texture(textures[4], TexCoord); break;\n"
+"        case 5: texel = texture(textures[5], TexCoord); break;\n"
+"        case 6: texel = texture(textures[6], TexCoord); break;\n"
+"        case 7: texel = texture(textures[7], TexCoord); break;\n"
+"        case 8: texel = texture(textures[8], TexCoord); break;\n"
+"        case 9: texel = texture(textures[9], TexCoord); break;\n"
+"        case 10: texel = texture(textures[10], TexCoord); break;\n"
+"        case 11: texel = texture(textures[11], TexCoord); break;\n"
+"        case 12: texel = texture(textures[12], TexCoord); break;\n"
+"        case 13: texel = texture(textures[13], TexCoord); break;\n"
+"        case 14: texel = texture(textures[14], TexCoord); break;\n"
+"        default: texel = texture(textures[15], TexCoord); break;\n"
+"    }\n"
+"    FragColor = texel * ourColor;\n"
+"}";
+
+// Instances carry their affine, uv rect and color, the shared quad corners come from a static
+// buffer and get placed the same way GL2D_DrawQuadAffineUV places them on the CPU.
+static const char* instanceVertexSource = "#version 330 core\n"
+"layout (location = 0) in vec2 aCorner;\n"
+"layout (location = 1) in vec4 aAxes;\n"
+"layout (location = 2) in vec2 aTranslation;\n"
+"layout (location = 3) in vec4 aUV;\n"
+"layout (location = 4) in vec4 aColor;\n"
+"out vec4 ourColor;\n"
+"out vec2 TexCoord;\n"
+"uniform mat4 projection;\n"
+"void main() {\n"
+"    vec2 position = aTranslation + aAxes.xy * aCorner.x + aAxes.zw * aCorner.y;\n"
+"    gl_Position = projection * vec4(position, 0.0, 1.0);\n"
+"    ourColor = aColor;\n"
+"    TexCoord = aUV.xy + (aCorner + 0.5) * aUV.zw;\n"
+"}";
+
+static const char* instanceFragmentSource = "#version 330 core\n"
+"out vec4 FragColor;\n"
+"in vec4 ourColor;\n"
+"in vec2 TexCoord;\n"
+"uniform sampler2D tex;\n"
+"void main() {\n"
+"    FragColor = texture(tex, TexCoord) * ourColor;\n"
+"}";
+
+#define GL2D_INSTANCE_STREAM_SIZE (4 * 1024 * 1024)
+#define GL2D_INSTANCES_PER_DRAW (GL2D_INSTANCE_STREAM_SIZE / 4 / sizeof(GL2D_SpriteInstance))
+
+#define GL2D_MAX_TEXTURE_SLOTS 32
+#define GL2D_STATE_UNKNOWN 0xFFFFFFFFu
+
+typedef struct StateCache {
+    uint32_t program;
+    uint32_t vertexArray;
+    uint32_t arrayBuffer;
+    uint32_t elementBuffer;
+    uint32_t uniformBuffer;
+    uint32_t activeTexture;
+    uint32_t textures[GL2D_MAX_TEXTURE_SLOTS];
+    uint32_t blend;
+    uint32_t depthTest;
+    uint32_t cullFace;
+    uint32_t blendSource;
+    uint32_t blendDestination;
+    uint32_t depthMask;
+    uint32_t clearColor;
+    GL2D_StateCounters counters;
+} StateCache;
+
+struct GL2D_Renderer {
+    StateCache state;
+    GL2D_Shader batchShader;
+    GL2D_Texture whiteTexture;
+    uint32_t batchVao;
+    uint32_t batchVbo;
+    uint32_t batchIbo;
+    BatchVertex* batchVertices;
+    uint32_t batchQuadCount;
+    GL2D_Texture batchTextures[GL2D_BATCH_MAX_TEXTURES];
+    uint32_t batchTextureCount;
+    uint32_t batchMaxTextures;
+    GL2D_Uniform batchProjection;
+    GL2D_Matrix4f projection;
+    bool batchActive;
+    GL2D_Shader instanceShader;
+    GL2D_Uniform instanceProjection;
+    GL2D_Shader textShader;
+    GL2D_Shader tilemapShader;
+    uint32_t batchSerial;
+    GL2D_Font* batchFonts;
+    uint32_t batchFontCount;
+    uint32_t batchFontCapacity;
+    uint32_t instanceVao;
+    uint32_t instanceCornerVbo;
+    GL2D_StreamBuffer instanceStream;
+    uint32_t uploadBuffer;
+    uint64_t uploadBudget;
+    GL2D_FrameArena frameArena;
+    GL2D_FrameStats frameStats;
+    GL2D_FrameStats lastFrameStats;
+    double frameStart;
+    int64_t heapAllocationsStart;
+    int64_t heapFreesStart;
+    struct Profiler* profiler;
+    struct SoftwareRaster* software;
+    struct PrimitiveCache* primitives;
+    GL2D_Rect viewport;
+};
+
+static bool InitBatch(GL2D_Renderer renderer);
+static bool InitInstancing(GL2D_Renderer renderer);
+static void ProcessTextureUploads(GL2D_Renderer renderer);
+static void FreeTextureLoads(void);
+static void FlushBatch(GL2D_Renderer renderer);
+static void ReleaseBatchFonts(GL2D_Renderer renderer);
+static void ResetShaderCache(void);
+static void ForgetCachedVertexArrays(GL2D_VertexBuffer vbo, GL2D_IndexBuffer ibo);
+static void ClearVertexArrayCache(void);
+static bool InitProfiler(GL2D_Renderer renderer);
+static void ProfilerEndFrame(GL2D_Renderer renderer, double now);
+static void FreeProfiler(GL2D_Renderer renderer);
+static void FreePrimitives(GL2D_Renderer renderer);
+static bool InitSoftware(GL2D_Renderer renderer, const GL2D_RendererDesc* desc);
+static void FreeSoftware(GL2D_Renderer renderer);
+static void SoftwareAddQuad(GL2D_Renderer renderer, const GL2D_Affine2D* affine, GL2D_Texture texture, GL2D_Rectf uv, GL2D_Color color);
+static void SoftwareAddCorners(GL2D_Renderer renderer, const float positions[4][2], const float texCoords[4][2], GL2D_Texture texture, GL2D_Color color);
+static GL2D_Rect SoftwareGetViewport(GL2D_Renderer renderer);
+static void SoftwareFlush(GL2D_Renderer renderer);
+static void SoftwareClear(GL2D_Renderer renderer);
+static void SoftwareSetViewport(GL2D_Renderer renderer, GL2D_Rect rect);
+static void SoftwareSetClearColor(GL2D_Renderer renderer, GL2D_Color color);
+
+#define GL2D_MAX_UNIFORM_NAME 64
+
+typedef struct ShaderUniform {
+    char name[GL2D_MAX_UNIFORM_NAME];
+    uint32_t hash;
+    int32_t location;
+    uint32_t type;
+    int32_t size;
+    bool shadowed;
+    float shadow[16];
+} ShaderUniform;
+
+typedef struct Shader {
+    uint32_t id;
+    ShaderUniform* uniforms;
+    uint32_t uniformCount;
+    int32_t* uniformTable;
+    uint32_t uniformTableMask;
+} Shader;
+
+struct GL2D_UniformBuffer {
+    uint32_t id;
+    uint32_t binding;
+    uint64_t size;
+};
+
+typedef struct TextureLoad TextureLoad;
+
+// Software backend textures keep their RGBA8 pixels on the CPU instead of a GL id.
+typedef struct Texture {
+    uint32_t id;
+    uint8_t slot;
+    GL2D_Vector2f size;
+    bool ready;
+    uint8_t* pixels;
+    bool repeat;
+} Texture;
+
+enum {
+    TEXTURE_LOAD_QUEUED,
+    TEXTURE_LOAD_DECODED,
+    TEXTURE_LOAD_FAILED,
+};
+
+// Owned by the render thread, a worker only writes pixels/state while the load is queued.
+// Destroying the texture cancels the load, its handle simply stops resolving. Rows stream into
+// a texture of their own, the placeholder stays visible until that one is complete.
+struct TextureLoad {
+    GL2D_Texture texture;
+    char* path;
+    uint8_t* pixels;
+    int width;
+    int height;
+    uint32_t streamTexture;
+    uint32_t uploadedRows;
+    uint32_t state;
+    TextureLoad* next;
+};
+
+static TextureLoad* textureLoads = NULL;
+static Mutex textureLoadMutex;
+static bool textureLoadMutexReady = false;
+
+typedef struct VertexArray {
+    uint32_t id;
+} VertexArray;
+
+typedef struct VertexBuffer {
+    uint32_t id;
+} VertexBuffer;
+
+typedef struct IndexBuffer {
+    uint32_t id;
+} IndexBuffer;
+
+// Resources of one type live in a single growable array and are handed out as 32-bit handles. The
+// low bits index the slot and the high bits carry the slot's generation, which changes on destroy,
+// so a handle that outlived its resource is caught instead of aliasing whatever reuses the slot.
+// Generations start at 1, so handle 0 is never valid.
+#define HANDLE_INDEX_BITS 20
+#define HANDLE_INDEX_MASK ((1u << HANDLE_INDEX_BITS) - 1)
+#define HANDLE_GENERATION_MASK ((1u << (32 - HANDLE_INDEX_BITS)) - 1)
+
+typedef struct HandleSlot {
+    uint16_t generation;
+    bool live;
+} HandleSlot;
+
+typedef struct HandlePool {
+    const char* name;
+    uint32_t itemSize;
+    uint8_t* items;
+    HandleSlot* slots;
+    uint32_t* freeSlots;
+    uint32_t freeCount;
+    uint32_t slotCount;
+    uint32_t capacity;
+    uint32_t liveCount;
+} HandlePool;
+
+static HandlePool shaderPool = { .name = "shader", .itemSize = sizeof(Shader) };
+static HandlePool texturePool = { .name = "texture", .itemSize = sizeof(Texture) };
+static HandlePool vertexArrayPool = { .name = "vertex array", .itemSize = sizeof(VertexArray) };
+static HandlePool vertexBufferPool = { .name = "vertex buffer", .itemSize = sizeof(VertexBuffer) };
+static HandlePool indexBufferPool = { .name = "index buffer", .itemSize = sizeof(IndexBuffer) };
+
+// Also used by the per-object id spaces (atlas regions, spatial items) that share the handle layout
+static uint16_t NextGeneration(uint16_t generation) {
+    generation = (uint16_t)((generation & HANDLE_GENERATION_MASK) + 1);
+
+    return generation > HANDLE_GENERATION_MASK ? 1 : generation;
+}
+
+static uint32_t PoolHandle(const HandlePool* pool, uint32_t index) {
+    return ((uint32_t)pool->slots[index].generation << HANDLE_INDEX_BITS) | index;
+}
+
+// Returns a handle to a zeroed item, or 0. Item pointers stay valid only until the next allocation.
+static uint32_t PoolAllocate(HandlePool* pool) {
+    uint32_t index;
+
+    if (pool->freeCount > 0) {
+        index = pool->freeSlots[--pool->freeCount];
+    }
+    else {
+        if (pool->slotCount == pool->capacity) {
+            uint32_t capacity = pool->capacity == 0 ? 64 : pool->capacity * 2;
+
+            if (capacity > HANDLE_INDEX_MASK + 1) {
+                fprintf(stderr, "ERROR: Too many live %s handles\n", pool->name);
+                return 0;
+            }
+
+            uint8_t* items = MemRealloc(pool->items, (uint64_t)capacity * pool->itemSize);
+            pool->items = items != NULL ? items : pool->items;
+
+            HandleSlot* slots = MemRealloc(pool->slots, capacity * sizeof(HandleSlot));
+            pool->slots = slots != NULL ? slots : pool->slots;
+
+            uint32_t* freeSlots = MemRealloc(pool->freeSlots, capacity * sizeof(uint32_t));
+            pool->freeSlots = freeSlots != NULL ? freeSlots : pool->freeSlots;
+
+            if (items == NULL || slots == NULL || freeSlots == NULL) {
+                fprintf(stderr, "ERROR: Couldn't allocate %s\n", pool->name);
+                return 0;
+            }
+
+            pool->capacity = capacity;
+        }
+
+        index = pool->slotCount++;
+        pool->slots[index].generation = 1;
+    }
+
+    pool->slots[index].live = true;
+    pool->liveCount++;
+    memset(pool->items + (uint64_t)index * pool->itemSize, 0, pool->itemSize);
+
+    return PoolHandle(pool, index);
+}
+
+static void* PoolGet(const HandlePool* pool, uint32_t handle) {
+    uint32_t index = handle & HANDLE_INDEX_MASK;
+
+    if (index >= pool->slotCount || !pool->slots[index].live || pool->slots[index].generation != handle >> HANDLE_INDEX_BITS) {
+        return NULL;
+    }
+
+    return pool->items + (uint64_t)index * pool->itemSize;
+}
+
+static void PoolFree(HandlePool* pool, uint32_t handle) {
+    if (PoolGet(pool, handle) == NULL) {
+        return;
+    }
+
+    uint32_t index = handle & HANDLE_INDEX_MASK;
+    HandleSlot* slot = &pool->slots[index];
+
+    slot->live = false;
+    slot->generation = NextGeneration(slot->generation);
+    pool->freeSlots[pool->freeCount++] = index;
+    pool->liveCount--;
+}
+
+static uint32_t PoolReportLeaks(const HandlePool* pool) {
+    for (uint32_t i = 0; i < pool->slotCount; i++) {
+        if (pool->slots[i].live) {
+            fprintf(stderr, "LEAK: %s handle 0x%08x was never destroyed\n", pool->name, PoolHandle(pool, i));
+        }
+    }
+
+    return pool->liveCount;
+}
+
+static Shader* GetShader(GL2D_Shader handle) {
+    Shader* shader = PoolGet(&shaderPool, handle);
+
+    if (shader == NULL) {
+        fprintf(stderr, "ERROR: Invalid or destroyed shader handle 0x%08x\n", handle);
+    }
+
+    return shader;
+}
+
+static Texture* GetTexture(GL2D_Texture handle) {
+    Texture* texture = PoolGet(&texturePool, handle);
+
+    if (texture == NULL) {
+        fprintf(stderr, "ERROR: Invalid or destroyed texture handle 0x%08x\n", handle);
+    }
+
+    return texture;
+}
+
+GL2D_API uint32_t GL2D_ReportLeaks() {
+    return PoolReportLeaks(&shaderPool) + PoolReportLeaks(&texturePool) + PoolReportLeaks(&vertexArrayPool) +
+        PoolReportLeaks(&vertexBufferPool) + PoolReportLeaks(&indexBufferPool);
+}
+
+static void ReflectUniforms(Shader* shader);
+
+static GL2D_Renderer currentRenderer = NULL;
+
+static bool SoftwareActive(void) {
+    return currentRenderer != NULL && currentRenderer->software != NULL;
+}
+
+// GL-only entry points refuse to run under the software backend, GL was never loaded there
+static bool RequireGL(const char* function) {
+    if (SoftwareActive()) {
+        fprintf(stderr, "ERROR: %s isn't available on the software backend\n", function);
+        return false;
+    }
+
+    return true;
+}
+
+// Every GL bind/enable goes through these so redundant calls never reach the driver.
+// Without a current renderer they forward straight to GL.
+static StateCache* CurrentState(void) {
+    return currentRenderer != NULL ? &currentRenderer->state : NULL;
+}
+
+enum {
+    STATE_KIND_PROGRAM,
+    STATE_KIND_VERTEX_ARRAY,
+    STATE_KIND_BUFFER,
+    STATE_KIND_TEXTURE,
+    STATE_KIND_RENDER,
+};
+
+// a non-NULL state always belongs to the current renderer, so its frame stats are counted too
+static bool StateChanged(StateCache* state, uint32_t* cached, uint32_t value, uint32_t kind) {
+    GL2D_FrameStats* stats = &currentRenderer->frameStats;
+
+    if (*cached == value) {
+        state->counters.skipped++;
+        stats->redundantStateChanges++;
+        return false;
+    }
+
+    *cached = value;
+    state->counters.issued++;
+
+    switch (kind) {
+        case STATE_KIND_PROGRAM: stats->programChanges++; break;
+        case STATE_KIND_VERTEX_ARRAY: stats->vertexArrayChanges++; break;
+        case STATE_KIND_BUFFER: stats->bufferChanges++; break;
+        case STATE_KIND_TEXTURE: stats->textureChanges++; break;
+        default: stats->renderStateChanges++; break;
+    }
+
+    return true;
+}
+
+// instances is 0 for plain draws, triangles covers all instances
+static void CountDraw(uint64_t triangles, uint64_t instances) {
+    if (currentRenderer != NULL) {
+        currentRenderer->frameStats.drawCalls++;
+        currentRenderer->frameStats.triangles += triangles;
+        currentRenderer->frameStats.instances += instances;
+    }
+}
+
+static void CountBufferUpload(uint64_t bytes) {
+    if (currentRenderer != NULL) {
+        currentRenderer->frameStats.bufferBytesUploaded += bytes;
+    }
+}
+
+static void CountTextureUpload(uint64_t bytes) {
+    if (currentRenderer != NULL) {
+        currentRenderer->frameStats.textureBytesUploaded += bytes;
+    }
+}
+
+static void StateUseProgram(uint32_t program) {
+    StateCache* state = CurrentState();
+
+    if (state == NULL || StateChanged(state, &state->program, program, STATE_KIND_PROGRAM)) {
+        glUseProgram(program);
+    }
+}
+
+static void StateBindVertexArray(uint32_t vao) {
+    StateCache* state = CurrentState();
+
+    if (state == NULL || StateChanged(state, &state->vertexArray, vao, STATE_KIND_VERTEX_ARRAY)) {
+        glBindVertexArray(vao);
+
+        // the element buffer binding is part of the vertex array object
+        if (state != NULL) {
+            state->elementBuffer = GL2D_STATE_UNKNOWN;
+        }
+    }
+}
+
+static void StateBindBuffer(uint32_t target, uint32_t buffer) {
+    StateCache* state = CurrentState();
+    uint32_t* cached = NULL;
+
+    if (state != NULL) {
+        switch (target) {
+            case GL_ARRAY_BUFFER: cached = &state->arrayBuffer; break;
+            case GL_ELEMENT_ARRAY_BUFFER: cached = &state->elementBuffer; break;
+            case GL_UNIFORM_BUFFER: cached = &state->uniformBuffer; break;
+            default: break;
+        }
+    }
+
+    if (cached == NULL || StateChanged(state, cached, buffer, STATE_KIND_BUFFER)) {
+        glBindBuffer(target, buffer);
+    }
+}
+
+static void StateActiveTexture(uint32_t slot) {
+    StateCache* state = CurrentState();
+
+    if (state == NULL || StateChanged(state, &state->activeTexture, slot, STATE_KIND_TEXTURE)) {
+        glActiveTexture(GL_TEXTURE0 + slot);
+    }
+}
+
+static void StateBindTexture(uint32_t slot, uint32_t texture) {
+    StateCache* state = CurrentState();
+
+    if (state == NULL || slot >= GL2D_MAX_TEXTURE_SLOTS) {
+        StateActiveTexture(slot);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        return;
+    }
+
+    if (StateChanged(state, &state->textures[slot], texture, STATE_KIND_TEXTURE)) {
+        StateActiveTexture(slot);
+        glBindTexture(GL_TEXTURE_2D, texture);
+    }
+}
+
+// binds on whatever unit is active, used when creating or updating a texture
+static void StateBindTextureForUpdate(uint32_t texture) {
+    StateCache* state = CurrentState();
+    uint32_t slot = state != NULL ? state->activeTexture : GL2D_STATE_UNKNOWN;
+
+    if (slot == GL2D_STATE_UNKNOWN) {
+        slot = 0;
+    }
+
+    StateBindTexture(slot, texture);
+}
+
+static void StateEnable(uint32_t capability, bool enabled) {
+    StateCache* state = CurrentState();
+    uint32_t* cached = NULL;
+
+    if (state != NULL) {
+        switch (capability) {
+            case GL_BLEND: cached = &state->blend; break;
+            case GL_DEPTH_TEST: cached = &state->depthTest; break;
+            case GL_CULL_FACE: cached = &state->cullFace; break;
+            default: break;
+        }
+    }
+
+    if (cached == NULL || StateChanged(state, cached, enabled, STATE_KIND_RENDER)) {
+        if (enabled) {
+            glEnable(capability);
+        }
+        else {
+            glDisable(capability);
+        }
+    }
+}
+
+static void StateBlendFunc(uint32_t source, uint32_t destination) {
+    StateCache* state = CurrentState();
+
+    if (state == NULL) {
+        glBlendFunc(source, destination);
+        return;
+    }
+
+    bool sourceChanged = StateChanged(state, &state->blendSource, source, STATE_KIND_RENDER);
+    bool destinationChanged = StateChanged(state, &state->blendDestination, destination, STATE_KIND_RENDER);
+
+    if (sourceChanged || destinationChanged) {
+        glBlendFunc(source, destination);
+    }
+}
+
+static void StateDepthMask(bool enabled) {
+    StateCache* state = CurrentState();
+
+    if (state == NULL || StateChanged(state, &state->depthMask, enabled, STATE_KIND_RENDER)) {
+        glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+    }
+}
+
+static void StateClearColor(GL2D_Color color) {
+    StateCache* state = CurrentState();
+    uint32_t packed = (uint32_t)color.r | (uint32_t)color.g << 8 | (uint32_t)color.b << 16 | (uint32_t)color.a << 24;
+
+    if (state == NULL || StateChanged(state, &state->clearColor, packed, STATE_KIND_RENDER)) {
+        glClearColor((float)color.r / 255, (float)color.g / 255, (float)color.b / 255, (float)color.a / 255);
+    }
+}
+
+// deleted objects are unbound by GL and their names may be handed out again
+static void StateForgetBuffer(uint32_t buffer) {
+    if (currentRenderer == NULL) {
+        return;
+    }
+
+    StateCache* state = &currentRenderer->state;
+
+    if (state->arrayBuffer == buffer) state->arrayBuffer = 0;
+    if (state->elementBuffer == buffer) state->elementBuffer = GL2D_STATE_UNKNOWN;
+    if (state->uniformBuffer == buffer) state->uniformBuffer = 0;
+}
+
+static void StateForgetTexture(uint32_t texture) {
+    if (currentRenderer == NULL) {
+        return;
+    }
+
+    for (uint32_t i = 0; i < GL2D_MAX_TEXTURE_SLOTS; i++) {
+        if (currentRenderer->state.textures[i] == texture) {
+            currentRenderer->state.textures[i] = 0;
+        }
+    }
+}
+
+static void StateForgetVertexArray(uint32_t vao) {
+    if (currentRenderer != NULL && currentRenderer->state.vertexArray == vao) {
+        currentRenderer->state.vertexArray = 0;
+        currentRenderer->state.elementBuffer = GL2D_STATE_UNKNOWN;
+    }
+}
+
+static void StateForgetProgram(uint32_t program) {
+    if (currentRenderer != NULL && currentRenderer->state.program == program) {
+        currentRenderer->state.program = GL2D_STATE_UNKNOWN;
+    }
+}
+
+GL2D_API bool GL2D_VecEqual(GL2D_Vector2f vector1, GL2D_Vector2f vector2) {
+    return (vector1.x == vector2.x && vector1.y == vector2.y);
+}
+
+GL2D_API GL2D_Vector2f GL2D_VecScalarAdd(GL2D_Vector2f vector, float value) {
+    return (GL2D_Vector2f) { vector.x + value, vector.y + value };
+}
+
+GL2D_API GL2D_Vector2f GL2D_VecScalarSub(GL2D_Vector2f vector, float value) {
+    return (GL2D_Vector2f) { vector.x - value, vector.y - value };
+}
+
+GL2D_API GL2D_Vector2f GL2D_VecScalarMult(GL2D_Vector2f vector, float value) {
+    return (GL2D_Vector2f) { vector.x * value, vector.y * value };
+}
+
+GL2D_API GL2D_Vector2f GL2D_VecScalarDiv(GL2D_Vector2f vector, float value) {
+    return (GL2D_Vector2f) { vector.x / value, vector.y / value };
+}
+
+GL2D_API GL2D_Vector2f GL2D_VecPower(GL2D_Vector2f vector, float value) {
+    return (GL2D_Vector2f) { powf(vector.x, value), powf(vector.y, value) };
+}
+
+GL2D_API GL2D_Vector2f GL2D_VecAdd(GL2D_Vector2f vector1, GL2D_Vector2f vector2) {
+    return (GL2D_Vector2f) { vector1.x + vector2.x, vector1.y + vector2.y };
+}
+
+GL2D_API GL2D_Vector2f GL2D_VecSub(GL2D_Vector2f vector1, GL2D_Vector2f vector2) {
+    return (GL2D_Vector2f) { vector1.x - vector2.x, vector1.y - vector2.y };
+}
+
+GL2D_API GL2D_Vector2f GL2D_VecMult(GL2D_Vector2f vector1, GL2D_Vector2f vector2) {
+    return (GL2D_Vector2f) { vector1.x * vector2.x, vector1.y * vector2.y };
+}
+
+GL2D_API GL2D_Vector2f GL2D_VecDiv(GL2D_Vector2f vector1, GL2D_Vector2f vector2) {
+    return (GL2D_Vector2f) { vector1.x / vector2.x, vector1.y / vector2.y };
+}
+
+GL2D_API float GL2D_VecDotProduct(GL2D_Vector2f vector1, GL2D_Vector2f vector2) {
+    return (vector1.x * vector2.x + vector1.y * vector2.y);
+}
+
+GL2D_API float GL2D_VecMagnitude(GL2D_Vector2f vector) {
+    return sqrtf(GL2D_VecMagnitudeSquared(vector));
+}
+
+GL2D_API float GL2D_VecMagnitudeSquared(GL2D_Vector2f vector) {
+    return (vector.x * vector.x + vector.y * vector.y);
+}
+
+GL2D_API GL2D_Vector2f GL2D_VecNormalize(GL2D_Vector2f vector) {
+    float magnitude = GL2D_VecMagnitude(vector);
+
+    return (GL2D_Vector2f) { vector.x / magnitude, vector.y / magnitude };
+}
+
+GL2D_API GL2D_Vector2f GL2D_VecRotate(GL2D_Vector2f vector, float angle) {
+    float radians = angle * (PI / 180);
+    float radCos = cosf(radians);
+    float radSine = sinf(radians);
+
+    return (GL2D_Vector2f) { vector.x * radCos - vector.y * radSine, vector.x * radSine + vector.y * radCos };
+}
+
+GL2D_API GL2D_Matrix4f GL2D_Mat4InitIdentity() {
+    GL2D_Matrix4f matrix;
+
+    matrix.data[0][0] = 1;    matrix.data[1][0] = 0;    matrix.data[2][0] = 0;    matrix.data[3][0] = 0;
+    matrix.data[0][1] = 0;    matrix.data[1][1] = 1;    matrix.data[2][1] = 0;    matrix.data[3][1] = 0;
+    matrix.data[0][2] = 0;    matrix.data[1][2] = 0;    matrix.data[2][2] = 1;    matrix.data[3][2] = 0;
+    matrix.data[0][3] = 0;    matrix.data[1][3] = 0;    matrix.data[2][3] = 0;    matrix.data[3][3] = 1;
+
+    return matrix;
+}
+
+GL2D_API GL2D_Matrix4f GL2D_Mat4Translate(GL2D_Matrix4f matrix, GL2D_Vector2f vector) {
+    // multiplying by a translation only changes the last column
+    for (uint32_t j = 0; j < 4; j++) {
+        matrix.data[3][j] = matrix.data[0][j] * vector.x + matrix.data[1][j] * vector.y + matrix.data[3][j];
+    }
+
+    return matrix;
+}
+
+GL2D_API GL2D_Matrix4f GL2D_Mat4Scale(GL2D_Matrix4f matrix, GL2D_Vector2f vector) {
+    for (uint32_t j = 0; j < 4; j++) {
+        matrix.data[0][j] *= vector.x;
+        matrix.data[1][j] *= vector.y;
+    }
+
+    return matrix;
+}
+
+//WTF DID I DO
+//FUCK YOU LEARN OPENGL
+GL2D_API GL2D_Matrix4f GL2D_Mat4Rotate(GL2D_Matrix4f matrix, float angle, GL2D_Vector2f vector) {
+    GL2D_Matrix4f rotation = { 0 };
+    GL2D_Matrix4f result;
+    float z = 0.5f;
+    float radians = angle * (PI / 180);
+    float radCos = cosf(radians);
+    float radSine = sinf(radians);
+    float oneMinusCos = 1 - radCos;
+
+    rotation.data[0][0] = radCos + vector.x * vector.x * oneMinusCos;
+    rotation.data[1][0] = vector.x * vector.y * oneMinusCos - z * radSine;
+    rotation.data[2][0] = vector.x * z * oneMinusCos + vector.y * radSine;
+    rotation.data[0][1] = vector.y * vector.y * oneMinusCos + z * radSine;
+    rotation.data[1][1] = radCos + vector.y * vector.y * oneMinusCos;
+    rotation.data[2][1] = vector.y * z * oneMinusCos - vector.x * radSine;
+    rotation.data[0][2] = z * vector.x * oneMinusCos - vector.y * radSine;
+    rotation.data[1][2] = z * vector.y * oneMinusCos + vector.x * radSine;
+    rotation.data[2][2] = radCos + z * z * oneMinusCos;
+    rotation.data[3][3] = 1;
+
+    GL2D_Mat4MultTo(&result, &matrix, &rotation);
+
+    return result;
+}
+
+GL2D_API GL2D_Matrix4f GL2D_Mat4Add(GL2D_Matrix4f matrix1, GL2D_Matrix4f matrix2) {
+    GL2D_Matrix4f result = { 0 };
+
+    for (uint32_t i = 0; i < 4; i++) {
+        for (uint32_t j = 0; j < 4; j++) {
+            result.data[i][j] = matrix1.data[i][j] + matrix2.data[i][j];
+        }
+    }
+
+    return result;
+}
+
+GL2D_API GL2D_Matrix4f GL2D_Mat4Sub(GL2D_Matrix4f matrix1, GL2D_Matrix4f matrix2) {
+    GL2D_Matrix4f result = { 0 };
+
+    for (uint32_t i = 0; i < 4; i++) {
+        for (uint32_t j = 0; j < 4; j++) {
+            result.data[i][j] = matrix1.data[i][j] - matrix2.data[i][j];
+        }
+    }
+
+    return result;
+}
+
+GL2D_API GL2D_Matrix4f GL2D_Mat4Mult(GL2D_Matrix4f matrix1, GL2D_Matrix4f matrix2) {
+    GL2D_Matrix4f result;
+
+    GL2D_Mat4MultTo(&result, &matrix1, &matrix2);
+
+    return result;
+}
+
+GL2D_API GL2D_Vector2f GL2D_Mat4Vec2Mult(GL2D_Matrix4f matrix, GL2D_Vector2f vector) {
+    GL2D_Vector2f result;
+
+    GL2D_Mat4Vec2MultTo(&result, &matrix, &vector);
+
+    return result;
+}
+
+GL2D_API GL2D_Matrix4f GL2D_Mat4Inverse(GL2D_Matrix4f matrix) {
+    GL2D_Matrix4f result;
+
+    if (!GL2D_Mat4InverseTo(&result, &matrix)) {
+        return GL2D_Mat4InitIdentity();
+    }
+
+    return result;
+}
+
+// The kernels below keep the scalar code's operation order so every path produces the same bits,
+// except the inverse which uses a different (block) formulation in SIMD.
+GL2D_API void GL2D_Mat4MultTo(GL2D_Matrix4f* result, const GL2D_Matrix4f* matrix1, const GL2D_Matrix4f* matrix2) {
+#if defined(GL2D_SIMD_AVX)
+    const float* a = &matrix1->data[0][0];
+    const float* b = &matrix2->data[0][0];
+    __m256 column0 = _mm256_broadcast_ps((const __m128*)(a + 0));
+    __m256 column1 = _mm256_broadcast_ps((const __m128*)(a + 4));
+    __m256 column2 = _mm256_broadcast_ps((const __m128*)(a + 8));
+    __m256 column3 = _mm256_broadcast_ps((const __m128*)(a + 12));
+    float out[16];
+
+    for (uint32_t i = 0; i < 4; i += 2) {
+        const float* lhs = b + i * 4;
+        const float* rhs = b + i * 4 + 4;
+        __m256 r = _mm256_mul_ps(column0, _mm256_setr_ps(lhs[0], lhs[0], lhs[0], lhs[0], rhs[0], rhs[0], rhs[0], rhs[0]));
+        r = _mm256_add_ps(r, _mm256_mul_ps(column1, _mm256_setr_ps(lhs[1], lhs[1], lhs[1], lhs[1], rhs[1], rhs[1], rhs[1], rhs[1])));
+        r = _mm256_add_ps(r, _mm256_mul_ps(column2, _mm256_setr_ps(lhs[2], lhs[2], lhs[2], lhs[2], rhs[2], rhs[2], rhs[2], rhs[2])));
+        r = _mm256_add_ps(r, _mm256_mul_ps(column3, _mm256_setr_ps(lhs[3], lhs[3], lhs[3], lhs[3], rhs[3], rhs[3], rhs[3], rhs[3])));
+        _mm256_storeu_ps(out + i * 4, r);
+    }
+
+    memcpy(result->data, out, sizeof(out));
+#elif defined(GL2D_SIMD_SSE2)
+    __m128 column0 = _mm_loadu_ps(matrix1->data[0]);
+    __m128 column1 = _mm_loadu_ps(matrix1->data[1]);
+    __m128 column2 = _mm_loadu_ps(matrix1->data[2]);
+    __m128 column3 = _mm_loadu_ps(matrix1->data[3]);
+    __m128 out[4];
+
+    for (uint32_t i = 0; i < 4; i++) {
+        const float* b = matrix2->data[i];
+        __m128 r = _mm_mul_ps(column0, _mm_set1_ps(b[0]));
+        r = _mm_add_ps(r, _mm_mul_ps(column1, _mm_set1_ps(b[1])));
+        r = _mm_add_ps(r, _mm_mul_ps(column2, _mm_set1_ps(b[2])));
+        r = _mm_add_ps(r, _mm_mul_ps(column3, _mm_set1_ps(b[3])));
+        out[i] = r;
+    }
+
+    for (uint32_t i = 0; i < 4; i++) {
+        _mm_storeu_ps(result->data[i], out[i]);
+    }
+#elif defined(GL2D_SIMD_NEON)
+    float32x4_t column0 = vld1q_f32(matrix1->data[0]);
+    float32x4_t column1 = vld1q_f32(matrix1->data[1]);
+    float32x4_t column2 = vld1q_f32(matrix1->data[2]);
+    float32x4_t column3 = vld1q_f32(matrix1->data[3]);
+    float32x4_t out[4];
+
+    for (uint32_t i = 0; i < 4; i++) {
+        const float* b = matrix2->data[i];
+        // separate mul/add instead of vmlaq so rounding matches the scalar code
+        float32x4_t r = vmulq_n_f32(column0, b[0]);
+        r = vaddq_f32(r, vmulq_n_f32(column1, b[1]));
+        r = vaddq_f32(r, vmulq_n_f32(column2, b[2]));
+        r = vaddq_f32(r, vmulq_n_f32(column3, b[3]));
+        out[i] = r;
+    }
+
+    for (uint32_t i = 0; i < 4; i++) {
+        vst1q_f32(result->data[i], out[i]);
+    }
+#else
+    GL2D_Matrix4f out;
+
+    for (uint32_t i = 0; i < 4; i++) {
+        for (uint32_t j = 0; j < 4; j++) {
+            out.data[i][j] = matrix1->data[0][j] * matrix2->data[i][0] +
+                             matrix1->data[1][j] * matrix2->data[i][1] +
+                             matrix1->data[2][j] * matrix2->data[i][2] +
+                             matrix1->data[3][j] * matrix2->data[i][3];
+        }
+    }
+
+    *result = out;
+#endif
+}
+
+GL2D_API void GL2D_Mat4Vec2MultTo(GL2D_Vector2f* result, const GL2D_Matrix4f* matrix, const GL2D_Vector2f* vector) {
+#if defined(GL2D_SIMD_SSE2)
+    __m128 r = _mm_mul_ps(_mm_loadu_ps(matrix->data[0]), _mm_set1_ps(vector->x));
+    r = _mm_add_ps(r, _mm_mul_ps(_mm_loadu_ps(matrix->data[1]), _mm_set1_ps(vector->y)));
+    r = _mm_add_ps(r, _mm_loadu_ps(matrix->data[2]));
+    r = _mm_add_ps(r, _mm_loadu_ps(matrix->data[3]));
+
+    float out[4];
+    _mm_storeu_ps(out, r);
+
+    result->x = out[0];
+    result->y = out[1];
+#elif defined(GL2D_SIMD_NEON)
+    float32x4_t r = vmulq_n_f32(vld1q_f32(matrix->data[0]), vector->x);
+    r = vaddq_f32(r, vmulq_n_f32(vld1q_f32(matrix->data[1]), vector->y));
+    r = vaddq_f32(r, vld1q_f32(matrix->data[2]));
+    r = vaddq_f32(r, vld1q_f32(matrix->data[3]));
+
+    result->x = vgetq_lane_f32(r, 0);
+    result->y = vgetq_lane_f32(r, 1);
+#else
+    float x = vector->x;
+    float y = vector->y;
+
+    result->x = matrix->data[0][0] * x + matrix->data[1][0] * y + matrix->data[2][0] + matrix->data[3][0];
+    result->y = matrix->data[0][1] * x + matrix->data[1][1] * y + matrix->data[2][1] + matrix->data[3][1];
+#endif
+}
+
+#if defined(GL2D_SIMD_SSE2)
+#define GL2D_SHUFFLE(a, b, x, y, z, w) _mm_shuffle_ps(a, b, _MM_SHUFFLE(w, z, y, x))
+#define GL2D_SWIZZLE(a, x, y, z, w) GL2D_SHUFFLE(a, a, x, y, z, w)
+
+// 2x2 matrices packed as (m00, m01, m10, m11)
+static __m128 Mat2Mult(__m128 a, __m128 b) {
+    return _mm_add_ps(_mm_mul_ps(a, GL2D_SWIZZLE(b, 0, 3, 0, 3)), _mm_mul_ps(GL2D_SWIZZLE(a, 1, 0, 3, 2), GL2D_SWIZZLE(b, 2, 1, 2, 1)));
+}
+
+// adjugate(a) * b
+static __m128 Mat2AdjMult(__m128 a, __m128 b) {
+    return _mm_sub_ps(_mm_mul_ps(GL2D_SWIZZLE(a, 3, 3, 0, 0), b), _mm_mul_ps(GL2D_SWIZZLE(a, 1, 1, 2, 2), GL2D_SWIZZLE(b, 2, 3, 0, 1)));
+}
+
+// a * adjugate(b)
+static __m128 Mat2MultAdj(__m128 a, __m128 b) {
+    return _mm_sub_ps(_mm_mul_ps(a, GL2D_SWIZZLE(b, 3, 0, 3, 0)), _mm_mul_ps(GL2D_SWIZZLE(a, 1, 0, 3, 2), GL2D_SWIZZLE(b, 2, 1, 2, 1)));
+}
+#endif
+
+GL2D_API bool GL2D_Mat4InverseTo(GL2D_Matrix4f* result, const GL2D_Matrix4f* matrix) {
+#if defined(GL2D_SIMD_SSE2)
+    // block inverse over the four 2x2 sub matrices, the inverse of the transpose is the transpose
+    // of the inverse so the column major storage can be treated as rows
+    __m128 row0 = _mm_loadu_ps(matrix->data[0]);
+    __m128 row1 = _mm_loadu_ps(matrix->data[1]);
+    __m128 row2 = _mm_loadu_ps(matrix->data[2]);
+    __m128 row3 = _mm_loadu_ps(matrix->data[3]);
+
+    __m128 a = _mm_movelh_ps(row0, row1);
+    __m128 b = _mm_movehl_ps(row1, row0);
+    __m128 c = _mm_movelh_ps(row2, row3);
+    __m128 d = _mm_movehl_ps(row3, row2);
+
+    __m128 determinants = _mm_sub_ps(
+        _mm_mul_ps(GL2D_SHUFFLE(row0, row2, 0, 2, 0, 2), GL2D_SHUFFLE(row1, row3, 1, 3, 1, 3)),
+        _mm_mul_ps(GL2D_SHUFFLE(row0, row2, 1, 3, 1, 3), GL2D_SHUFFLE(row1, row3, 0, 2, 0, 2)));
+    __m128 detA = GL2D_SWIZZLE(determinants, 0, 0, 0, 0);
+    __m128 detB = GL2D_SWIZZLE(determinants, 1, 1, 1, 1);
+    __m128 detC = GL2D_SWIZZLE(determinants, 2, 2, 2, 2);
+    __m128 detD = GL2D_SWIZZLE(determinants, 3, 3, 3, 3);
+
+    __m128 dc = Mat2AdjMult(d, c);
+    __m128 ab = Mat2AdjMult(a, b);
+    __m128 x = _mm_sub_ps(_mm_mul_ps(detD, a), Mat2Mult(b, dc));
+    __m128 w = _mm_sub_ps(_mm_mul_ps(detA, d), Mat2Mult(c, ab));
+    __m128 y = _mm_sub_ps(_mm_mul_ps(detB, c), Mat2MultAdj(d, ab));
+    __m128 z = _mm_sub_ps(_mm_mul_ps(detC, b), Mat2MultAdj(a, dc));
+
+    __m128 trace = _mm_mul_ps(ab, GL2D_SWIZZLE(dc, 0, 2, 1, 3));
+    trace = _mm_add_ps(trace, GL2D_SWIZZLE(trace, 1, 0, 3, 2));
+    trace = _mm_add_ps(trace, GL2D_SWIZZLE(trace, 2, 3, 0, 1));
+
+    __m128 det = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC)), trace);
+
+    if (_mm_cvtss_f32(det) == 0.0f) {
+        return false;
+    }
+
+    __m128 inverseDet = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), det);
+    x = _mm_mul_ps(x, inverseDet);
+    y = _mm_mul_ps(y, inverseDet);
+    z = _mm_mul_ps(z, inverseDet);
+    w = _mm_mul_ps(w, inverseDet);
+
+    _mm_storeu_ps(result->data[0], GL2D_SHUFFLE(x, y, 3, 1, 3, 1));
+    _mm_storeu_ps(result->data[1], GL2D_SHUFFLE(x, y, 2, 0, 2, 0));
+    _mm_storeu_ps(result->data[2], GL2D_SHUFFLE(z, w, 3, 1, 3, 1));
+    _mm_storeu_ps(result->data[3], GL2D_SHUFFLE(z, w, 2, 0, 2, 0));
+
+    return true;
+#else
+    const float* m = &matrix->data[0][0];
+    float inverse[16];
+
+    inverse[0] = m[5] * m[10] * m[15] - m[5] * m[11] * m[14] - m[9] * m[6] * m[15] + m[9] * m[7] * m[14] + m[13] * m[6] * m[11] - m[13] * m[7] * m[10];
+    inverse[4] = -m[4] * m[10] * m[15] + m[4] * m[11] * m[14] + m[8] * m[6] * m[15] - m[8] * m[7] * m[14] - m[12] * m[6] * m[11] + m[12] * m[7] * m[10];
+    inverse[8] = m[4] * m[9] * m[15] - m[4] * m[11] * m[13] - m[8] * m[5] * m[15] + m[8] * m[7] * m[13] + m[12] * m[5] * m[11] - m[12] * m[7] * m[9];
+    inverse[12] = -m[4] * m[9] * m[14] + m[4] * m[10] * m[13] + m[8] * m[5] * m[14] - m[8] * m[6] * m[13] - m[12] * m[5] * m[10] + m[12] * m[6] * m[9];
+    inverse[1] = -m[1] * m[10] * m[15] + m[1] * m[11] * m[14] + m[9] * m[2] * m[15] - m[9] * m[3] * m[14] - m[13] * m[2] * m[11] + m[13] * m[3] * m[10];
+    inverse[5] = m[0] * m[10] * m[15] - m[0] * m[11] * m[14] - m[8] * m[2] * m[15] + m[8] * m[3] * m[14] + m[12] * m[2] * m[11] - m[12] * m[3] * m[10];
+    inverse[9] = -m[0] * m[9] * m[15] + m[0] * m[11] * m[13] + m[8] * m[1] * m[15] - m[8] * m[3] * m[13] - m[12] * m[1] * m[11] + m[12] * m[3] * m[9];
+    inverse[13] = m[0] * m[9] * m[14] - m[0] * m[10] * m[13] - m[8] * m[1] * m[14] + m[8] * m[2] * m[13] + m[12] * m[1] * m[10] - m[12] * m[2] * m[9];
+    inverse[2] = m[1] * m[6] * m[15] - m[1] * m[7] * m[14] - m[5] * m[2] * m[15] + m[5] * m[3] * m[14] + m[13] * m[2] * m[7] - m[13] * m[3] * m[6];
+    inverse[6] = -m[0] * m[6] * m[15] + m[0] * m[7] * m[14] + m[4] * m[2] * m[15] - m[4] * m[3] * m[14] - m[12] * m[2] * m[7] + m[12] * m[3] * m[6];
+    inverse[10] = m[0] * m[5] * m[15] - m[0] * m[7] * m[13] - m[4] * m[1] * m[15] + m[4] * m[3] * m[13] + m[12] * m[1] * m[7] - m[12] * m[3] * m[5];
+    inverse[14] = -m[0] * m[5] * m[14] + m[0] * m[6] * m[13] + m[4] * m[1] * m[14] - m[4] * m[2] * m[13] - m[12] * m[1] * m[6] + m[12] * m[2] * m[5];
+    inverse[3] = -m[1] * m[6] * m[11] + m[1] * m[7] * m[10] + m[5] * m[2] * m[11] - m[5] * m[3] * m[10] - m[9] * m[2] * m[7] + m[9] * m[3] * m[6];
+    inverse[7] = m[0] * m[6] * m[11] - m[0] * m[7] * m[10] - m[4] * m[2] * m[11] + m[4] * m[3] * m[10] + m[8] * m[2] * m[7] - m[8] * m[3] * m[6];
+    inverse[11] = -m[0] * m[5] * m[11] + m[0] * m[7] * m[9] + m[4] * m[1] * m[11] - m[4] * m[3] * m[9] - m[8] * m[1] * m[7] + m[8] * m[3] * m[5];
+    inverse[15] = m[0] * m[5] * m[10] - m[0] * m[6] * m[9] - m[4] * m[1] * m[10] + m[4] * m[2] * m[9] + m[8] * m[1] * m[6] - m[8] * m[2] * m[5];
+
+    float det = m[0] * inverse[0] + m[1] * inverse[4] + m[2] * inverse[8] + m[3] * inverse[12];
+
+    if (det == 0.0f) {
+        return false;
+    }
+
+    float inverseDet = 1.0f / det;
+
+    for (uint32_t i = 0; i < 16; i++) {
+        (&result->data[0][0])[i] = inverse[i] * inverseDet;
+    }
+
+    return true;
+#endif
+}
+
+GL2D_API GL2D_Matrix4f GL2D_Mat4Ortho(float left, float right, float bottom, float top) {
+    GL2D_Matrix4f result = GL2D_Mat4InitIdentity();
+
+    result.data[0][0] = 2.0f / (right - left);
+    result.data[1][1] = 2.0f / (top - bottom);
+    result.data[2][2] = -1.0f;
+    result.data[3][0] = -(right + left) / (right - left);
+    result.data[3][1] = -(top + bottom) / (top - bottom);
+
+    return result;
+}
+
+// Array kernels: SIMD bodies handle four floats at a time, the scalar loops finish the tail.
+// Input and output may be the same array.
+GL2D_API void GL2D_Mat4TransformPoints(const GL2D_Matrix4f* matrix, const GL2D_Vector2f* in, GL2D_Vector2f* out, size_t count) {
+    const float* m = &matrix->data[0][0];
+    size_t i = 0;
+
+#if defined(GL2D_SIMD_SSE2)
+    __m128 column0 = _mm_setr_ps(m[0], m[1], m[0], m[1]);
+    __m128 column1 = _mm_setr_ps(m[4], m[5], m[4], m[5]);
+    __m128 column2 = _mm_setr_ps(m[8], m[9], m[8], m[9]);
+    __m128 column3 = _mm_setr_ps(m[12], m[13], m[12], m[13]);
+
+    for (; i + 2 <= count; i += 2) {
+        __m128 points = _mm_loadu_ps(&in[i].x);
+        __m128 x = GL2D_SWIZZLE(points, 0, 0, 2, 2);
+        __m128 y = GL2D_SWIZZLE(points, 1, 1, 3, 3);
+        __m128 r = _mm_add_ps(_mm_mul_ps(column0, x), _mm_mul_ps(column1, y));
+        r = _mm_add_ps(_mm_add_ps(r, column2), column3);
+        _mm_storeu_ps(&out[i].x, r);
+    }
+#elif defined(GL2D_SIMD_NEON)
+    for (; i + 4 <= count; i += 4) {
+        float32x4x2_t points = vld2q_f32(&in[i].x);
+        float32x4_t x = vaddq_f32(vmulq_n_f32(points.val[0], m[0]), vmulq_n_f32(points.val[1], m[4]));
+        float32x4_t y = vaddq_f32(vmulq_n_f32(points.val[0], m[1]), vmulq_n_f32(points.val[1], m[5]));
+        points.val[0] = vaddq_f32(vaddq_f32(x, vdupq_n_f32(m[8])), vdupq_n_f32(m[12]));
+        points.val[1] = vaddq_f32(vaddq_f32(y, vdupq_n_f32(m[9])), vdupq_n_f32(m[13]));
+        vst2q_f32(&out[i].x, points);
+    }
+#endif
+
+    for (; i < count; i++) {
+        float x = in[i].x;
+        float y = in[i].y;
+
+        out[i].x = m[0] * x + m[4] * y + m[8] + m[12];
+        out[i].y = m[1] * x + m[5] * y + m[9] + m[13];
+    }
+}
+
+GL2D_API void GL2D_Mat4TransformPointsSoA(const GL2D_Matrix4f* matrix, const float* inX, const float* inY, float* outX, float* outY, size_t count) {
+    const float* m = &matrix->data[0][0];
+    size_t i = 0;
+
+#if defined(GL2D_SIMD_SSE2)
+    __m128 m0 = _mm_set1_ps(m[0]), m1 = _mm_set1_ps(m[1]), m4 = _mm_set1_ps(m[4]), m5 = _mm_set1_ps(m[5]);
+    __m128 m8 = _mm_set1_ps(m[8]), m9 = _mm_set1_ps(m[9]), m12 = _mm_set1_ps(m[12]), m13 = _mm_set1_ps(m[13]);
+
+    for (; i + 4 <= count; i += 4) {
+        __m128 x = _mm_loadu_ps(inX + i);
+        __m128 y = _mm_loadu_ps(inY + i);
+        __m128 rx = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m0, x), _mm_mul_ps(m4, y)), m8), m12);
+        __m128 ry = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m1, x), _mm_mul_ps(m5, y)), m9), m13);
+        _mm_storeu_ps(outX + i, rx);
+        _mm_storeu_ps(outY + i, ry);
+    }
+#elif defined(GL2D_SIMD_NEON)
+    for (; i + 4 <= count; i += 4) {
+        float32x4_t x = vld1q_f32(inX + i);
+        float32x4_t y = vld1q_f32(inY + i);
+        float32x4_t rx = vaddq_f32(vmulq_n_f32(x, m[0]), vmulq_n_f32(y, m[4]));
+        float32x4_t ry = vaddq_f32(vmulq_n_f32(x, m[1]), vmulq_n_f32(y, m[5]));
+        vst1q_f32(outX + i, vaddq_f32(vaddq_f32(rx, vdupq_n_f32(m[8])), vdupq_n_f32(m[12])));
+        vst1q_f32(outY + i, vaddq_f32(vaddq_f32(ry, vdupq_n_f32(m[9])), vdupq_n_f32(m[13])));
+    }
+#endif
+
+    for (; i < count; i++) {
+        float x = inX[i];
+        float y = inY[i];
+
+        outX[i] = m[0] * x + m[4] * y + m[8] + m[12];
+        outY[i] = m[1] * x + m[5] * y + m[9] + m[13];
+    }
+}
+
+static void FloatArrayAdd(const float* in1, const float* in2, float* out, size_t count) {
+    size_t i = 0;
+
+#if defined(GL2D_SIMD_SSE2)
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(in1 + i), _mm_loadu_ps(in2 + i)));
+    }
+#elif defined(GL2D_SIMD_NEON)
+    for (; i + 4 <= count; i += 4) {
+        vst1q_f32(out + i, vaddq_f32(vld1q_f32(in1 + i), vld1q_f32(in2 + i)));
+    }
+#endif
+
+    for (; i < count; i++) {
+        out[i] = in1[i] + in2[i];
+    }
+}
+
+static void FloatArrayScale(const float* in, float value, float* out, size_t count) {
+    size_t i = 0;
+
+#if defined(GL2D_SIMD_SSE2)
+    __m128 scale = _mm_set1_ps(value);
+
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(out + i, _mm_mul_ps(_mm_loadu_ps(in + i), scale));
+    }
+#elif defined(GL2D_SIMD_NEON)
+    for (; i + 4 <= count; i += 4) {
+        vst1q_f32(out + i, vmulq_n_f32(vld1q_f32(in + i), value));
+    }
+#endif
+
+    for (; i < count; i++) {
+        out[i] = in[i] * value;
+    }
+}
+
+GL2D_API void GL2D_VecArrayAdd(const GL2D_Vector2f* in1, const GL2D_Vector2f* in2, GL2D_Vector2f* out, size_t count) {
+    FloatArrayAdd(&in1->x, &in2->x, &out->x, count * 2);
+}
+
+GL2D_API void GL2D_VecArrayAddSoA(const float* inX1, const float* inY1, const float* inX2, const float* inY2, float* outX, float* outY, size_t count) {
+    FloatArrayAdd(inX1, inX2, outX, count);
+    FloatArrayAdd(inY1, inY2, outY, count);
+}
+
+GL2D_API void GL2D_VecArrayScale(const GL2D_Vector2f* in, float value, GL2D_Vector2f* out, size_t count) {
+    FloatArrayScale(&in->x, value, &out->x, count * 2);
+}
+
+GL2D_API void GL2D_VecArrayScaleSoA(const float* inX, const float* inY, float value, float* outX, float* outY, size_t count) {
+    FloatArrayScale(inX, value, outX, count);
+    FloatArrayScale(inY, value, outY, count);
+}
+
+GL2D_API void GL2D_VecArrayRotate(const GL2D_Vector2f* in, float angle, GL2D_Vector2f* out, size_t count) {
+    float radians = angle * (PI / 180);
+    float radCos = cosf(radians);
+    float radSine = sinf(radians);
+    size_t i = 0;
+
+#if defined(GL2D_SIMD_SSE2)
+    __m128 cosine = _mm_set1_ps(radCos);
+    __m128 sine = _mm_setr_ps(-radSine, radSine, -radSine, radSine);
+
+    for (; i + 2 <= count; i += 2) {
+        __m128 points = _mm_loadu_ps(&in[i].x);
+        __m128 swapped = GL2D_SWIZZLE(points, 1, 0, 3, 2);
+        _mm_storeu_ps(&out[i].x, _mm_add_ps(_mm_mul_ps(points, cosine), _mm_mul_ps(swapped, sine)));
+    }
+#elif defined(GL2D_SIMD_NEON)
+    for (; i + 4 <= count; i += 4) {
+        float32x4x2_t points = vld2q_f32(&in[i].x);
+        float32x4x2_t rotated;
+        rotated.val[0] = vsubq_f32(vmulq_n_f32(points.val[0], radCos), vmulq_n_f32(points.val[1], radSine));
+        rotated.val[1] = vaddq_f32(vmulq_n_f32(points.val[0], radSine), vmulq_n_f32(points.val[1], radCos));
+        vst2q_f32(&out[i].x, rotated);
+    }
+#endif
+
+    for (; i < count; i++) {
+        float x = in[i].x;
+        float y = in[i].y;
+
+        out[i].x = x * radCos - y * radSine;
+        out[i].y = x * radSine + y * radCos;
+    }
+}
+
+GL2D_API void GL2D_VecArrayRotateSoA(const float* inX, const float* inY, float angle, float* outX, float* outY, size_t count) {
+    float radians = angle * (PI / 180);
+    float radCos = cosf(radians);
+    float radSine = sinf(radians);
+    size_t i = 0;
+
+#if defined(GL2D_SIMD_SSE2)
+    __m128 cosine = _mm_set1_ps(radCos);
+    __m128 sine = _mm_set1_ps(radSine);
+
+    for (; i + 4 <= count; i += 4) {
+        __m128 x = _mm_loadu_ps(inX + i);
+        __m128 y = _mm_loadu_ps(inY + i);
+        _mm_storeu_ps(outX + i, _mm_sub_ps(_mm_mul_ps(x, cosine), _mm_mul_ps(y, sine)));
+        _mm_storeu_ps(outY + i, _mm_add_ps(_mm_mul_ps(x, sine), _mm_mul_ps(y, cosine)));
+    }
+#elif defined(GL2D_SIMD_NEON)
+    for (; i + 4 <= count; i += 4) {
+        float32x4_t x = vld1q_f32(inX + i);
+        float32x4_t y = vld1q_f32(inY + i);
+        vst1q_f32(outX + i, vsubq_f32(vmulq_n_f32(x, radCos), vmulq_n_f32(y, radSine)));
+        vst1q_f32(outY + i, vaddq_f32(vmulq_n_f32(x, radSine), vmulq_n_f32(y, radCos)));
+    }
+#endif
+
+    for (; i < count; i++) {
+        float x = inX[i];
+        float y = inY[i];
+
+        outX[i] = x * radCos - y * radSine;
+        outY[i] = x * radSine + y * radCos;
+    }
+}
+
+GL2D_API void GL2D_VecArrayNormalize(const GL2D_Vector2f* in, GL2D_Vector2f* out, size_t count) {
+    size_t i = 0;
+
+#if defined(GL2D_SIMD_SSE2)
+    for (; i + 2 <= count; i += 2) {
+        __m128 points = _mm_loadu_ps(&in[i].x);
+        __m128 squared = _mm_mul_ps(points, points);
+        __m128 magnitude = _mm_sqrt_ps(_mm_add_ps(squared, GL2D_SWIZZLE(squared, 1, 0, 3, 2)));
+        _mm_storeu_ps(&out[i].x, _mm_div_ps(points, magnitude));
+    }
+#elif defined(GL2D_SIMD_NEON) && defined(__aarch64__)
+    for (; i + 4 <= count; i += 4) {
+        float32x4x2_t points = vld2q_f32(&in[i].x);
+        float32x4_t squared = vaddq_f32(vmulq_f32(points.val[0], points.val[0]), vmulq_f32(points.val[1], points.val[1]));
+        float32x4_t magnitude = vsqrtq_f32(squared);
+        points.val[0] = vdivq_f32(points.val[0], magnitude);
+        points.val[1] = vdivq_f32(points.val[1], magnitude);
+        vst2q_f32(&out[i].x, points);
+    }
+#endif
+
+    for (; i < count; i++) {
+        float magnitude = sqrtf(in[i].x * in[i].x + in[i].y * in[i].y);
+
+        out[i].x = in[i].x / magnitude;
+        out[i].y = in[i].y / magnitude;
+    }
+}
+
+GL2D_API void GL2D_VecArrayNormalizeSoA(const float* inX, const float* inY, float* outX, float* outY, size_t count) {
+    size_t i = 0;
+
+#if defined(GL2D_SIMD_SSE2)
+    for (; i + 4 <= count; i += 4) {
+        __m128 x = _mm_loadu_ps(inX + i);
+        __m128 y = _mm_loadu_ps(inY + i);
+        __m128 magnitude = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)));
+        _mm_storeu_ps(outX + i, _mm_div_ps(x, magnitude));
+        _mm_storeu_ps(outY + i, _mm_div_ps(y, magnitude));
+    }
+#elif defined(GL2D_SIMD_NEON) && defined(__aarch64__)
+    for (; i + 4 <= count; i += 4) {
+        float32x4_t x = vld1q_f32(inX + i);
+        float32x4_t y = vld1q_f32(inY + i);
+        float32x4_t magnitude = vsqrtq_f32(vaddq_f32(vmulq_f32(x, x), vmulq_f32(y, y)));
+        vst1q_f32(outX + i, vdivq_f32(x, magnitude));
+        vst1q_f32(outY + i, vdivq_f32(y, magnitude));
+    }
+#endif
+
+    for (; i < count; i++) {
+        float x = inX[i];
+        float y = inY[i];
+        float magnitude = sqrtf(x * x + y * y);
+
+        outX[i] = x / magnitude;
+        outY[i] = y / magnitude;
+    }
+}
+
+static void SinCos(float radians, float* sine, float* cosine) {
+    // kept side by side so the compiler can fold them into a single sincos
+    *sine = sinf(radians);
+    *cosine = cosf(radians);
+}
+
+GL2D_API GL2D_Affine2D GL2D_AffineIdentity() {
+    GL2D_Affine2D affine;
+
+    affine.data[0][0] = 1;    affine.data[1][0] = 0;    affine.data[2][0] = 0;
+    affine.data[0][1] = 0;    affine.data[1][1] = 1;    affine.data[2][1] = 0;
+
+    return affine;
+}
+
+// scale, then rotate by rotation.x degrees, then translate
+GL2D_API GL2D_Affine2D GL2D_TransformToAffine(GL2D_Transform transform) {
+    GL2D_Affine2D affine;
+    float radSine;
+    float radCos;
+
+    SinCos(transform.rotation.x * (float)(PI / 180), &radSine, &radCos);
+
+    affine.data[0][0] = radCos * transform.scale.x;
+    affine.data[0][1] = radSine * transform.scale.x;
+    affine.data[1][0] = -radSine * transform.scale.y;
+    affine.data[1][1] = radCos * transform.scale.y;
+    affine.data[2][0] = transform.position.x;
+    affine.data[2][1] = transform.position.y;
+
+    return affine;
+}
+
+GL2D_API GL2D_Affine2D GL2D_AffineMult(GL2D_Affine2D affine1, GL2D_Affine2D affine2) {
+    GL2D_Affine2D result;
+
+    GL2D_AffineMultTo(&result, &affine1, &affine2);
+
+    return result;
+}
+
+GL2D_API void GL2D_AffineMultTo(GL2D_Affine2D* result, const GL2D_Affine2D* affine1, const GL2D_Affine2D* affine2) {
+    const float (*a)[2] = affine1->data;
+    const float (*b)[2] = affine2->data;
+    GL2D_Affine2D out;
+
+    out.data[0][0] = a[0][0] * b[0][0] + a[1][0] * b[0][1];
+    out.data[0][1] = a[0][1] * b[0][0] + a[1][1] * b[0][1];
+    out.data[1][0] = a[0][0] * b[1][0] + a[1][0] * b[1][1];
+    out.data[1][1] = a[0][1] * b[1][0] + a[1][1] * b[1][1];
+    out.data[2][0] = a[0][0] * b[2][0] + a[1][0] * b[2][1] + a[2][0];
+    out.data[2][1] = a[0][1] * b[2][0] + a[1][1] * b[2][1] + a[2][1];
+
+    *result = out;
+}
+
+GL2D_API GL2D_Vector2f GL2D_AffineTransformPoint(GL2D_Affine2D affine, GL2D_Vector2f point) {
+    return (GL2D_Vector2f) {
+        affine.data[0][0] * point.x + affine.data[1][0] * point.y + affine.data[2][0],
+        affine.data[0][1] * point.x + affine.data[1][1] * point.y + affine.data[2][1]
+    };
+}
+
+GL2D_API GL2D_Matrix4f GL2D_AffineToMat4(GL2D_Affine2D affine) {
+    GL2D_Matrix4f matrix = GL2D_Mat4InitIdentity();
+
+    matrix.data[0][0] = affine.data[0][0];
+    matrix.data[0][1] = affine.data[0][1];
+    matrix.data[1][0] = affine.data[1][0];
+    matrix.data[1][1] = affine.data[1][1];
+    matrix.data[3][0] = affine.data[2][0];
+    matrix.data[3][1] = affine.data[2][1];
+
+    return matrix;
+}
+
+GL2D_API GL2D_Matrix4f GL2D_MatTransform(GL2D_Matrix4f matrix, GL2D_Vector2f vector);
+GL2D_API GL2D_Matrix4f GL2D_MatScale(GL2D_Matrix4f matrix, GL2D_Vector2f vector);
+GL2D_API GL2D_Matrix4f GL2D_MatRotate(GL2D_Matrix4f matrix, GL2D_Vector2f vector);
+
+GL2D_API void GL2D_SetViewport(GL2D_Rect rect) {
+    if (currentRenderer != NULL) {
+        currentRenderer->viewport = rect;
+    }
+
+    if (SoftwareActive()) {
+        SoftwareSetViewport(currentRenderer, rect);
+        return;
+    }
+
+    glViewport(rect.x, rect.y, rect.z, rect.w);
+}
+
+GL2D_API void GL2D_SetClearColor(GL2D_Color color) {
+    if (SoftwareActive()) {
+        SoftwareSetClearColor(currentRenderer, color);
+        return;
+    }
+
+    StateClearColor(color);
+}
+
+GL2D_API GL2D_Renderer GL2D_CreateRenderer() {
+    GL2D_RendererDesc desc = { 0 };
+    return GL2D_CreateRendererEx(&desc);
+}
+
+GL2D_API GL2D_Renderer GL2D_CreateRendererEx(const GL2D_RendererDesc* desc) {
+    bool software = desc->backend == GL2D_BACKEND_SOFTWARE;
+
+    // contexts made through EGL or a windowing library need their own loader, glad's default only knows WGL/GLX
+    if (!software) {
+        glLoadProc = desc->loadProc;
+
+        if (!(glLoadProc != NULL ? gladLoadGLLoader((GLADloadproc)glLoadProc) : gladLoadGL())) {
+            fprintf(stderr, "Failed to initialize GLAD\n");
+            return NULL;
+        }
+    }
+
+    GL2D_Renderer renderer = MemAlloc(sizeof(struct GL2D_Renderer));
+
+    if (renderer == NULL) {
+        fprintf(stderr, "ERROR: Failed to allocate renderer\n");
+        return NULL;
+    }
+
+    memset(renderer, 0, sizeof(struct GL2D_Renderer));
+
+    // a new context may come from a different driver
+    ResetShaderCache();
+
+    renderer->uploadBudget = desc->uploadBudget > 0 ? desc->uploadBudget : GL2D_DEFAULT_UPLOAD_BUDGET;
+    renderer->frameArena = GL2D_CreateFrameArena(desc->frameArenaSize > 0 ? desc->frameArenaSize : GL2D_DEFAULT_FRAME_ARENA_SIZE, GL2D_FRAME_ARENA_MAX_FRAMES);
+
+    if (renderer->frameArena == NULL) {
+        MemFree(renderer);
+        return NULL;
+    }
+
+    GL2D_MakeRendererCurrent(renderer);
+    GL2D_InvalidateStateCache(renderer);
+
+    if (software) {
+        if (!InitSoftware(renderer, desc) || !InitProfiler(renderer)) {
+            GL2D_DestroyRenderer(renderer);
+            return NULL;
+        }
+
+        return renderer;
+    }
+
+    glFrontFace(GL_CW);
+    glCullFace(GL_BACK);
+    StateEnable(GL_CULL_FACE, true);
+    StateEnable(GL_DEPTH_TEST, true);
+    glDepthFunc(GL_LEQUAL);
+    StateEnable(GL_BLEND, true);
+    StateBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    //glEnable(GL_FRAMEBUFFER_SRGB);
+
+    // primitives pick their tessellation by the pixel size, GL2D_SetViewport keeps this current
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    renderer->viewport = (GL2D_Rect) { (uint32_t)viewport[0], (uint32_t)viewport[1], (uint32_t)viewport[2], (uint32_t)viewport[3] };
+
+    if (!InitBatch(renderer) || !InitInstancing(renderer) || !InitProfiler(renderer)) {
+        GL2D_DestroyRenderer(renderer);
+        return NULL;
+    }
+
+    return renderer;
+}
+
+GL2D_API void GL2D_DestroyRenderer(GL2D_Renderer renderer) {
+    if (renderer->software != NULL) {
+        if (renderer->whiteTexture != GL2D_INVALID_HANDLE) {
+            GL2D_DestroyTexture(renderer->whiteTexture);
+        }
+
+        StopWorkerPool();
+        FreeSoftware(renderer);
+        FreePrimitives(renderer);
+        MemFree(renderer->batchFonts);
+        GL2D_DestroyFrameArena(renderer->frameArena);
+        FreeProfiler(renderer);
+
+#ifdef GL2D_DEBUG
+        GL2D_ReportLeaks();
+#endif
+
+        if (currentRenderer == renderer) {
+            currentRenderer = NULL;
+        }
+
+        MemFree(renderer);
+        return;
+    }
+
+    StateForgetVertexArray(renderer->batchVao);
+    StateForgetBuffer(renderer->batchVbo);
+    StateForgetBuffer(renderer->batchIbo);
+    glDeleteVertexArrays(1, &renderer->batchVao);
+    glDeleteBuffers(1, &renderer->batchVbo);
+    glDeleteBuffers(1, &renderer->batchIbo);
+
+    if (renderer->batchShader != GL2D_INVALID_HANDLE) {
+        GL2D_DestroyShader(renderer->batchShader);
+    }
+
+    if (renderer->whiteTexture != GL2D_INVALID_HANDLE) {
+        GL2D_DestroyTexture(renderer->whiteTexture);
+    }
+
+    MemFree(renderer->batchVertices);
+    MemFree(renderer->batchFonts);
+
+    StateForgetVertexArray(renderer->instanceVao);
+    StateForgetBuffer(renderer->instanceCornerVbo);
+    glDeleteVertexArrays(1, &renderer->instanceVao);
+    glDeleteBuffers(1, &renderer->instanceCornerVbo);
+
+    if (renderer->instanceShader != GL2D_INVALID_HANDLE) {
+        GL2D_DestroyShader(renderer->instanceShader);
+    }
+
+    if (renderer->textShader != GL2D_INVALID_HANDLE) {
+        GL2D_DestroyShader(renderer->textShader);
+    }
+
+    if (renderer->tilemapShader != GL2D_INVALID_HANDLE) {
+        GL2D_DestroyShader(renderer->tilemapShader);
+    }
+
+    if (renderer->instanceStream != NULL) {
+        GL2D_DestroyStreamBuffer(renderer->instanceStream);
+    }
+
+    StopWorkerPool();
+    FreeTextureLoads();
+    glDeleteBuffers(1, &renderer->uploadBuffer);
+    GL2D_DestroyFrameArena(renderer->frameArena);
+    ClearVertexArrayCache();
+    FreeProfiler(renderer);
+    FreePrimitives(renderer);
+
+#ifdef GL2D_DEBUG
+    GL2D_ReportLeaks();
+#endif
+
+    if (currentRenderer == renderer) {
+        currentRenderer = NULL;
+    }
+
+    MemFree(renderer);
+}
+
+GL2D_API void GL2D_MakeRendererCurrent(GL2D_Renderer renderer) {
+    currentRenderer = renderer;
+}
+
+GL2D_API void GL2D_InvalidateStateCache(GL2D_Renderer renderer) {
+    GL2D_StateCounters counters = renderer->state.counters;
+
+    memset(&renderer->state, 0xFF, sizeof(StateCache));
+    renderer->state.counters = counters;
+}
+
+GL2D_API GL2D_StateCounters GL2D_GetStateCounters(GL2D_Renderer renderer) {
+    return renderer->state.counters;
+}
+
+GL2D_API void GL2D_ResetStateCounters(GL2D_Renderer renderer) {
+    memset(&renderer->state.counters, 0, sizeof(GL2D_StateCounters));
+}
+
+GL2D_API GL2D_FrameStats GL2D_GetFrameStats(GL2D_Renderer renderer) {
+    return renderer->lastFrameStats;
+}
+
+GL2D_API void GL2D_UpdateRenderer(GL2D_Renderer renderer) {
+    double now = ProfileNow();
+
+    renderer->frameStats.shaderCount = shaderPool.liveCount;
+    renderer->frameStats.textureCount = texturePool.liveCount;
+    renderer->frameStats.cpuFrameTime = renderer->frameStart > 0 ? (now - renderer->frameStart) * 1000 : 0;
+    renderer->frameStats.heapAllocations = (uint64_t)(heapAllocations - renderer->heapAllocationsStart);
+    renderer->frameStats.heapFrees = (uint64_t)(heapFrees - renderer->heapFreesStart);
+    ProfilerEndFrame(renderer, now);
+
+    renderer->lastFrameStats = renderer->frameStats;
+    memset(&renderer->frameStats, 0, sizeof(GL2D_FrameStats));
+    renderer->frameStart = now;
+    renderer->heapAllocationsStart = heapAllocations;
+    renderer->heapFreesStart = heapFrees;
+
+    GL2D_FrameArenaNextFrame(renderer->frameArena);
+
+    if (renderer->software != NULL) {
+        SoftwareClear(renderer);
+        return;
+    }
+
+    GL2D_StreamBufferEndFrame(renderer->instanceStream);
+    ProcessTextureUploads(renderer);
+
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+}
+
+GL2D_API GL2D_FrameArena GL2D_GetFrameArena(GL2D_Renderer renderer) {
+    return renderer->frameArena;
+}
+
+GL2D_API void GL2D_SetTextureUploadBudget(GL2D_Renderer renderer, uint64_t bytesPerFrame) {
+    renderer->uploadBudget = bytesPerFrame;
+}
+
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+    #define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+    #define GL_PROGRAM_BINARY_LENGTH 0x8741
+    #define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
+typedef void (APIENTRYP GetProgramBinaryProc)(GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary);
+typedef void (APIENTRYP ProgramBinaryProc)(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length);
+typedef void (APIENTRYP ProgramParameteriProc)(GLuint program, GLenum pname, GLint value);
+
+#define SHADER_CACHE_MAGIC 0x42503247
+#define SHADER_CACHE_VERSION 1
+
+typedef struct ShaderCacheHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+    uint32_t format;
+    uint32_t size;
+} ShaderCacheHeader;
+
+// Program binaries are only valid for the driver that produced them, so the key mixes in the
+// vendor, renderer and version strings next to the sources.
+static struct {
+    bool enabled;
+    bool initialized;
+    bool supported;
+    char directory[256];
+    uint64_t deviceHash;
+    GetProgramBinaryProc getProgramBinary;
+    ProgramBinaryProc programBinary;
+    ProgramParameteriProc programParameteri;
+    GL2D_ShaderCacheStats stats;
+} shaderCache = { .enabled = true, .directory = "shader_cache" };
+
+static uint64_t HashStringContinue(uint64_t hash, const char* string) {
+    // the terminator goes in too so "ab"+"c" and "a"+"bc" don't collide
+    return HashBytesContinue(hash, string != NULL ? string : "", (string != NULL ? strlen(string) : 0) + 1);
+}
+
+static void InitShaderCache(void) {
+    shaderCache.initialized = true;
+    shaderCache.supported = false;
+
+    if (!HasGLVersion(4, 1) && !HasGLExtension("GL_ARB_get_program_binary")) {
+        return;
+    }
+
+    void* getProgramBinary = GetGLProc("glGetProgramBinary");
+    void* programBinary = GetGLProc("glProgramBinary");
+    void* programParameteri = GetGLProc("glProgramParameteri");
+
+    if (getProgramBinary == NULL || programBinary == NULL || programParameteri == NULL) {
+        return;
+    }
+
+    memcpy(&shaderCache.getProgramBinary, &getProgramBinary, sizeof(void*));
+    memcpy(&shaderCache.programBinary, &programBinary, sizeof(void*));
+    memcpy(&shaderCache.programParameteri, &programParameteri, sizeof(void*));
+
+    int formatCount = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+
+    uint64_t hash = HashBytes(NULL, 0);
+    hash = HashStringContinue(hash, (const char*)glGetString(GL_VENDOR));
+    hash = HashStringContinue(hash, (const char*)glGetString(GL_RENDERER));
+    hash = HashStringContinue(hash, (const char*)glGetString(GL_VERSION));
+
+    shaderCache.deviceHash = hash;
+    shaderCache.supported = formatCount > 0;
+}
+
+static void ResetShaderCache(void) {
+    shaderCache.initialized = false;
+}
+
+static bool ShaderCacheReady(void) {
+    if (!shaderCache.enabled) {
+        return false;
+    }
+
+    if (!shaderCache.initialized) {
+        InitShaderCache();
+    }
+
+    return shaderCache.supported;
+}
+
+static void ShaderCachePath(char* path, size_t size, uint64_t key) {
+    snprintf(path, size, "%s/%08x%08x.bin", shaderCache.directory, (uint32_t)(key >> 32), (uint32_t)key);
+}
+
+static bool LoadCachedProgram(Shader* shader, uint64_t key) {
+    char path[320];
+    ShaderCachePath(path, sizeof(path), key);
+
+    MappedFile mapped;
+
+    if (!MapFile(&mapped, path)) {
+        return false;
+    }
+
+    ShaderCacheHeader header;
+    bool loaded = false;
+
+    if (mapped.size >= sizeof(ShaderCacheHeader)) {
+        memcpy(&header, mapped.data, sizeof(ShaderCacheHeader));
+
+        if (header.magic == SHADER_CACHE_MAGIC && header.version == SHADER_CACHE_VERSION && header.key == key &&
+            header.size <= mapped.size - sizeof(ShaderCacheHeader)) {
+            shader->id = glCreateProgram();
+            shaderCache.programBinary(shader->id, header.format, mapped.data + sizeof(ShaderCacheHeader), header.size);
+
+            int success = 0;
+            glGetProgramiv(shader->id, GL_LINK_STATUS, &success);
+
+            if (success) {
+                loaded = true;
+            }
+            else {
+                // a driver update can invalidate binaries, the source compile below replaces the file
+                glDeleteProgram(shader->id);
+                shader->id = 0;
+                shaderCache.stats.rejected++;
+            }
+        }
+    }
+
+    UnmapFile(&mapped);
+
+    return loaded;
+}
+
+static void StoreCachedProgram(Shader* shader, uint64_t key) {
+    int length = 0;
+    glGetProgramiv(shader->id, GL_PROGRAM_BINARY_LENGTH, &length);
+
+    if (length <= 0) {
+        return;
+    }
+
+    uint8_t* binary = MemAlloc(length);
+
+    if (binary == NULL) {
+        return;
+    }
+
+    GLenum format = 0;
+    GLsizei written = 0;
+    shaderCache.getProgramBinary(shader->id, length, &written, &format, binary);
+
+#ifdef GL2D_PLATFORM_WINDOWS
+    CreateDirectoryA(shaderCache.directory, NULL);
+#else
+    mkdir(shaderCache.directory, 0755);
+#endif
+
+    char path[320];
+    ShaderCachePath(path, sizeof(path), key);
+
+    FILE* file = fopen(path, "wb");
+
+    if (file != NULL) {
+        ShaderCacheHeader header = { SHADER_CACHE_MAGIC, SHADER_CACHE_VERSION, key, format, (uint32_t)written };
+
+        if (fwrite(&header, sizeof(ShaderCacheHeader), 1, file) == 1 && fwrite(binary, written, 1, file) == 1) {
+            shaderCache.stats.stored++;
+        }
+
+        fclose(file);
+    }
+
+    MemFree(binary);
+}
+
+GL2D_API void GL2D_SetShaderCacheEnabled(bool enabled) {
+    shaderCache.enabled = enabled;
+}
+
+GL2D_API void GL2D_SetShaderCacheDirectory(const char* directory) {
+    snprintf(shaderCache.directory, sizeof(shaderCache.directory), "%s", directory);
+}
+
+GL2D_API GL2D_ShaderCacheStats GL2D_GetShaderCacheStats() {
+    return shaderCache.stats;
+}
+
+// The sources don't have to be null-terminated, which lets them point straight into a mapped pack.
+static GL2D_Shader CreateShader(const char* vertexSource, int32_t vertexLength, const char* fragmentSource, int32_t fragmentLength) {
+    if (!RequireGL("GL2D_CreateShaderFrom*")) {
+        return GL2D_INVALID_HANDLE;
+    }
+
+    GL2D_Shader handle = PoolAllocate(&shaderPool);
+
+    if (handle == GL2D_INVALID_HANDLE) {
+        printf("ERROR: can't allocate shader");
+        return GL2D_INVALID_HANDLE;
+    }
+
+    Shader* shader = PoolGet(&shaderPool, handle);
+
+    bool cached = ShaderCacheReady();
+    uint64_t key = 0;
+
+    if (cached) {
+        key = HashBytesContinue(shaderCache.deviceHash, vertexSource, vertexLength);
+        key = HashBytesContinue(key, "", 1);
+        key = HashBytesContinue(key, fragmentSource, fragmentLength);
+        key = HashBytesContinue(key, "", 1);
+
+        if (LoadCachedProgram(shader, key)) {
+            shaderCache.stats.hits++;
+            ReflectUniforms(shader);
+            return handle;
+        }
+
+        shaderCache.stats.misses++;
+    }
+
+    uint32_t vertexShader = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(vertexShader, 1, &vertexSource, &vertexLength);
+    glCompileShader(vertexShader);
+    // check for shader compile errors
+    int success;
+    char infoLog[512];
+    glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
+    if (!success)
+    {
+        glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
+        printf("ERROR::SHADER::VERTEX::COMPILATION_FAILED: %s\n", infoLog);
+    }
+    // fragment shader
+    uint32_t fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+
+    glShaderSource(fragmentShader, 1, &fragmentSource, &fragmentLength);
+    glCompileShader(fragmentShader);
+    // check for shader compile errors
+    glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
+    if (!success)
+    {
+        glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
+        printf("ERROR::SHADER::FRAGMENT::COMPILATION_FAILED: %s\n", infoLog);
+    }
+    // link shaders
+    shader->id = glCreateProgram();
+    glAttachShader(shader->id, vertexShader);
+    glAttachShader(shader->id, fragmentShader);
+
+    if (cached) {
+        shaderCache.programParameteri(shader->id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+
+    glLinkProgram(shader->id);
+    // check for linking errors
+    glGetProgramiv(shader->id, GL_LINK_STATUS, &success);
+    if (!success) {
+        glGetProgramInfoLog(shader->id, 512, NULL, infoLog);
+        printf("ERROR::SHADER::PROGRAM::LINKING_FAILED: %s\n", infoLog);
+    }
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+
+    if (success) {
+        ReflectUniforms(shader);
+
+        if (cached) {
+            StoreCachedProgram(shader, key);
+        }
+    }
+
+    return handle;
+}
+
+GL2D_API GL2D_Shader GL2D_CreateShaderFromSource(const char* vertexSource, const char* fragmentSource) {
+    return CreateShader(vertexSource, (int32_t)strlen(vertexSource), fragmentSource, (int32_t)strlen(fragmentSource));
 }
 
 GL2D_API GL2D_Shader GL2D_CreateShaderFromFiles(const char* vertexPath, const char* fragmentPath) {
-    GL2D_Shader shader = malloc(sizeof(struct GL2D_Shader));
+    char* vertexSource = ReadEntireFile(vertexPath, NULL);
+    char* fragmentSource = ReadEntireFile(fragmentPath, NULL);
+
+    if (vertexSource == NULL || fragmentSource == NULL) {
+        MemFree(vertexSource);
+        MemFree(fragmentSource);
+        return GL2D_INVALID_HANDLE;
+    }
+
+    GL2D_Shader shader = GL2D_CreateShaderFromSource(vertexSource, fragmentSource);
+
+    MemFree(vertexSource);
+    MemFree(fragmentSource);
+
+    return shader;
+}
+
+static void ReflectUniforms(Shader* shader) {
+    int count = 0;
+    glGetProgramiv(shader->id, GL_ACTIVE_UNIFORMS, &count);
+
+    if (count <= 0) {
+        return;
+    }
+
+    shader->uniforms = MemAlloc(count * sizeof(ShaderUniform));
+
+    uint32_t tableSize = 1;
+
+    while (tableSize < (uint32_t)count * 2) {
+        tableSize <<= 1;
+    }
+
+    shader->uniformTable = MemAlloc(tableSize * sizeof(int32_t));
+
+    if (shader->uniforms == NULL || shader->uniformTable == NULL) {
+        fprintf(stderr, "ERROR: Couldn't allocate uniform table\n");
+        MemFree(shader->uniforms);
+        MemFree(shader->uniformTable);
+        shader->uniforms = NULL;
+        shader->uniformTable = NULL;
+        return;
+    }
+
+    memset(shader->uniformTable, 0xFF, tableSize * sizeof(int32_t));
+    shader->uniformTableMask = tableSize - 1;
+
+    for (int i = 0; i < count; i++) {
+        ShaderUniform* uniform = &shader->uniforms[shader->uniformCount];
+        memset(uniform, 0, sizeof(ShaderUniform));
+
+        int length = 0;
+        GLenum type = 0;
+        glGetActiveUniform(shader->id, (uint32_t)i, GL2D_MAX_UNIFORM_NAME, &length, &uniform->size, &type, uniform->name);
+
+        // block members have no location and names that filled the buffer are truncated
+        if (length <= 0 || length >= GL2D_MAX_UNIFORM_NAME - 1) {
+            continue;
+        }
+
+        uniform->location = glGetUniformLocation(shader->id, uniform->name);
+
+        if (uniform->location < 0) {
+            continue;
+        }
+
+        // arrays are reported as "name[0]", register them under the plain name
+        if (length > 3 && strcmp(uniform->name + length - 3, "[0]") == 0) {
+            uniform->name[length - 3] = '\0';
+        }
+
+        uniform->type = type;
+        uniform->hash = HashString(uniform->name);
+
+        uint32_t slot = uniform->hash & shader->uniformTableMask;
+
+        while (shader->uniformTable[slot] >= 0) {
+            slot = (slot + 1) & shader->uniformTableMask;
+        }
+
+        shader->uniformTable[slot] = (int32_t)shader->uniformCount++;
+    }
+}
+
+GL2D_API void GL2D_DestroyShader(GL2D_Shader handle) {
+    Shader* shader = GetShader(handle);
+
+    if (shader == NULL) {
+        return;
+    }
+
+    StateForgetProgram(shader->id);
+    glDeleteProgram(shader->id);
+    MemFree(shader->uniforms);
+    MemFree(shader->uniformTable);
+    PoolFree(&shaderPool, handle);
+}
+
+GL2D_API void GL2D_BindShader(GL2D_Shader handle) {
+    Shader* shader = GetShader(handle);
+
+    if (shader != NULL) {
+        StateUseProgram(shader->id);
+    }
+}
+
+GL2D_API GL2D_Uniform GL2D_ShaderGetUniform(GL2D_Shader handle, const char* name) {
+    Shader* shader = GetShader(handle);
+
+    if (shader == NULL || shader->uniformTable == NULL) {
+        return GL2D_INVALID_UNIFORM;
+    }
+
+    uint32_t hash = HashString(name);
+    uint32_t slot = hash & shader->uniformTableMask;
+
+    while (shader->uniformTable[slot] >= 0) {
+        ShaderUniform* uniform = &shader->uniforms[shader->uniformTable[slot]];
+
+        if (uniform->hash == hash && strcmp(uniform->name, name) == 0) {
+            return shader->uniformTable[slot];
+        }
+
+        slot = (slot + 1) & shader->uniformTableMask;
+    }
+
+    return GL2D_INVALID_UNIFORM;
+}
+
+// returns false when the uniform already holds the value and the GL call can be skipped,
+// otherwise the shader is bound so the call lands in the program the shadow belongs to
+static bool ShadowUniform(Shader* shader, GL2D_Uniform uniform, const float* value, uint32_t count) {
+    ShaderUniform* entry = &shader->uniforms[uniform];
+
+    if (entry->shadowed && memcmp(entry->shadow, value, count * sizeof(float)) == 0) {
+        return false;
+    }
+
+    memcpy(entry->shadow, value, count * sizeof(float));
+    entry->shadowed = true;
+    StateUseProgram(shader->id);
+
+    return true;
+}
+
+GL2D_API void GL2D_ShaderSetUniformBool(GL2D_Shader shader, GL2D_Uniform uniform, bool value) {
+    GL2D_ShaderSetUniformInt(shader, uniform, (int)value);
+}
+
+GL2D_API void GL2D_ShaderSetUniformInt(GL2D_Shader handle, GL2D_Uniform uniform, int value) {
+    Shader* shader = PoolGet(&shaderPool, handle);
+
+    if (shader == NULL || uniform < 0 || (uint32_t)uniform >= shader->uniformCount) {
+        return;
+    }
+
+    float shadow;
+    memcpy(&shadow, &value, sizeof(float));
+
+    if (ShadowUniform(shader, uniform, &shadow, 1)) {
+        glUniform1i(shader->uniforms[uniform].location, value);
+    }
+}
+
+GL2D_API void GL2D_ShaderSetUniformFloat(GL2D_Shader handle, GL2D_Uniform uniform, float value) {
+    Shader* shader = PoolGet(&shaderPool, handle);
+
+    if (shader == NULL || uniform < 0 || (uint32_t)uniform >= shader->uniformCount) {
+        return;
+    }
+
+    if (ShadowUniform(shader, uniform, &value, 1)) {
+        glUniform1f(shader->uniforms[uniform].location, value);
+    }
+}
+
+GL2D_API void GL2D_ShaderSetUniformVec2(GL2D_Shader handle, GL2D_Uniform uniform, GL2D_Vector2f value) {
+    Shader* shader = PoolGet(&shaderPool, handle);
+
+    if (shader == NULL || uniform < 0 || (uint32_t)uniform >= shader->uniformCount) {
+        return;
+    }
+
+    float shadow[2] = { value.x, value.y };
+
+    if (ShadowUniform(shader, uniform, shadow, 2)) {
+        glUniform2f(shader->uniforms[uniform].location, value.x, value.y);
+    }
+}
+
+GL2D_API void GL2D_ShaderSetUniformMat4(GL2D_Shader handle, GL2D_Uniform uniform, GL2D_Matrix4f value) {
+    Shader* shader = PoolGet(&shaderPool, handle);
+
+    if (shader == NULL || uniform < 0 || (uint32_t)uniform >= shader->uniformCount) {
+        return;
+    }
+
+    if (ShadowUniform(shader, uniform, &value.data[0][0], 16)) {
+        glUniformMatrix4fv(shader->uniforms[uniform].location, 1, false, &value.data[0][0]);
+    }
+}
+
+GL2D_API void GL2D_ShaderSetUniformAffine(GL2D_Shader shader, GL2D_Uniform uniform, GL2D_Affine2D value) {
+    GL2D_ShaderSetUniformMat4(shader, uniform, GL2D_AffineToMat4(value));
+}
+
+GL2D_API void GL2D_ShaderSetBool(GL2D_Shader shader, const char* name, bool value) {
+    GL2D_ShaderSetUniformBool(shader, GL2D_ShaderGetUniform(shader, name), value);
+}
+
+GL2D_API void GL2D_ShaderSetInt(GL2D_Shader shader, const char* name, int value) {
+    GL2D_ShaderSetUniformInt(shader, GL2D_ShaderGetUniform(shader, name), value);
+}
+
+GL2D_API void GL2D_ShaderSetFloat(GL2D_Shader shader, const char* name, float value) {
+    GL2D_ShaderSetUniformFloat(shader, GL2D_ShaderGetUniform(shader, name), value);
+}
+
+GL2D_API void GL2D_ShaderSetVec2(GL2D_Shader shader, const char* name, GL2D_Vector2f value) {
+    GL2D_ShaderSetUniformVec2(shader, GL2D_ShaderGetUniform(shader, name), value);
+}
+
+GL2D_API void GL2D_ShaderSetMat4(GL2D_Shader shader, const char* name, GL2D_Matrix4f value) {
+    GL2D_ShaderSetUniformMat4(shader, GL2D_ShaderGetUniform(shader, name), value);
+}
+
+GL2D_API void GL2D_ShaderSetAffine(GL2D_Shader shader, const char* name, GL2D_Affine2D value) {
+    GL2D_ShaderSetUniformAffine(shader, GL2D_ShaderGetUniform(shader, name), value);
+}
+
+GL2D_API bool GL2D_ShaderBindUniformBlock(GL2D_Shader handle, const char* blockName, uint32_t binding) {
+    Shader* shader = GetShader(handle);
+
+    if (shader == NULL) {
+        return false;
+    }
+
+    uint32_t index = glGetUniformBlockIndex(shader->id, blockName);
+
+    if (index == GL_INVALID_INDEX) {
+        return false;
+    }
+
+    glUniformBlockBinding(shader->id, index, binding);
+
+    return true;
+}
+
+GL2D_API GL2D_UniformBuffer GL2D_CreateUniformBuffer(uint64_t size, uint32_t binding) {
+    if (!RequireGL("GL2D_CreateUniformBuffer")) {
+        return NULL;
+    }
+
+    GL2D_UniformBuffer ubo = MemAlloc(sizeof(struct GL2D_UniformBuffer));
+
+    if (ubo == NULL) {
+        printf("ERROR: Couldn't allocate ubo");
+        return NULL;
+    }
+
+    memset(ubo, 0, sizeof(struct GL2D_UniformBuffer));
+
+    ubo->binding = binding;
+    ubo->size = size;
+
+    glGenBuffers(1, &ubo->id);
+    StateBindBuffer(GL_UNIFORM_BUFFER, ubo->id);
+    glBufferData(GL_UNIFORM_BUFFER, size, NULL, GL_DYNAMIC_DRAW);
+    glBindBufferBase(GL_UNIFORM_BUFFER, binding, ubo->id);
+
+    return ubo;
+}
+
+GL2D_API void GL2D_DestroyUniformBuffer(GL2D_UniformBuffer ubo) {
+    StateForgetBuffer(ubo->id);
+    glDeleteBuffers(1, &ubo->id);
+    MemFree(ubo);
+}
+
+GL2D_API void GL2D_UpdateUniformBuffer(GL2D_UniformBuffer ubo, const void* data, uint64_t offset, uint64_t size) {
+    if (offset + size > ubo->size) {
+        fprintf(stderr, "ERROR: Uniform buffer update out of range\n");
+        return;
+    }
+
+    StateBindBuffer(GL_UNIFORM_BUFFER, ubo->id);
+    glBufferSubData(GL_UNIFORM_BUFFER, offset, size, data);
+    CountBufferUpload(size);
+}
+
+// Takes ownership of pixels, NULL pixels become a single black texel.
+static GL2D_Texture CreateSoftwareTexture(GL2D_Texture handle, uint8_t* pixels, int width, int height, bool repeat) {
+    static const uint8_t black[4] = { 0, 0, 0, 255 };
+    Texture* texture = PoolGet(&texturePool, handle);
+
+    if (pixels == NULL) {
+        pixels = MemAlloc(sizeof(black));
+
+        if (pixels == NULL) {
+            PoolFree(&texturePool, handle);
+            return GL2D_INVALID_HANDLE;
+        }
+
+        memcpy(pixels, black, sizeof(black));
+        width = height = 1;
+    }
+
+    texture->pixels = pixels;
+    texture->repeat = repeat;
+    texture->size.x = (float)width;
+    texture->size.y = (float)height;
+    texture->ready = true;
+
+    return handle;
+}
+
+static GL2D_Texture CreateTextureFromMemory(const uint8_t* encoded, uint64_t size) {
+    GL2D_Texture handle = PoolAllocate(&texturePool);
+
+    if (handle == GL2D_INVALID_HANDLE) {
+        printf("ERROR: Couldn't allocate texture");
+        return GL2D_INVALID_HANDLE;
+    }
+
+    Texture* texture = PoolGet(&texturePool, handle);
+
+    if (SoftwareActive()) {
+        int width = 0, height = 0, channels = 0;
+        stbi_set_flip_vertically_on_load(1);
+        uint8_t* pixels = encoded != NULL ? stbi_load_from_memory(encoded, (int)size, &width, &height, &channels, 4) : NULL;
+
+        if (pixels == NULL) {
+            printf("Failed to load texture\n");
+        }
+
+        // a failed load samples black like an incomplete GL texture does
+        return CreateSoftwareTexture(handle, pixels, width, height, true);
+    }
+
+    glGenTextures(1, &texture->id);
+    StateBindTextureForUpdate(texture->id); // all upcoming GL_TEXTURE_2D operations now have effect on this texture object
+    // set the texture wrapping parameters
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);	// set texture wrapping to GL_REPEAT (default wrapping method)
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    // set texture filtering parameters
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    // load image, create texture and generate mipmaps
+    int width = 0, height = 0, nrChannels = 0;
+    stbi_set_flip_vertically_on_load(1);
+    unsigned char* data = encoded != NULL ? stbi_load_from_memory(encoded, (int)size, &width, &height, &nrChannels, 0) : NULL;
+    if (data) {
+        CountTextureUpload((uint64_t)width * height * nrChannels);
+
+        if (nrChannels == 3) {
+            // tightly packed 3 byte pixels, rows aren't 4 byte aligned unless the width happens to be
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
+            glGenerateMipmap(GL_TEXTURE_2D);
+        }
+        else if (nrChannels == 4) {
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+            glGenerateMipmap(GL_TEXTURE_2D);
+        }
+        else {
+            printf("Failed to load texture\n");
+        }
+    }
+    else {
+        printf("Failed to load texture\n");
+    }
+    stbi_image_free(data);
+
+    texture->size.x = width;
+    texture->size.y = height;
+    texture->ready = true;
+
+    return handle;
+}
+
+GL2D_API GL2D_Texture GL2D_CreateTextureFromFile(const char* path) {
+    MappedFile mapped;
+
+    if (!MapFile(&mapped, path)) {
+        fprintf(stderr, "ERROR: Couldn't open file %s\n", path);
+    }
+
+    GL2D_Texture texture = CreateTextureFromMemory(mapped.data, mapped.size);
+    UnmapFile(&mapped);
+
+    return texture;
+}
+
+GL2D_API GL2D_Texture GL2D_CreateTextureFromPixels(const uint8_t* pixels, uint32_t width, uint32_t height) {
+    GL2D_Texture handle = PoolAllocate(&texturePool);
+
+    if (handle == GL2D_INVALID_HANDLE) {
+        printf("ERROR: Couldn't allocate texture");
+        return GL2D_INVALID_HANDLE;
+    }
+
+    Texture* texture = PoolGet(&texturePool, handle);
+
+    if (SoftwareActive()) {
+        uint8_t* copy = MemAlloc((uint64_t)width * height * 4);
+
+        if (copy != NULL) {
+            memcpy(copy, pixels, (uint64_t)width * height * 4);
+        }
+
+        return CreateSoftwareTexture(handle, copy, width, height, false);
+    }
+
+    glGenTextures(1, &texture->id);
+    StateBindTextureForUpdate(texture->id);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    CountTextureUpload((uint64_t)width * height * 4);
+
+    texture->size.x = (float)width;
+    texture->size.y = (float)height;
+    texture->ready = true;
+
+    return handle;
+}
+
+static void DecodeTexture(void* data) {
+    TextureLoad* load = data;
+    uint64_t size = 0;
+    char* encoded = ReadEntireFile(load->path, &size);
+    int width = 0, height = 0, channels = 0;
+    uint8_t* pixels = NULL;
+
+    if (encoded != NULL) {
+        stbi_set_flip_vertically_on_load_thread(1);
+        pixels = stbi_load_from_memory((const stbi_uc*)encoded, (int)size, &width, &height, &channels, 4);
+        MemFree(encoded);
+    }
+
+    MutexLock(&textureLoadMutex);
+    load->pixels = pixels;
+    load->width = width;
+    load->height = height;
+    load->state = pixels != NULL ? TEXTURE_LOAD_DECODED : TEXTURE_LOAD_FAILED;
+    MutexUnlock(&textureLoadMutex);
+}
+
+GL2D_API GL2D_Texture GL2D_CreateTextureAsync(const char* path) {
+    static const uint8_t placeholder[4] = { 255, 255, 255, 255 };
+
+    // nothing to overlap with on the software backend, the frame is already spent on the CPU
+    if (SoftwareActive()) {
+        return GL2D_CreateTextureFromFile(path);
+    }
+
+    GL2D_Texture texture = GL2D_CreateTextureFromPixels(placeholder, 1, 1);
+
+    if (texture == GL2D_INVALID_HANDLE) {
+        return GL2D_INVALID_HANDLE;
+    }
+
+    TextureLoad* load = MemAlloc(sizeof(TextureLoad));
+    size_t pathLength = strlen(path);
+
+    if (load == NULL || (load->path = MemAlloc(pathLength + 1)) == NULL) {
+        fprintf(stderr, "ERROR: Couldn't allocate texture load\n");
+        MemFree(load);
+        return texture;
+    }
+
+    memcpy(load->path, path, pathLength + 1);
+    load->texture = texture;
+    load->pixels = NULL;
+    load->width = 0;
+    load->height = 0;
+    load->streamTexture = 0;
+    load->uploadedRows = 0;
+    load->state = TEXTURE_LOAD_QUEUED;
+    load->next = textureLoads;
+
+    if (!textureLoadMutexReady) {
+        MutexInit(&textureLoadMutex);
+        textureLoadMutexReady = true;
+    }
+
+    textureLoads = load;
+    ((Texture*)PoolGet(&texturePool, texture))->ready = false;
+
+    if (!SubmitJob(DecodeTexture, load)) {
+        // no worker available, decode on this thread instead
+        DecodeTexture(load);
+    }
+
+    return texture;
+}
+
+GL2D_API bool GL2D_TextureIsReady(GL2D_Texture handle) {
+    Texture* texture = GetTexture(handle);
+
+    return texture != NULL && texture->ready;
+}
+
+static void FinishTextureLoad(TextureLoad* load) {
+    Texture* texture = PoolGet(&texturePool, load->texture);
+
+    if (texture == NULL) {
+        return;
+    }
+
+    if (load->state == TEXTURE_LOAD_FAILED) {
+        fprintf(stderr, "ERROR: Failed to load texture %s\n", load->path);
+    }
+    else {
+        // the placeholder is swapped for the streamed texture, the handle stays the same
+        StateForgetTexture(texture->id);
+        glDeleteTextures(1, &texture->id);
+        texture->id = load->streamTexture;
+        load->streamTexture = 0;
+
+        StateBindTextureForUpdate(texture->id);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glGenerateMipmap(GL_TEXTURE_2D);
+        texture->size.x = (float)load->width;
+        texture->size.y = (float)load->height;
+    }
+
+    texture->ready = true;
+}
+
+static void FreeTextureLoad(TextureLoad* load) {
+    // still set when the texture was destroyed mid-stream
+    if (load->streamTexture != 0) {
+        StateForgetTexture(load->streamTexture);
+        glDeleteTextures(1, &load->streamTexture);
+    }
+
+    stbi_image_free(load->pixels);
+    MemFree(load->path);
+    MemFree(load);
+}
+
+// Streams decoded images through a pixel buffer object, at most uploadBudget bytes per frame.
+// An image bigger than the budget is split over several frames by rows.
+static void ProcessTextureUploads(GL2D_Renderer renderer) {
+    if (textureLoads == NULL) {
+        return;
+    }
+
+    uint64_t budget = renderer->uploadBudget;
+    TextureLoad** link = &textureLoads;
+
+    while (*link != NULL) {
+        TextureLoad* load = *link;
+
+        MutexLock(&textureLoadMutex);
+        uint32_t state = load->state;
+        MutexUnlock(&textureLoadMutex);
+
+        if (state == TEXTURE_LOAD_QUEUED) {
+            link = &load->next;
+            continue;
+        }
+
+        Texture* texture = PoolGet(&texturePool, load->texture);
+
+        if (state == TEXTURE_LOAD_DECODED && texture != NULL) {
+            uint64_t rowBytes = (uint64_t)load->width * 4;
+            uint32_t rows = (uint32_t)(budget / rowBytes);
+            uint32_t remaining = (uint32_t)load->height - load->uploadedRows;
+
+            if (rows == 0) {
+                // always make progress on the first image of the frame
+                if (budget != renderer->uploadBudget) {
+                    break;
+                }
+
+                rows = 1;
+            }
+
+            rows = rows < remaining ? rows : remaining;
+
+            if (renderer->uploadBuffer == 0) {
+                glGenBuffers(1, &renderer->uploadBuffer);
+            }
+
+            if (load->streamTexture == 0) {
+                glGenTextures(1, &load->streamTexture);
+                StateBindTextureForUpdate(load->streamTexture);
+                glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, load->width, load->height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+            }
+
+            StateBindTextureForUpdate(load->streamTexture);
+
+            uint64_t bytes = rows * rowBytes;
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, renderer->uploadBuffer);
+            glBufferData(GL_PIXEL_UNPACK_BUFFER, bytes, NULL, GL_STREAM_DRAW);
+            void* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+
+            if (mapped == NULL) {
+                // the same rows are retried next frame
+                glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+                fprintf(stderr, "ERROR: Couldn't map texture upload buffer\n");
+                break;
+            }
+
+            memcpy(mapped, load->pixels + load->uploadedRows * rowBytes, bytes);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, load->uploadedRows, load->width, rows, GL_RGBA, GL_UNSIGNED_BYTE, (void*)0);
+            CountTextureUpload(bytes);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+            load->uploadedRows += rows;
+            budget = budget > bytes ? budget - bytes : 0;
+
+            if (load->uploadedRows < (uint32_t)load->height) {
+                break;
+            }
+        }
+
+        FinishTextureLoad(load);
+        *link = load->next;
+        FreeTextureLoad(load);
+
+        if (budget == 0) {
+            break;
+        }
+    }
+}
+
+// only called once the workers are stopped
+static void FreeTextureLoads(void) {
+    while (textureLoads != NULL) {
+        TextureLoad* load = textureLoads;
+        textureLoads = load->next;
+        FreeTextureLoad(load);
+    }
+}
+
+GL2D_API void GL2D_DestroyTexture(GL2D_Texture handle) {
+    Texture* texture = GetTexture(handle);
+
+    if (texture == NULL) {
+        return;
+    }
+
+    if (texture->pixels != NULL) {
+        MemFree(texture->pixels);
+        PoolFree(&texturePool, handle);
+        return;
+    }
+
+    StateForgetTexture(texture->id);
+    glDeleteTextures(1, &texture->id);
+    PoolFree(&texturePool, handle);
+}
+
+GL2D_API void GL2D_BindTexture(GL2D_Texture handle) {
+    Texture* texture = GetTexture(handle);
+
+    if (texture != NULL && texture->pixels == NULL) {
+        StateBindTexture(texture->slot, texture->id);
+    }
+}
+
+// Cooked textures are a header followed by every mip level as tightly packed RGBA8, smallest last.
+// The file is written in the machine's byte order, cook on the platform that loads it.
+#define COOKED_TEXTURE_MAGIC 0x4B443247
+#define COOKED_TEXTURE_VERSION 1
+#define COOKED_TEXTURE_MAX_LEVELS 16
+
+typedef struct CookedLevel {
+    uint32_t width;
+    uint32_t height;
+    uint64_t offset;
+    uint64_t size;
+} CookedLevel;
+
+typedef struct CookedTextureHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t contentHash;
+    uint32_t width;
+    uint32_t height;
+    uint32_t levelCount;
+    uint32_t reserved;
+    CookedLevel levels[COOKED_TEXTURE_MAX_LEVELS];
+} CookedTextureHeader;
+
+static bool ReadCookedHeader(const MappedFile* mapped, CookedTextureHeader* header) {
+    if (mapped->size < sizeof(CookedTextureHeader)) {
+        return false;
+    }
+
+    memcpy(header, mapped->data, sizeof(CookedTextureHeader));
+
+    if (header->magic != COOKED_TEXTURE_MAGIC || header->version != COOKED_TEXTURE_VERSION) {
+        return false;
+    }
+
+    if (header->levelCount == 0 || header->levelCount > COOKED_TEXTURE_MAX_LEVELS) {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < header->levelCount; i++) {
+        const CookedLevel* level = &header->levels[i];
+
+        if (level->offset > mapped->size || level->size > mapped->size - level->offset || level->size != (uint64_t)level->width * level->height * 4) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// 2x2 box filter, an odd last row or column is folded into its neighbour
+static void DownsampleLevel(const uint8_t* source, uint32_t width, uint32_t height, uint8_t* destination, uint32_t levelWidth, uint32_t levelHeight) {
+    for (uint32_t y = 0; y < levelHeight; y++) {
+        uint32_t y0 = y * 2 < height ? y * 2 : height - 1;
+        uint32_t y1 = y * 2 + 1 < height ? y * 2 + 1 : height - 1;
+
+        for (uint32_t x = 0; x < levelWidth; x++) {
+            uint32_t x0 = x * 2 < width ? x * 2 : width - 1;
+            uint32_t x1 = x * 2 + 1 < width ? x * 2 + 1 : width - 1;
+
+            for (uint32_t c = 0; c < 4; c++) {
+                uint32_t sum = source[((uint64_t)y0 * width + x0) * 4 + c] + source[((uint64_t)y0 * width + x1) * 4 + c] +
+                               source[((uint64_t)y1 * width + x0) * 4 + c] + source[((uint64_t)y1 * width + x1) * 4 + c];
+
+                destination[((uint64_t)y * levelWidth + x) * 4 + c] = (uint8_t)((sum + 2) / 4);
+            }
+        }
+    }
+}
+
+GL2D_API bool GL2D_CookTexture(const char* sourcePath, const char* cookedPath) {
+    uint64_t sourceSize = 0;
+    char* source = ReadEntireFile(sourcePath, &sourceSize);
+
+    if (source == NULL) {
+        return false;
+    }
+
+    int width = 0, height = 0, channels = 0;
+    stbi_set_flip_vertically_on_load(1);
+    uint8_t* pixels = stbi_load_from_memory((const stbi_uc*)source, (int)sourceSize, &width, &height, &channels, 4);
+
+    CookedTextureHeader header;
+    memset(&header, 0, sizeof(CookedTextureHeader));
+    header.magic = COOKED_TEXTURE_MAGIC;
+    header.version = COOKED_TEXTURE_VERSION;
+    header.contentHash = HashBytes((const uint8_t*)source, sourceSize);
+    header.width = (uint32_t)width;
+    header.height = (uint32_t)height;
+
+    MemFree(source);
+
+    if (pixels == NULL) {
+        fprintf(stderr, "ERROR: Failed to load texture %s\n", sourcePath);
+        return false;
+    }
+
+    uint64_t offset = sizeof(CookedTextureHeader);
+    uint32_t levelWidth = header.width;
+    uint32_t levelHeight = header.height;
+
+    while (header.levelCount < COOKED_TEXTURE_MAX_LEVELS) {
+        CookedLevel* level = &header.levels[header.levelCount++];
+        level->width = levelWidth;
+        level->height = levelHeight;
+        level->offset = offset;
+        level->size = (uint64_t)levelWidth * levelHeight * 4;
+        offset += level->size;
+
+        if (levelWidth == 1 && levelHeight == 1) {
+            break;
+        }
+
+        levelWidth = levelWidth > 1 ? levelWidth / 2 : 1;
+        levelHeight = levelHeight > 1 ? levelHeight / 2 : 1;
+    }
+
+    uint8_t* levels = MemAlloc(offset - sizeof(CookedTextureHeader));
+
+    if (levels == NULL) {
+        fprintf(stderr, "ERROR: Couldn't allocate mip chain for %s\n", sourcePath);
+        stbi_image_free(pixels);
+        return false;
+    }
+
+    memcpy(levels, pixels, header.levels[0].size);
+    stbi_image_free(pixels);
+
+    for (uint32_t i = 1; i < header.levelCount; i++) {
+        const CookedLevel* previous = &header.levels[i - 1];
+        const CookedLevel* level = &header.levels[i];
+
+        DownsampleLevel(levels + previous->offset - sizeof(CookedTextureHeader), previous->width, previous->height,
+                        levels + level->offset - sizeof(CookedTextureHeader), level->width, level->height);
+    }
+
+    FILE* file = fopen(cookedPath, "wb");
+
+    if (file == NULL) {
+        fprintf(stderr, "ERROR: Couldn't open file %s: %s\n", cookedPath, strerror(errno));
+        MemFree(levels);
+        return false;
+    }
+
+    bool written = fwrite(&header, sizeof(CookedTextureHeader), 1, file) == 1 &&
+                   fwrite(levels, offset - sizeof(CookedTextureHeader), 1, file) == 1;
+
+    fclose(file);
+    MemFree(levels);
+
+    if (!written) {
+        fprintf(stderr, "ERROR: Couldn't write file %s\n", cookedPath);
+        remove(cookedPath);
+    }
+
+    return written;
+}
+
+GL2D_API bool GL2D_CookedTextureIsStale(const char* sourcePath, const char* cookedPath) {
+    MappedFile cooked, source;
+    CookedTextureHeader header;
+
+    if (!MapFile(&cooked, cookedPath)) {
+        return true;
+    }
+
+    bool valid = ReadCookedHeader(&cooked, &header);
+    UnmapFile(&cooked);
+
+    if (!valid) {
+        return true;
+    }
+
+    // without a source there's nothing newer to compare against
+    if (!MapFile(&source, sourcePath)) {
+        return false;
+    }
+
+    bool stale = HashBytes(source.data, source.size) != header.contentHash;
+    UnmapFile(&source);
+
+    return stale;
+}
+
+GL2D_API GL2D_Texture GL2D_CreateTextureFromCooked(const char* cookedPath) {
+    if (!RequireGL("GL2D_CreateTextureFromCooked")) {
+        return GL2D_INVALID_HANDLE;
+    }
+
+    MappedFile mapped;
+    CookedTextureHeader header;
+
+    if (!MapFile(&mapped, cookedPath)) {
+        fprintf(stderr, "ERROR: Couldn't open file %s\n", cookedPath);
+        return GL2D_INVALID_HANDLE;
+    }
+
+    if (!ReadCookedHeader(&mapped, &header)) {
+        fprintf(stderr, "ERROR: %s is not a valid cooked texture\n", cookedPath);
+        UnmapFile(&mapped);
+        return GL2D_INVALID_HANDLE;
+    }
+
+    GL2D_Texture handle = PoolAllocate(&texturePool);
+
+    if (handle == GL2D_INVALID_HANDLE) {
+        printf("ERROR: Couldn't allocate texture");
+        UnmapFile(&mapped);
+        return GL2D_INVALID_HANDLE;
+    }
+
+    Texture* texture = PoolGet(&texturePool, handle);
+
+    glGenTextures(1, &texture->id);
+    StateBindTextureForUpdate(texture->id);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, header.levelCount > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, header.levelCount - 1);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    for (uint32_t i = 0; i < header.levelCount; i++) {
+        const CookedLevel* level = &header.levels[i];
+        glTexImage2D(GL_TEXTURE_2D, i, GL_RGBA8, level->width, level->height, 0, GL_RGBA, GL_UNSIGNED_BYTE, mapped.data + level->offset);
+        CountTextureUpload((uint64_t)level->width * level->height * 4);
+    }
+
+    UnmapFile(&mapped);
+
+    texture->size.x = (float)header.width;
+    texture->size.y = (float)header.height;
+    texture->ready = true;
+
+    return handle;
+}
+
+// Loads the cooked copy of a texture, cooking it first when it's missing or older than its source.
+GL2D_API GL2D_Texture GL2D_CreateTextureCached(const char* sourcePath, const char* cookedPath) {
+    if (GL2D_CookedTextureIsStale(sourcePath, cookedPath) && !GL2D_CookTexture(sourcePath, cookedPath)) {
+        return GL2D_CreateTextureFromFile(sourcePath);
+    }
+
+    return GL2D_CreateTextureFromCooked(cookedPath);
+}
+
+typedef struct SkylineNode {
+    uint32_t x;
+    uint32_t y;
+    uint32_t width;
+} SkylineNode;
+
+typedef struct AtlasPage {
+    GL2D_Texture texture;
+    uint8_t* pixels;
+    SkylineNode* skyline;
+    uint32_t skylineCount;
+    uint64_t allocatedArea;
+    uint64_t removedArea;
+} AtlasPage;
+
+typedef struct AtlasRegion {
+    uint32_t page;
+    uint32_t x;
+    uint32_t y;
+    uint32_t width;
+    uint32_t height;
+    uint16_t generation;
+    bool live;
+} AtlasRegion;
+
+// Every page keeps a CPU copy of its pixels so it can be repacked without reading the texture back.
+struct GL2D_TextureAtlas {
+    uint32_t pageWidth;
+    uint32_t pageHeight;
+    uint32_t padding;
+    float repackThreshold;
+    AtlasPage* pages;
+    uint32_t pageCount;
+    AtlasRegion* regions;
+    uint32_t regionCount;
+    uint32_t regionCapacity;
+    uint32_t* freeRegions;
+    uint32_t freeRegionCount;
+};
+
+static void SkylineReset(AtlasPage* page, uint32_t pageWidth) {
+    page->skyline[0] = (SkylineNode) { 0, 0, pageWidth };
+    page->skylineCount = 1;
+}
+
+static bool SkylineFit(const AtlasPage* page, uint32_t index, uint32_t width, uint32_t height, uint32_t pageWidth, uint32_t pageHeight, uint32_t* y) {
+    if (page->skyline[index].x + width > pageWidth) {
+        return false;
+    }
+
+    uint32_t top = 0;
+    uint32_t remaining = width;
+
+    // the nodes span the whole page width, so this never runs past the last one
+    for (uint32_t i = index; remaining > 0; i++) {
+        top = page->skyline[i].y > top ? page->skyline[i].y : top;
+
+        if (top + height > pageHeight) {
+            return false;
+        }
+
+        remaining -= page->skyline[i].width < remaining ? page->skyline[i].width : remaining;
+    }
+
+    *y = top;
+
+    return true;
+}
+
+// Bottom-left skyline: the rectangle goes where its top edge ends up lowest, ties go to the narrowest node.
+static bool SkylineInsert(AtlasPage* page, uint32_t width, uint32_t height, uint32_t pageWidth, uint32_t pageHeight, uint32_t* x, uint32_t* y) {
+    uint32_t bestIndex = 0;
+    uint32_t bestTop = UINT32_MAX;
+    uint32_t bestWidth = UINT32_MAX;
+    uint32_t bestY = 0;
+
+    for (uint32_t i = 0; i < page->skylineCount; i++) {
+        uint32_t fitY;
+
+        if (!SkylineFit(page, i, width, height, pageWidth, pageHeight, &fitY)) {
+            continue;
+        }
+
+        if (fitY + height < bestTop || (fitY + height == bestTop && page->skyline[i].width < bestWidth)) {
+            bestIndex = i;
+            bestTop = fitY + height;
+            bestWidth = page->skyline[i].width;
+            bestY = fitY;
+        }
+    }
+
+    if (bestTop == UINT32_MAX) {
+        return false;
+    }
+
+    *x = page->skyline[bestIndex].x;
+    *y = bestY;
+
+    memmove(&page->skyline[bestIndex + 1], &page->skyline[bestIndex], (page->skylineCount - bestIndex) * sizeof(SkylineNode));
+    page->skyline[bestIndex] = (SkylineNode) { *x, bestTop, width };
+    page->skylineCount++;
+
+    // trim the nodes now hidden under the new one
+    for (uint32_t i = bestIndex + 1; i < page->skylineCount;) {
+        uint32_t previousEnd = page->skyline[i - 1].x + page->skyline[i - 1].width;
+
+        if (page->skyline[i].x >= previousEnd) {
+            break;
+        }
+
+        uint32_t shrink = previousEnd - page->skyline[i].x;
+
+        if (page->skyline[i].width > shrink) {
+            page->skyline[i].x += shrink;
+            page->skyline[i].width -= shrink;
+            break;
+        }
+
+        memmove(&page->skyline[i], &page->skyline[i + 1], (page->skylineCount - i - 1) * sizeof(SkylineNode));
+        page->skylineCount--;
+    }
+
+    for (uint32_t i = 0; i + 1 < page->skylineCount;) {
+        if (page->skyline[i].y == page->skyline[i + 1].y) {
+            page->skyline[i].width += page->skyline[i + 1].width;
+            memmove(&page->skyline[i + 1], &page->skyline[i + 2], (page->skylineCount - i - 2) * sizeof(SkylineNode));
+            page->skylineCount--;
+        }
+        else {
+            i++;
+        }
+    }
+
+    return true;
+}
+
+static void AtlasUploadRect(GL2D_TextureAtlas atlas, AtlasPage* page, uint32_t x, uint32_t y, uint32_t width, uint32_t height) {
+    StateBindTextureForUpdate(((Texture*)PoolGet(&texturePool, page->texture))->id);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, atlas->pageWidth);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, page->pixels + ((uint64_t)y * atlas->pageWidth + x) * 4);
+    CountTextureUpload((uint64_t)width * height * 4);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+}
+
+// Copies the image into its cell and repeats the edge texels over the padding, so filtering never
+// pulls in a neighbour.
+static void AtlasWriteCell(GL2D_TextureAtlas atlas, AtlasPage* page, const AtlasRegion* region, const uint8_t* pixels) {
+    uint32_t padding = atlas->padding;
+    uint32_t cellWidth = region->width + padding * 2;
+    uint32_t cellHeight = region->height + padding * 2;
+
+    for (uint32_t row = 0; row < cellHeight; row++) {
+        uint32_t sourceRow = row < padding ? 0 : row - padding;
+        sourceRow = sourceRow < region->height ? sourceRow : region->height - 1;
+
+        const uint32_t* source = (const uint32_t*)pixels + (uint64_t)sourceRow * region->width;
+        uint32_t* destination = (uint32_t*)page->pixels + (uint64_t)(region->y + row) * atlas->pageWidth + region->x;
+
+        for (uint32_t column = 0; column < padding; column++) {
+            destination[column] = source[0];
+            destination[cellWidth - 1 - column] = source[region->width - 1];
+        }
+
+        memcpy(destination + padding, source, region->width * 4);
+    }
+}
+
+static bool AtlasAddPage(GL2D_TextureAtlas atlas) {
+    AtlasPage* pages = MemRealloc(atlas->pages, (atlas->pageCount + 1) * sizeof(AtlasPage));
+
+    if (pages == NULL) {
+        return false;
+    }
+
+    atlas->pages = pages;
+
+    AtlasPage* page = &atlas->pages[atlas->pageCount];
+    memset(page, 0, sizeof(AtlasPage));
+
+    page->pixels = MemCalloc((uint64_t)atlas->pageWidth * atlas->pageHeight, 4);
+    page->skyline = MemAlloc((atlas->pageWidth + 1) * sizeof(SkylineNode));
+
+    if (page->pixels == NULL || page->skyline == NULL) {
+        MemFree(page->pixels);
+        MemFree(page->skyline);
+        return false;
+    }
+
+    page->texture = GL2D_CreateTextureFromPixels(page->pixels, atlas->pageWidth, atlas->pageHeight);
+
+    if (page->texture == GL2D_INVALID_HANDLE) {
+        MemFree(page->pixels);
+        MemFree(page->skyline);
+        return false;
+    }
+
+    SkylineReset(page, atlas->pageWidth);
+    atlas->pageCount++;
+
+    return true;
+}
+
+typedef struct AtlasPackItem {
+    GL2D_AtlasRegion region;
+    uint32_t width;
+    uint32_t height;
+} AtlasPackItem;
+
+static int CompareAtlasPackItems(const void* a, const void* b) {
+    const AtlasPackItem* item1 = a;
+    const AtlasPackItem* item2 = b;
+
+    if (item1->height != item2->height) {
+        return item1->height < item2->height ? 1 : -1;
+    }
+
+    if (item1->width != item2->width) {
+        return item1->width < item2->width ? 1 : -1;
+    }
+
+    return item1->region < item2->region ? -1 : 1;
+}
+
+// Packs the live regions of one page again from scratch, tallest first. The old layout is kept
+// if they somehow don't fit anymore.
+static bool AtlasRepackPage(GL2D_TextureAtlas atlas, uint32_t pageIndex) {
+    AtlasPage* page = &atlas->pages[pageIndex];
+    uint32_t padding = atlas->padding;
+    uint32_t itemCount = 0;
+
+    for (uint32_t i = 0; i < atlas->regionCount; i++) {
+        if (atlas->regions[i].live && atlas->regions[i].page == pageIndex) {
+            itemCount++;
+        }
+    }
+
+    AtlasPackItem* items = MemAlloc((itemCount + 1) * sizeof(AtlasPackItem));
+    uint32_t* positions = MemAlloc((itemCount + 1) * 2 * sizeof(uint32_t));
+    SkylineNode* skyline = MemAlloc((atlas->pageWidth + 1) * sizeof(SkylineNode));
+    uint8_t* pixels = MemCalloc((uint64_t)atlas->pageWidth * atlas->pageHeight, 4);
+
+    if (items == NULL || positions == NULL || skyline == NULL || pixels == NULL) {
+        MemFree(items);
+        MemFree(positions);
+        MemFree(skyline);
+        MemFree(pixels);
+        return false;
+    }
+
+    itemCount = 0;
+
+    for (uint32_t i = 0; i < atlas->regionCount; i++) {
+        const AtlasRegion* region = &atlas->regions[i];
+
+        if (region->live && region->page == pageIndex) {
+            items[itemCount++] = (AtlasPackItem) { i + 1, region->width + padding * 2, region->height + padding * 2 };
+        }
+    }
+
+    qsort(items, itemCount, sizeof(AtlasPackItem), CompareAtlasPackItems);
+
+    AtlasPage packed = { .skyline = skyline };
+    SkylineReset(&packed, atlas->pageWidth);
+
+    for (uint32_t i = 0; i < itemCount; i++) {
+        if (!SkylineInsert(&packed, items[i].width, items[i].height, atlas->pageWidth, atlas->pageHeight, &positions[i * 2], &positions[i * 2 + 1])) {
+            MemFree(items);
+            MemFree(positions);
+            MemFree(skyline);
+            MemFree(pixels);
+            return false;
+        }
+    }
+
+    // queued quads still point at the old layout
+    if (currentRenderer != NULL && currentRenderer->batchActive) {
+        FlushBatch(currentRenderer);
+    }
+
+    uint64_t allocatedArea = 0;
+
+    for (uint32_t i = 0; i < itemCount; i++) {
+        AtlasRegion* region = &atlas->regions[items[i].region - 1];
+
+        for (uint32_t row = 0; row < items[i].height; row++) {
+            memcpy(pixels + ((uint64_t)(positions[i * 2 + 1] + row) * atlas->pageWidth + positions[i * 2]) * 4,
+                   page->pixels + ((uint64_t)(region->y + row) * atlas->pageWidth + region->x) * 4,
+                   items[i].width * 4);
+        }
+
+        region->x = positions[i * 2];
+        region->y = positions[i * 2 + 1];
+        allocatedArea += (uint64_t)items[i].width * items[i].height;
+    }
+
+    MemFree(page->pixels);
+    MemFree(page->skyline);
+    page->pixels = pixels;
+    page->skyline = skyline;
+    page->skylineCount = packed.skylineCount;
+    page->allocatedArea = allocatedArea;
+    page->removedArea = 0;
+
+    AtlasUploadRect(atlas, page, 0, 0, atlas->pageWidth, atlas->pageHeight);
+
+    MemFree(items);
+    MemFree(positions);
+
+    return true;
+}
+
+static float AtlasPageFragmentation(const AtlasPage* page) {
+    return page->allocatedArea == 0 ? 0 : (float)page->removedArea / (float)page->allocatedArea;
+}
+
+GL2D_API GL2D_TextureAtlas GL2D_CreateTextureAtlas(uint32_t pageWidth, uint32_t pageHeight, uint32_t padding) {
+    if (!RequireGL("GL2D_CreateTextureAtlas")) {
+        return NULL;
+    }
+
+    GL2D_TextureAtlas atlas = MemAlloc(sizeof(struct GL2D_TextureAtlas));
+
+    if (atlas == NULL) {
+        fprintf(stderr, "ERROR: Couldn't allocate texture atlas\n");
+        return NULL;
+    }
+
+    memset(atlas, 0, sizeof(struct GL2D_TextureAtlas));
+
+    atlas->pageWidth = pageWidth;
+    atlas->pageHeight = pageHeight;
+    atlas->padding = padding;
+    atlas->repackThreshold = 0.25f;
+
+    return atlas;
+}
+
+GL2D_API void GL2D_DestroyTextureAtlas(GL2D_TextureAtlas atlas) {
+    for (uint32_t i = 0; i < atlas->pageCount; i++) {
+        GL2D_DestroyTexture(atlas->pages[i].texture);
+        MemFree(atlas->pages[i].pixels);
+        MemFree(atlas->pages[i].skyline);
+    }
+
+    MemFree(atlas->pages);
+    MemFree(atlas->regions);
+    MemFree(atlas->freeRegions);
+    MemFree(atlas);
+}
+
+GL2D_API GL2D_AtlasRegion GL2D_AtlasAddPixels(GL2D_TextureAtlas atlas, const uint8_t* pixels, uint32_t width, uint32_t height) {
+    uint32_t cellWidth = width + atlas->padding * 2;
+    uint32_t cellHeight = height + atlas->padding * 2;
+
+    if (width == 0 || height == 0 || cellWidth > atlas->pageWidth || cellHeight > atlas->pageHeight) {
+        fprintf(stderr, "ERROR: Image of %ux%u doesn't fit in a %ux%u atlas page\n", width, height, atlas->pageWidth, atlas->pageHeight);
+        return GL2D_INVALID_ATLAS_REGION;
+    }
+
+    if (atlas->freeRegionCount == 0 && atlas->regionCount == atlas->regionCapacity) {
+        uint32_t capacity = atlas->regionCapacity == 0 ? 64 : atlas->regionCapacity * 2;
+
+        if (capacity > HANDLE_INDEX_MASK + 1) {
+            fprintf(stderr, "ERROR: Too many atlas regions\n");
+            return GL2D_INVALID_ATLAS_REGION;
+        }
+
+        AtlasRegion* regions = MemRealloc(atlas->regions, capacity * sizeof(AtlasRegion));
+
+        if (regions == NULL) {
+            fprintf(stderr, "ERROR: Couldn't allocate atlas regions\n");
+            return GL2D_INVALID_ATLAS_REGION;
+        }
+
+        atlas->regions = regions;
+
+        uint32_t* freeRegions = MemRealloc(atlas->freeRegions, capacity * sizeof(uint32_t));
+
+        if (freeRegions == NULL) {
+            fprintf(stderr, "ERROR: Couldn't allocate atlas regions\n");
+            return GL2D_INVALID_ATLAS_REGION;
+        }
+
+        atlas->freeRegions = freeRegions;
+        atlas->regionCapacity = capacity;
+    }
+
+    uint32_t pageIndex = 0;
+    uint32_t x = 0, y = 0;
+    bool placed = false;
+
+    for (; pageIndex < atlas->pageCount && !placed; pageIndex++) {
+        placed = SkylineInsert(&atlas->pages[pageIndex], cellWidth, cellHeight, atlas->pageWidth, atlas->pageHeight, &x, &y);
+    }
+
+    // before growing, win back the space of removed images on pages that have lost enough of it
+    for (pageIndex = placed ? pageIndex : 0; pageIndex < atlas->pageCount && !placed; pageIndex++) {
+        if (AtlasPageFragmentation(&atlas->pages[pageIndex]) >= atlas->repackThreshold && AtlasRepackPage(atlas, pageIndex)) {
+            placed = SkylineInsert(&atlas->pages[pageIndex], cellWidth, cellHeight, atlas->pageWidth, atlas->pageHeight, &x, &y);
+        }
+    }
+
+    if (!placed) {
+        if (!AtlasAddPage(atlas)) {
+            fprintf(stderr, "ERROR: Couldn't allocate atlas page\n");
+            return GL2D_INVALID_ATLAS_REGION;
+        }
+
+        pageIndex = atlas->pageCount;
+        placed = SkylineInsert(&atlas->pages[pageIndex - 1], cellWidth, cellHeight, atlas->pageWidth, atlas->pageHeight, &x, &y);
+    }
+
+    pageIndex--;
+
+    uint32_t index;
+
+    if (atlas->freeRegionCount > 0) {
+        index = atlas->freeRegions[--atlas->freeRegionCount];
+    }
+    else {
+        index = atlas->regionCount++;
+        atlas->regions[index].generation = 1;
+    }
+
+    AtlasRegion* region = &atlas->regions[index];
+    AtlasPage* page = &atlas->pages[pageIndex];
+
+    region->page = pageIndex;
+    region->x = x;
+    region->y = y;
+    region->width = width;
+    region->height = height;
+    region->live = true;
+
+    page->allocatedArea += (uint64_t)cellWidth * cellHeight;
+
+    AtlasWriteCell(atlas, page, region, pixels);
+    AtlasUploadRect(atlas, page, x, y, cellWidth, cellHeight);
+
+    return ((uint32_t)region->generation << HANDLE_INDEX_BITS) | index;
+}
+
+GL2D_API GL2D_AtlasRegion GL2D_AtlasAddFile(GL2D_TextureAtlas atlas, const char* path) {
+    MappedFile mapped;
+
+    if (!MapFile(&mapped, path)) {
+        fprintf(stderr, "ERROR: Couldn't open file %s\n", path);
+        return GL2D_INVALID_ATLAS_REGION;
+    }
+
+    int width = 0, height = 0, channels = 0;
+    stbi_set_flip_vertically_on_load(1);
+    uint8_t* pixels = stbi_load_from_memory(mapped.data, (int)mapped.size, &width, &height, &channels, 4);
+    UnmapFile(&mapped);
+
+    if (pixels == NULL) {
+        fprintf(stderr, "ERROR: Failed to load texture %s\n", path);
+        return GL2D_INVALID_ATLAS_REGION;
+    }
+
+    GL2D_AtlasRegion region = GL2D_AtlasAddPixels(atlas, pixels, width, height);
+    stbi_image_free(pixels);
+
+    return region;
+}
+
+// Region ids are laid out like resource handles, so an id kept past GL2D_AtlasRemove stops
+// resolving instead of finding the next image added to its slot.
+static AtlasRegion* GetAtlasRegion(GL2D_TextureAtlas atlas, GL2D_AtlasRegion region) {
+    uint32_t index = region & HANDLE_INDEX_MASK;
+
+    if (index >= atlas->regionCount || !atlas->regions[index].live || atlas->regions[index].generation != region >> HANDLE_INDEX_BITS) {
+        return NULL;
+    }
+
+    return &atlas->regions[index];
+}
+
+GL2D_API void GL2D_AtlasRemove(GL2D_TextureAtlas atlas, GL2D_AtlasRegion region) {
+    AtlasRegion* removed = GetAtlasRegion(atlas, region);
+
+    if (removed == NULL) {
+        return;
+    }
+
+    removed->live = false;
+    removed->generation = NextGeneration(removed->generation);
+    atlas->pages[removed->page].removedArea += (uint64_t)(removed->width + atlas->padding * 2) * (removed->height + atlas->padding * 2);
+    atlas->freeRegions[atlas->freeRegionCount++] = region & HANDLE_INDEX_MASK;
+}
+
+GL2D_API GL2D_AtlasSprite GL2D_AtlasGetSprite(GL2D_TextureAtlas atlas, GL2D_AtlasRegion region) {
+    GL2D_AtlasSprite sprite = { 0 };
+    const AtlasRegion* found = GetAtlasRegion(atlas, region);
+
+    if (found == NULL) {
+        return sprite;
+    }
+
+    sprite.texture = atlas->pages[found->page].texture;
+    sprite.uv.x = (float)(found->x + atlas->padding) / atlas->pageWidth;
+    sprite.uv.y = (float)(found->y + atlas->padding) / atlas->pageHeight;
+    sprite.uv.width = (float)found->width / atlas->pageWidth;
+    sprite.uv.height = (float)found->height / atlas->pageHeight;
+    sprite.size.x = (float)found->width;
+    sprite.size.y = (float)found->height;
+
+    return sprite;
+}
+
+GL2D_API uint32_t GL2D_AtlasGetPageCount(GL2D_TextureAtlas atlas) {
+    return atlas->pageCount;
+}
+
+GL2D_API float GL2D_AtlasGetFragmentation(GL2D_TextureAtlas atlas, uint32_t page) {
+    return page < atlas->pageCount ? AtlasPageFragmentation(&atlas->pages[page]) : 0;
+}
+
+GL2D_API void GL2D_AtlasSetRepackThreshold(GL2D_TextureAtlas atlas, float fragmentation) {
+    atlas->repackThreshold = fragmentation;
+}
+
+GL2D_API void GL2D_AtlasRepack(GL2D_TextureAtlas atlas) {
+    for (uint32_t i = 0; i < atlas->pageCount; i++) {
+        if (atlas->pages[i].removedArea > 0) {
+            AtlasRepackPage(atlas, i);
+        }
+    }
+}
+
+// A pack is a header, a directory sorted by path hash, the path strings and then the file data.
+// Like the cooked textures it's written in the machine's byte order.
+#define ASSET_PACK_MAGIC 0x50443247
+#define ASSET_PACK_VERSION 1
+#define ASSET_PACK_ALIGNMENT 16
+#define ASSET_PATH_MAX 512
+
+typedef struct AssetPackHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t reserved;
+} AssetPackHeader;
+
+typedef struct AssetPackEntry {
+    uint64_t hash;
+    uint64_t offset;
+    uint64_t size;
+    uint32_t nameOffset;
+    uint32_t nameLength;
+} AssetPackEntry;
+
+typedef struct AssetPack {
+    MappedFile mapped;
+    const AssetPackEntry* entries;
+    uint32_t entryCount;
+} AssetPack;
+
+struct GL2D_AssetFS {
+    AssetPack* packs;
+    uint32_t packCount;
+    char root[ASSET_PATH_MAX];
+};
+
+// Paths are looked up with forward slashes and without a leading "./".
+static bool NormalizeAssetPath(const char* path, char* normalized, size_t size) {
+    while (path[0] == '.' && (path[1] == '/' || path[1] == '\\')) {
+        path += 2;
+    }
+
+    size_t length = strlen(path);
+
+    if (length >= size) {
+        return false;
+    }
+
+    for (size_t i = 0; i <= length; i++) {
+        normalized[i] = path[i] == '\\' ? '/' : path[i];
+    }
+
+    return true;
+}
+
+static void JoinAssetPath(char* path, size_t size, const char* root, const char* name) {
+    if (root != NULL && root[0] != '\0') {
+        snprintf(path, size, "%s/%s", root, name);
+    }
+    else {
+        snprintf(path, size, "%s", name);
+    }
+}
+
+static const AssetPackEntry* FindPackEntry(const AssetPack* pack, const char* path, uint64_t hash) {
+    size_t length = strlen(path);
+    uint32_t low = 0, high = pack->entryCount;
+
+    while (low < high) {
+        uint32_t middle = low + (high - low) / 2;
+
+        if (pack->entries[middle].hash < hash) {
+            low = middle + 1;
+        }
+        else {
+            high = middle;
+        }
+    }
+
+    for (; low < pack->entryCount && pack->entries[low].hash == hash; low++) {
+        const AssetPackEntry* entry = &pack->entries[low];
+
+        if (entry->nameLength == length && memcmp(pack->mapped.data + entry->nameOffset, path, length) == 0) {
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+GL2D_API GL2D_AssetFS GL2D_CreateAssetFS(const char* looseRoot) {
+    GL2D_AssetFS fs = MemAlloc(sizeof(struct GL2D_AssetFS));
+
+    if (fs == NULL) {
+        fprintf(stderr, "ERROR: Couldn't allocate asset file system\n");
+        return NULL;
+    }
+
+    memset(fs, 0, sizeof(struct GL2D_AssetFS));
+
+    if (looseRoot != NULL) {
+        snprintf(fs->root, sizeof(fs->root), "%s", looseRoot);
+    }
+
+    return fs;
+}
+
+GL2D_API void GL2D_DestroyAssetFS(GL2D_AssetFS fs) {
+    for (uint32_t i = 0; i < fs->packCount; i++) {
+        UnmapFile(&fs->packs[i].mapped);
+    }
+
+    MemFree(fs->packs);
+    MemFree(fs);
+}
+
+GL2D_API bool GL2D_AssetFSMount(GL2D_AssetFS fs, const char* packPath) {
+    AssetPack pack;
+    memset(&pack, 0, sizeof(AssetPack));
+
+    if (!MapFile(&pack.mapped, packPath)) {
+        fprintf(stderr, "ERROR: Couldn't open file %s\n", packPath);
+        return false;
+    }
+
+    const MappedFile* mapped = &pack.mapped;
+    AssetPackHeader header;
+    bool valid = mapped->size >= sizeof(AssetPackHeader);
+
+    if (valid) {
+        memcpy(&header, mapped->data, sizeof(AssetPackHeader));
+        valid = header.magic == ASSET_PACK_MAGIC && header.version == ASSET_PACK_VERSION &&
+                header.entryCount <= (mapped->size - sizeof(AssetPackHeader)) / sizeof(AssetPackEntry);
+    }
+
+    if (valid) {
+        pack.entries = (const AssetPackEntry*)(mapped->data + sizeof(AssetPackHeader));
+        pack.entryCount = header.entryCount;
+
+        for (uint32_t i = 0; i < pack.entryCount && valid; i++) {
+            const AssetPackEntry* entry = &pack.entries[i];
+
+            valid = entry->offset <= mapped->size && entry->size <= mapped->size - entry->offset &&
+                    entry->nameOffset <= mapped->size && entry->nameLength <= mapped->size - entry->nameOffset &&
+                    (i == 0 || pack.entries[i - 1].hash <= entry->hash);
+        }
+    }
+
+    if (!valid) {
+        fprintf(stderr, "ERROR: %s is not a valid asset pack\n", packPath);
+        UnmapFile(&pack.mapped);
+        return false;
+    }
+
+    AssetPack* packs = MemRealloc(fs->packs, (fs->packCount + 1) * sizeof(AssetPack));
+
+    if (packs == NULL) {
+        fprintf(stderr, "ERROR: Couldn't allocate asset pack\n");
+        UnmapFile(&pack.mapped);
+        return false;
+    }
+
+    fs->packs = packs;
+    fs->packs[fs->packCount++] = pack;
+
+    return true;
+}
+
+// Packs are searched newest first, loose files under the root are the fallback.
+// A pack view points into the mapping and costs nothing to close.
+GL2D_API bool GL2D_AssetFSOpen(GL2D_AssetFS fs, const char* path, GL2D_AssetView* view) {
+    char normalized[ASSET_PATH_MAX];
+
+    memset(view, 0, sizeof(GL2D_AssetView));
+
+    if (!NormalizeAssetPath(path, normalized, sizeof(normalized))) {
+        return false;
+    }
+
+    uint64_t hash = HashBytes(normalized, strlen(normalized));
+
+    for (uint32_t i = fs->packCount; i > 0; i--) {
+        const AssetPack* pack = &fs->packs[i - 1];
+        const AssetPackEntry* entry = FindPackEntry(pack, normalized, hash);
+
+        if (entry != NULL) {
+            view->data = pack->mapped.data + entry->offset;
+            view->size = entry->size;
+            return true;
+        }
+    }
+
+    char loosePath[ASSET_PATH_MAX * 2];
+    JoinAssetPath(loosePath, sizeof(loosePath), fs->root, normalized);
+
+    uint64_t size = 0;
+    char* buffer = ReadEntireFile(loosePath, &size);
+
+    if (buffer == NULL) {
+        return false;
+    }
+
+    view->data = (const uint8_t*)buffer;
+    view->size = size;
+    view->buffer = buffer;
+
+    return true;
+}
+
+GL2D_API void GL2D_AssetFSClose(GL2D_AssetFS fs, GL2D_AssetView* view) {
+    (void)fs;
+
+    MemFree(view->buffer);
+    memset(view, 0, sizeof(GL2D_AssetView));
+}
+
+GL2D_API bool GL2D_AssetFSExists(GL2D_AssetFS fs, const char* path) {
+    char normalized[ASSET_PATH_MAX];
+
+    if (!NormalizeAssetPath(path, normalized, sizeof(normalized))) {
+        return false;
+    }
+
+    uint64_t hash = HashBytes(normalized, strlen(normalized));
+
+    for (uint32_t i = 0; i < fs->packCount; i++) {
+        if (FindPackEntry(&fs->packs[i], normalized, hash) != NULL) {
+            return true;
+        }
+    }
+
+    char loosePath[ASSET_PATH_MAX * 2];
+    JoinAssetPath(loosePath, sizeof(loosePath), fs->root, normalized);
+
+    FILE* file = fopen(loosePath, "rb");
+
+    if (file == NULL) {
+        return false;
+    }
+
+    fclose(file);
+
+    return true;
+}
+
+GL2D_API GL2D_Shader GL2D_CreateShaderFromAssets(GL2D_AssetFS fs, const char* vertexPath, const char* fragmentPath) {
+    GL2D_AssetView vertex, fragment;
+
+    if (!GL2D_AssetFSOpen(fs, vertexPath, &vertex)) {
+        fprintf(stderr, "ERROR: Couldn't find asset %s\n", vertexPath);
+        return GL2D_INVALID_HANDLE;
+    }
+
+    if (!GL2D_AssetFSOpen(fs, fragmentPath, &fragment)) {
+        fprintf(stderr, "ERROR: Couldn't find asset %s\n", fragmentPath);
+        GL2D_AssetFSClose(fs, &vertex);
+        return GL2D_INVALID_HANDLE;
+    }
+
+    GL2D_Shader shader = CreateShader((const char*)vertex.data, (int32_t)vertex.size, (const char*)fragment.data, (int32_t)fragment.size);
+
+    GL2D_AssetFSClose(fs, &vertex);
+    GL2D_AssetFSClose(fs, &fragment);
+
+    return shader;
+}
+
+GL2D_API GL2D_Texture GL2D_CreateTextureFromAsset(GL2D_AssetFS fs, const char* path) {
+    GL2D_AssetView view;
+
+    if (!GL2D_AssetFSOpen(fs, path, &view)) {
+        fprintf(stderr, "ERROR: Couldn't find asset %s\n", path);
+        return GL2D_INVALID_HANDLE;
+    }
+
+    GL2D_Texture texture = CreateTextureFromMemory(view.data, view.size);
+    GL2D_AssetFSClose(fs, &view);
+
+    return texture;
+}
+
+typedef struct AssetPackSource {
+    char name[ASSET_PATH_MAX];
+    uint64_t hash;
+    uint64_t size;
+} AssetPackSource;
+
+static int CompareAssetPackSources(const void* a, const void* b) {
+    const AssetPackSource* source1 = a;
+    const AssetPackSource* source2 = b;
+
+    if (source1->hash != source2->hash) {
+        return source1->hash < source2->hash ? -1 : 1;
+    }
+
+    return strcmp(source1->name, source2->name);
+}
+
+static bool WritePadding(FILE* file, uint64_t* offset) {
+    static const uint8_t zeros[ASSET_PACK_ALIGNMENT] = { 0 };
+    uint64_t padding = (ASSET_PACK_ALIGNMENT - *offset % ASSET_PACK_ALIGNMENT) % ASSET_PACK_ALIGNMENT;
+
+    *offset += padding;
+
+    return padding == 0 || fwrite(zeros, padding, 1, file) == 1;
+}
+
+// Packs the files at root/paths[i] under the names paths[i].
+GL2D_API bool GL2D_WriteAssetPack(const char* packPath, const char* root, const char* const* paths, uint32_t count) {
+    AssetPackSource* sources = MemCalloc(count + 1, sizeof(AssetPackSource));
+    AssetPackEntry* entries = MemCalloc(count + 1, sizeof(AssetPackEntry));
+
+    if (sources == NULL || entries == NULL) {
+        fprintf(stderr, "ERROR: Couldn't allocate asset pack directory\n");
+        MemFree(sources);
+        MemFree(entries);
+        return false;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        if (!NormalizeAssetPath(paths[i], sources[i].name, sizeof(sources[i].name))) {
+            fprintf(stderr, "ERROR: Asset path %s is too long\n", paths[i]);
+            MemFree(sources);
+            MemFree(entries);
+            return false;
+        }
+
+        sources[i].hash = HashBytes(sources[i].name, strlen(sources[i].name));
+    }
+
+    qsort(sources, count, sizeof(AssetPackSource), CompareAssetPackSources);
+
+    FILE* file = fopen(packPath, "wb");
+
+    if (file == NULL) {
+        fprintf(stderr, "ERROR: Couldn't open file %s: %s\n", packPath, strerror(errno));
+        MemFree(sources);
+        MemFree(entries);
+        return false;
+    }
+
+    // the directory is written twice, the second time with the offsets filled in
+    AssetPackHeader header = { ASSET_PACK_MAGIC, ASSET_PACK_VERSION, count, 0 };
+    uint64_t offset = sizeof(AssetPackHeader) + (uint64_t)count * sizeof(AssetPackEntry);
+    bool written = fwrite(&header, sizeof(AssetPackHeader), 1, file) == 1 &&
+                   (count == 0 || fwrite(entries, sizeof(AssetPackEntry), count, file) == count);
+
+    for (uint32_t i = 0; i < count && written; i++) {
+        uint32_t length = (uint32_t)strlen(sources[i].name);
+
+        entries[i].hash = sources[i].hash;
+        entries[i].nameOffset = (uint32_t)offset;
+        entries[i].nameLength = length;
+        written = fwrite(sources[i].name, length, 1, file) == 1 || length == 0;
+        offset += length;
+    }
+
+    for (uint32_t i = 0; i < count && written; i++) {
+        char sourcePath[ASSET_PATH_MAX * 2];
+        JoinAssetPath(sourcePath, sizeof(sourcePath), root, sources[i].name);
+
+        uint64_t size = 0;
+        char* data = ReadEntireFile(sourcePath, &size);
+
+        written = data != NULL && WritePadding(file, &offset) && (size == 0 || fwrite(data, size, 1, file) == 1);
+
+        entries[i].offset = offset;
+        entries[i].size = size;
+        offset += size;
+        MemFree(data);
+    }
+
+    if (written) {
+        written = fseek(file, sizeof(AssetPackHeader), SEEK_SET) == 0 &&
+                  (count == 0 || fwrite(entries, sizeof(AssetPackEntry), count, file) == count);
+    }
+
+    fclose(file);
+    MemFree(sources);
+    MemFree(entries);
+
+    if (!written) {
+        fprintf(stderr, "ERROR: Couldn't write asset pack %s\n", packPath);
+        remove(packPath);
+    }
+
+    return written;
+}
+
+GL2D_API GL2D_VertexArray GL2D_CreateVertexArray() {
+    if (!RequireGL("GL2D_CreateVertexArray")) {
+        return GL2D_INVALID_HANDLE;
+    }
+
+    GL2D_VertexArray handle = PoolAllocate(&vertexArrayPool);
+
+    if (handle == GL2D_INVALID_HANDLE) {
+        printf("ERROR: Couldn't allocate vao");
+        return GL2D_INVALID_HANDLE;
+    }
+
+    VertexArray* vao = PoolGet(&vertexArrayPool, handle);
+
+    glGenVertexArrays(1, &vao->id);
+    StateBindVertexArray(vao->id);
+
+    return handle;
+}
+
+GL2D_API void GL2D_DestroyVertexArray(GL2D_VertexArray handle) {
+    VertexArray* vao = PoolGet(&vertexArrayPool, handle);
+
+    if (vao == NULL) {
+        fprintf(stderr, "ERROR: Invalid or destroyed vertex array handle 0x%08x\n", handle);
+        return;
+    }
+
+    StateForgetVertexArray(vao->id);
+    glDeleteVertexArrays(1, &vao->id);
+    PoolFree(&vertexArrayPool, handle);
+}
+
+GL2D_API void GL2D_BindVertexArray(GL2D_VertexArray handle) {
+    VertexArray* vao = PoolGet(&vertexArrayPool, handle);
+
+    if (vao != NULL) {
+        StateBindVertexArray(vao->id);
+    }
+}
+
+GL2D_API GL2D_VertexBuffer GL2D_CreateVertexBuffer(const void* vertices, uint64_t size) {
+    if (!RequireGL("GL2D_CreateVertexBuffer")) {
+        return GL2D_INVALID_HANDLE;
+    }
+
+    GL2D_VertexBuffer handle = PoolAllocate(&vertexBufferPool);
+
+    if (handle == GL2D_INVALID_HANDLE) {
+        printf("ERROR: Couldn't allocate vbo");
+        return GL2D_INVALID_HANDLE;
+    }
+
+    VertexBuffer* vbo = PoolGet(&vertexBufferPool, handle);
+
+    glGenBuffers(1, &vbo->id);
+    StateBindBuffer(GL_ARRAY_BUFFER, vbo->id);
+    glBufferData(GL_ARRAY_BUFFER, size, vertices, GL_STATIC_DRAW);
+    CountBufferUpload(vertices != NULL ? size : 0);
+
+    return handle;
+}
+
+GL2D_API void GL2D_DestroyVertexBuffer(GL2D_VertexBuffer handle) {
+    VertexBuffer* vbo = PoolGet(&vertexBufferPool, handle);
+
+    if (vbo == NULL) {
+        fprintf(stderr, "ERROR: Invalid or destroyed vertex buffer handle 0x%08x\n", handle);
+        return;
+    }
+
+    ForgetCachedVertexArrays(handle, GL2D_INVALID_HANDLE);
+    StateForgetBuffer(vbo->id);
+    glDeleteBuffers(1, &vbo->id);
+    PoolFree(&vertexBufferPool, handle);
+}
+
+GL2D_API void GL2D_BindVertexBuffer(GL2D_VertexBuffer handle) {
+    VertexBuffer* vbo = PoolGet(&vertexBufferPool, handle);
+
+    if (vbo != NULL) {
+        StateBindBuffer(GL_ARRAY_BUFFER, vbo->id);
+    }
+}
+
+GL2D_API GL2D_IndexBuffer GL2D_CreateIndexBuffer(const uint32_t* indices, uint64_t size) {
+    if (!RequireGL("GL2D_CreateIndexBuffer")) {
+        return GL2D_INVALID_HANDLE;
+    }
+
+    GL2D_IndexBuffer handle = PoolAllocate(&indexBufferPool);
+
+    if (handle == GL2D_INVALID_HANDLE) {
+        printf("ERROR: Couldn't allocate ibo");
+        return GL2D_INVALID_HANDLE;
+    }
+
+    IndexBuffer* ibo = PoolGet(&indexBufferPool, handle);
+
+    glGenBuffers(1, &ibo->id);
+    StateBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo->id);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, size, indices, GL_STATIC_DRAW);
+    CountBufferUpload(indices != NULL ? size : 0);
+
+    return handle;
+}
+
+GL2D_API void GL2D_DestroyIndexBuffer(GL2D_IndexBuffer handle) {
+    IndexBuffer* ibo = PoolGet(&indexBufferPool, handle);
+
+    if (ibo == NULL) {
+        fprintf(stderr, "ERROR: Invalid or destroyed index buffer handle 0x%08x\n", handle);
+        return;
+    }
+
+    ForgetCachedVertexArrays(GL2D_INVALID_HANDLE, handle);
+    StateForgetBuffer(ibo->id);
+    glDeleteBuffers(1, &ibo->id);
+    PoolFree(&indexBufferPool, handle);
+}
+
+GL2D_API void GL2D_BindIndexBuffer(GL2D_IndexBuffer handle) {
+    IndexBuffer* ibo = PoolGet(&indexBufferPool, handle);
+
+    if (ibo != NULL) {
+        StateBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo->id);
+    }
+}
+
+static const struct {
+    GLenum type;
+    uint32_t size;
+} attributeFormats[] = {
+    [GL2D_ATTRIBUTE_FLOAT] = { GL_FLOAT, 4 },
+    [GL2D_ATTRIBUTE_HALF_FLOAT] = { GL_HALF_FLOAT, 2 },
+    [GL2D_ATTRIBUTE_INT16] = { GL_SHORT, 2 },
+    [GL2D_ATTRIBUTE_UINT16] = { GL_UNSIGNED_SHORT, 2 },
+    [GL2D_ATTRIBUTE_INT8] = { GL_BYTE, 1 },
+    [GL2D_ATTRIBUTE_UINT8] = { GL_UNSIGNED_BYTE, 1 },
+};
+
+// Attributes are packed in the order they're added, each starting on a 4 byte boundary like
+// GL wants, which is also where a C struct of the same fields puts them.
+GL2D_API void GL2D_VertexLayoutAdd(GL2D_VertexLayout* layout, uint32_t location, uint32_t type, uint32_t components, bool normalized) {
+    if (layout->count == GL2D_MAX_VERTEX_ATTRIBUTES) {
+        fprintf(stderr, "ERROR: Vertex layouts hold at most %d attributes\n", GL2D_MAX_VERTEX_ATTRIBUTES);
+        return;
+    }
+
+    if (type > GL2D_ATTRIBUTE_UINT8 || components < 1 || components > 4) {
+        fprintf(stderr, "ERROR: Invalid vertex attribute for location %u\n", location);
+        return;
+    }
+
+    uint32_t offset = (layout->stride + 3) & ~3u;
+
+    layout->attributes[layout->count++] = (GL2D_VertexAttribute) {
+        .location = location,
+        .type = type,
+        .components = components,
+        .normalized = normalized,
+        .offset = offset,
+    };
+
+    layout->stride = (offset + attributeFormats[type].size * components + 3) & ~3u;
+}
+
+// Expects the vertex array and vertex buffer to be bound
+static void ApplyVertexLayout(const GL2D_VertexLayout* layout) {
+    for (uint32_t i = 0; i < layout->count; i++) {
+        const GL2D_VertexAttribute* attribute = &layout->attributes[i];
+
+        glVertexAttribPointer(attribute->location, attribute->components, attributeFormats[attribute->type].type, attribute->normalized, layout->stride, (void*)(uintptr_t)attribute->offset);
+        glEnableVertexAttribArray(attribute->location);
+    }
+}
+
+GL2D_API void GL2D_ConfigureVertexArray(GL2D_VertexArray vao, const GL2D_VertexLayout* layout, GL2D_VertexBuffer vbo, GL2D_IndexBuffer ibo) {
+    if (!RequireGL("GL2D_ConfigureVertexArray")) {
+        return;
+    }
+
+    VertexArray* vertexArray = PoolGet(&vertexArrayPool, vao);
+    VertexBuffer* vertexBuffer = PoolGet(&vertexBufferPool, vbo);
+    IndexBuffer* indexBuffer = PoolGet(&indexBufferPool, ibo);
+
+    if (vertexArray == NULL || vertexBuffer == NULL) {
+        fprintf(stderr, "ERROR: Invalid vertex array or vertex buffer handle\n");
+        return;
+    }
+
+    StateBindVertexArray(vertexArray->id);
+    StateBindBuffer(GL_ARRAY_BUFFER, vertexBuffer->id);
+    ApplyVertexLayout(layout);
+
+    if (indexBuffer != NULL) {
+        StateBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer->id);
+    }
+}
+
+typedef struct VertexArrayCacheEntry {
+    uint64_t key;
+    GL2D_VertexLayout layout;
+    GL2D_VertexBuffer vbo;
+    GL2D_IndexBuffer ibo;
+    GL2D_VertexArray vao;
+} VertexArrayCacheEntry;
+
+// One vertex array per layout/buffer pair, looked up through an open addressed table of entry
+// indices. Entries only go away with their buffers, which just rebuilds the table.
+static struct {
+    VertexArrayCacheEntry* entries;
+    uint32_t count;
+    uint32_t capacity;
+    int32_t* table;
+    uint32_t tableMask;
+} vertexArrayCache;
+
+static uint64_t VertexArrayCacheKey(const GL2D_VertexLayout* layout, GL2D_VertexBuffer vbo, GL2D_IndexBuffer ibo) {
+    uint64_t key = HashBytes(&layout->stride, sizeof(layout->stride));
+
+    // field by field, the padding after normalized is whatever the caller's stack held
+    for (uint32_t i = 0; i < layout->count; i++) {
+        const GL2D_VertexAttribute* attribute = &layout->attributes[i];
+        uint32_t fields[5] = { attribute->location, attribute->type, attribute->components, attribute->normalized, attribute->offset };
+
+        key = HashBytesContinue(key, fields, sizeof(fields));
+    }
+
+    key = HashBytesContinue(key, &vbo, sizeof(vbo));
+
+    return HashBytesContinue(key, &ibo, sizeof(ibo));
+}
+
+static bool VertexLayoutEqual(const GL2D_VertexLayout* layout1, const GL2D_VertexLayout* layout2) {
+    if (layout1->count != layout2->count || layout1->stride != layout2->stride) {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < layout1->count; i++) {
+        const GL2D_VertexAttribute* attribute1 = &layout1->attributes[i];
+        const GL2D_VertexAttribute* attribute2 = &layout2->attributes[i];
+
+        if (attribute1->location != attribute2->location || attribute1->type != attribute2->type || attribute1->components != attribute2->components ||
+            attribute1->normalized != attribute2->normalized || attribute1->offset != attribute2->offset) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool RebuildVertexArrayCacheTable(uint32_t tableSize) {
+    int32_t* table = MemRealloc(vertexArrayCache.table, tableSize * sizeof(int32_t));
+
+    if (table == NULL) {
+        return false;
+    }
+
+    vertexArrayCache.table = table;
+    vertexArrayCache.tableMask = tableSize - 1;
+    memset(table, 0xFF, tableSize * sizeof(int32_t));
+
+    for (uint32_t i = 0; i < vertexArrayCache.count; i++) {
+        uint32_t slot = (uint32_t)vertexArrayCache.entries[i].key & vertexArrayCache.tableMask;
+
+        while (table[slot] >= 0) {
+            slot = (slot + 1) & vertexArrayCache.tableMask;
+        }
+
+        table[slot] = (int32_t)i;
+    }
+
+    return true;
+}
+
+GL2D_API GL2D_VertexArray GL2D_GetVertexArray(const GL2D_VertexLayout* layout, GL2D_VertexBuffer vbo, GL2D_IndexBuffer ibo) {
+    if (!RequireGL("GL2D_GetVertexArray")) {
+        return GL2D_INVALID_HANDLE;
+    }
+
+    uint64_t key = VertexArrayCacheKey(layout, vbo, ibo);
+
+    if (vertexArrayCache.table != NULL) {
+        uint32_t slot = (uint32_t)key & vertexArrayCache.tableMask;
+
+        while (vertexArrayCache.table[slot] >= 0) {
+            VertexArrayCacheEntry* entry = &vertexArrayCache.entries[vertexArrayCache.table[slot]];
+
+            if (entry->key == key && entry->vbo == vbo && entry->ibo == ibo && VertexLayoutEqual(&entry->layout, layout)) {
+                return entry->vao;
+            }
+
+            slot = (slot + 1) & vertexArrayCache.tableMask;
+        }
+    }
+
+    if (PoolGet(&vertexBufferPool, vbo) == NULL) {
+        fprintf(stderr, "ERROR: Invalid or destroyed vertex buffer handle 0x%08x\n", vbo);
+        return GL2D_INVALID_HANDLE;
+    }
+
+    if (vertexArrayCache.count == vertexArrayCache.capacity) {
+        uint32_t capacity = vertexArrayCache.capacity == 0 ? 16 : vertexArrayCache.capacity * 2;
+        VertexArrayCacheEntry* entries = MemRealloc(vertexArrayCache.entries, capacity * sizeof(VertexArrayCacheEntry));
+
+        if (entries == NULL || !RebuildVertexArrayCacheTable(capacity * 2)) {
+            vertexArrayCache.entries = entries != NULL ? entries : vertexArrayCache.entries;
+            fprintf(stderr, "ERROR: Couldn't grow vertex array cache\n");
+            return GL2D_INVALID_HANDLE;
+        }
+
+        vertexArrayCache.entries = entries;
+        vertexArrayCache.capacity = capacity;
+    }
+
+    GL2D_VertexArray vao = GL2D_CreateVertexArray();
+
+    if (vao == GL2D_INVALID_HANDLE) {
+        return GL2D_INVALID_HANDLE;
+    }
+
+    GL2D_ConfigureVertexArray(vao, layout, vbo, ibo);
+
+    VertexArrayCacheEntry* entry = &vertexArrayCache.entries[vertexArrayCache.count];
+    entry->key = key;
+    entry->layout = *layout;
+    entry->vbo = vbo;
+    entry->ibo = ibo;
+    entry->vao = vao;
+
+    uint32_t slot = (uint32_t)key & vertexArrayCache.tableMask;
+
+    while (vertexArrayCache.table[slot] >= 0) {
+        slot = (slot + 1) & vertexArrayCache.tableMask;
+    }
+
+    vertexArrayCache.table[slot] = (int32_t)vertexArrayCache.count++;
+
+    return vao;
+}
+
+static void ForgetCachedVertexArrays(GL2D_VertexBuffer vbo, GL2D_IndexBuffer ibo) {
+    uint32_t kept = 0;
+
+    for (uint32_t i = 0; i < vertexArrayCache.count; i++) {
+        VertexArrayCacheEntry* entry = &vertexArrayCache.entries[i];
+
+        if ((vbo != GL2D_INVALID_HANDLE && entry->vbo == vbo) || (ibo != GL2D_INVALID_HANDLE && entry->ibo == ibo)) {
+            GL2D_DestroyVertexArray(entry->vao);
+        }
+        else {
+            vertexArrayCache.entries[kept++] = *entry;
+        }
+    }
+
+    if (kept != vertexArrayCache.count) {
+        vertexArrayCache.count = kept;
+        RebuildVertexArrayCacheTable(vertexArrayCache.tableMask + 1);
+    }
+}
+
+static void ClearVertexArrayCache(void) {
+    for (uint32_t i = 0; i < vertexArrayCache.count; i++) {
+        GL2D_DestroyVertexArray(vertexArrayCache.entries[i].vao);
+    }
+
+    MemFree(vertexArrayCache.entries);
+    MemFree(vertexArrayCache.table);
+    memset(&vertexArrayCache, 0, sizeof(vertexArrayCache));
+}
+
+GL2D_API uint16_t GL2D_FloatToHalf(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    uint32_t sign = (bits >> 16) & 0x8000;
+    uint32_t mantissa = bits & 0x7FFFFF;
+    int32_t exponent = (int32_t)((bits >> 23) & 0xFF) - 127 + 15;
+
+    if (((bits >> 23) & 0xFF) == 0xFF) {
+        return (uint16_t)(sign | 0x7C00 | (mantissa != 0 ? 0x200 : 0));
+    }
+
+    if (exponent >= 31) {
+        return (uint16_t)(sign | 0x7C00);
+    }
+
+    uint32_t half, rest, halfway;
+
+    if (exponent <= 0) {
+        if (exponent < -10) {
+            return (uint16_t)sign;
+        }
+
+        // subnormal, the implicit leading bit becomes explicit
+        uint32_t shift = (uint32_t)(14 - exponent);
+        mantissa |= 0x800000;
+        half = mantissa >> shift;
+        rest = mantissa & ((1u << shift) - 1);
+        halfway = 1u << (shift - 1);
+    }
+    else {
+        half = ((uint32_t)exponent << 10) | (mantissa >> 13);
+        rest = mantissa & 0x1FFF;
+        halfway = 0x1000;
+    }
+
+    // round to nearest even, a carry out of the mantissa correctly bumps the exponent
+    if (rest > halfway || (rest == halfway && (half & 1))) {
+        half++;
+    }
+
+    return (uint16_t)(sign | half);
+}
+
+#ifndef GL_MAP_PERSISTENT_BIT
+    #define GL_MAP_PERSISTENT_BIT 0x0040
+    #define GL_MAP_COHERENT_BIT 0x0080
+#endif
+
+typedef void (APIENTRYP BufferStorageProc)(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+
+#define STREAM_MAX_FENCES 8
+
+// A fence covers every byte handed out since the previous one, wrap padding included, so
+// retiring fences in order walks the tail around the ring exactly like the head did.
+typedef struct StreamFence {
+    GLsync sync;
+    uint64_t bytes;
+} StreamFence;
+
+struct GL2D_StreamBuffer {
+    uint32_t id;
+    uint32_t target;
+    uint64_t size;
+    uint8_t* persistent;
+    bool mapped;
+    uint64_t head;
+    uint64_t tail;
+    uint64_t used;
+    uint64_t frameBytes;
+    StreamFence fences[STREAM_MAX_FENCES];
+    uint32_t fenceFirst;
+    uint32_t fenceCount;
+    GL2D_StreamBufferStats stats;
+};
+
+GL2D_API GL2D_StreamBuffer GL2D_CreateStreamBuffer(uint32_t type, uint64_t size) {
+    if (!RequireGL("GL2D_CreateStreamBuffer")) {
+        return NULL;
+    }
+
+    GL2D_StreamBuffer stream = MemAlloc(sizeof(struct GL2D_StreamBuffer));
+
+    if (stream == NULL) {
+        fprintf(stderr, "ERROR: Couldn't allocate stream buffer\n");
+        return NULL;
+    }
+
+    memset(stream, 0, sizeof(struct GL2D_StreamBuffer));
+
+    stream->target = type == GL2D_STREAM_INDICES ? GL_ELEMENT_ARRAY_BUFFER : GL_ARRAY_BUFFER;
+    stream->size = size;
+
+    // created and mapped through the copy target, binding GL_ELEMENT_ARRAY_BUFFER here would
+    // rewire whatever vertex array happens to be bound
+    glGenBuffers(1, &stream->id);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, stream->id);
+
+    void* bufferStorage = NULL;
+
+    if (HasGLVersion(4, 4) || HasGLExtension("GL_ARB_buffer_storage")) {
+        bufferStorage = GetGLProc("glBufferStorage");
+    }
+
+    if (bufferStorage != NULL) {
+        BufferStorageProc storage;
+        memcpy(&storage, &bufferStorage, sizeof(void*));
+
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        storage(GL_COPY_WRITE_BUFFER, size, NULL, flags);
+        stream->persistent = glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, size, flags);
+    }
+
+    if (stream->persistent == NULL) {
+        if (bufferStorage != NULL) {
+            // immutable storage can't be respecified, start over with a plain buffer
+            glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+            glDeleteBuffers(1, &stream->id);
+            glGenBuffers(1, &stream->id);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, stream->id);
+        }
+
+        glBufferData(GL_COPY_WRITE_BUFFER, size, NULL, GL_STREAM_DRAW);
+    }
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    stream->stats.persistent = stream->persistent != NULL;
+
+    return stream;
+}
+
+GL2D_API void GL2D_DestroyStreamBuffer(GL2D_StreamBuffer stream) {
+    for (uint32_t i = 0; i < stream->fenceCount; i++) {
+        glDeleteSync(stream->fences[(stream->fenceFirst + i) % STREAM_MAX_FENCES].sync);
+    }
+
+    if (stream->persistent != NULL || stream->mapped) {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, stream->id);
+        glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+
+    StateForgetBuffer(stream->id);
+    glDeleteBuffers(1, &stream->id);
+    MemFree(stream);
+}
+
+static void StreamRetireFence(GL2D_StreamBuffer stream, bool wait) {
+    StreamFence* fence = &stream->fences[stream->fenceFirst];
+    GLenum result = glClientWaitSync(fence->sync, 0, 0);
+
+    if (result == GL_TIMEOUT_EXPIRED) {
+        if (!wait) {
+            return;
+        }
+
+        stream->stats.stalls++;
+
+        do {
+            result = glClientWaitSync(fence->sync, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+        } while (result == GL_TIMEOUT_EXPIRED);
+    }
+
+    glDeleteSync(fence->sync);
+    stream->tail = (stream->tail + fence->bytes) % stream->size;
+    stream->used -= fence->bytes;
+    stream->fenceFirst = (stream->fenceFirst + 1) % STREAM_MAX_FENCES;
+    stream->fenceCount--;
+}
+
+static void StreamPushFence(GL2D_StreamBuffer stream) {
+    if (stream->fenceCount == STREAM_MAX_FENCES) {
+        StreamRetireFence(stream, true);
+    }
+
+    StreamFence* fence = &stream->fences[(stream->fenceFirst + stream->fenceCount) % STREAM_MAX_FENCES];
+    fence->sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    fence->bytes = stream->frameBytes;
+    stream->fenceCount++;
+    stream->frameBytes = 0;
+}
+
+static bool StreamReserve(GL2D_StreamBuffer stream, uint64_t size, uint64_t alignment, uint64_t* offset) {
+    if (size > stream->size) {
+        fprintf(stderr, "ERROR: %llu bytes don't fit a %llu byte stream buffer\n", (unsigned long long)size, (unsigned long long)stream->size);
+        return false;
+    }
+
+    alignment = alignment > 0 ? alignment : 4;
+
+    // free whatever the GPU already finished with, without waiting
+    while (stream->fenceCount > 0 && glClientWaitSync(stream->fences[stream->fenceFirst].sync, 0, 0) != GL_TIMEOUT_EXPIRED) {
+        StreamRetireFence(stream, false);
+    }
+
+    for (;;) {
+        uint64_t aligned = (stream->head + alignment - 1) / alignment * alignment;
+        bool wrapped = stream->used > 0 && stream->head <= stream->tail;
+        uint64_t limit = wrapped ? stream->tail : stream->size;
+
+        if (aligned + size <= limit) {
+            uint64_t bytes = aligned + size - stream->head;
+
+            *offset = aligned;
+            stream->head = aligned + size;
+            stream->used += bytes;
+            stream->frameBytes += bytes;
+            stream->stats.allocations++;
+            stream->stats.bytes += size;
+
+            return true;
+        }
+
+        if (!wrapped && stream->tail > 0) {
+            // the rest of the ring is padding until the GPU gets past it
+            uint64_t padding = stream->size - stream->head;
+
+            stream->head = 0;
+            stream->used += padding;
+            stream->frameBytes += padding;
+            stream->stats.wraps++;
+            continue;
+        }
+
+        if (stream->fenceCount == 0) {
+            if (stream->frameBytes == 0) {
+                fprintf(stderr, "ERROR: Stream buffer has no room for %llu bytes\n", (unsigned long long)size);
+                return false;
+            }
+
+            // this frame alone filled the ring, fence what it has drawn so far and wait for that
+            StreamPushFence(stream);
+        }
+
+        StreamRetireFence(stream, true);
+
+        if (stream->used == 0) {
+            stream->head = 0;
+            stream->tail = 0;
+        }
+    }
+}
+
+// The returned memory is write-only and, unless the buffer is persistently mapped, only valid
+// until GL2D_StreamBufferUnmap, which has to come before any draw reading it. A frame that
+// outgrows the ring waits on its own earlier ranges, so those have to be drawn by then.
+GL2D_API void* GL2D_StreamBufferMap(GL2D_StreamBuffer stream, uint64_t size, uint64_t alignment, uint64_t* offset) {
+    if (stream->mapped) {
+        GL2D_StreamBufferUnmap(stream);
+    }
+
+    if (!StreamReserve(stream, size, alignment, offset)) {
+        return NULL;
+    }
+
+    CountBufferUpload(size);
+
+    if (stream->persistent != NULL) {
+        return stream->persistent + *offset;
+    }
+
+    // the fences already guarantee the GPU is done with this range, so the driver needn't check
+    glBindBuffer(GL_COPY_WRITE_BUFFER, stream->id);
+    void* memory = glMapBufferRange(GL_COPY_WRITE_BUFFER, *offset, size, GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+    stream->mapped = memory != NULL;
+
+    if (memory == NULL) {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        fprintf(stderr, "ERROR: Couldn't map stream buffer\n");
+    }
+
+    return memory;
+}
+
+GL2D_API void GL2D_StreamBufferUnmap(GL2D_StreamBuffer stream) {
+    if (!stream->mapped) {
+        return;
+    }
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, stream->id);
+    glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    stream->mapped = false;
+}
+
+GL2D_API bool GL2D_StreamBufferWrite(GL2D_StreamBuffer stream, const void* data, uint64_t size, uint64_t alignment, uint64_t* offset) {
+    void* memory = GL2D_StreamBufferMap(stream, size, alignment, offset);
+
+    if (memory == NULL) {
+        return false;
+    }
+
+    memcpy(memory, data, size);
+    GL2D_StreamBufferUnmap(stream);
+
+    return true;
+}
+
+// Call once the draws reading this frame's ranges are issued, the fence tells later frames
+// when those ranges can be overwritten.
+GL2D_API void GL2D_StreamBufferEndFrame(GL2D_StreamBuffer stream) {
+    GL2D_StreamBufferUnmap(stream);
+
+    if (stream->frameBytes == 0) {
+        return;
+    }
+
+    StreamPushFence(stream);
+}
+
+GL2D_API void GL2D_BindStreamBuffer(GL2D_StreamBuffer stream) {
+    StateBindBuffer(stream->target, stream->id);
+}
+
+GL2D_API GL2D_StreamBufferStats GL2D_GetStreamBufferStats(GL2D_StreamBuffer stream) {
+    return stream->stats;
+}
+
+static bool InitBatch(GL2D_Renderer renderer) {
+    renderer->batchShader = GL2D_CreateShaderFromSource(batchVertexSource, batchFragmentSource);
+
+    if (renderer->batchShader == GL2D_INVALID_HANDLE) {
+        return false;
+    }
+
+    const uint8_t white[4] = { 255, 255, 255, 255 };
+    renderer->whiteTexture = GL2D_CreateTextureFromPixels(white, 1, 1);
+
+    if (renderer->whiteTexture == GL2D_INVALID_HANDLE) {
+        return false;
+    }
+
+    renderer->batchVertices = MemAlloc(GL2D_BATCH_MAX_VERTICES * sizeof(BatchVertex));
+
+    if (renderer->batchVertices == NULL) {
+        fprintf(stderr, "ERROR: Couldn't allocate batch vertices\n");
+        return false;
+    }
+
+    uint32_t* indices = MemAlloc(GL2D_BATCH_MAX_INDICES * sizeof(uint32_t));
+
+    if (indices == NULL) {
+        fprintf(stderr, "ERROR: Couldn't allocate batch indices\n");
+        return false;
+    }
+
+    for (uint32_t i = 0, offset = 0; i < GL2D_BATCH_MAX_INDICES; i += 6, offset += 4) {
+        indices[i + 0] = offset + 0;
+        indices[i + 1] = offset + 1;
+        indices[i + 2] = offset + 2;
+        indices[i + 3] = offset + 2;
+        indices[i + 4] = offset + 3;
+        indices[i + 5] = offset + 0;
+    }
+
+    glGenVertexArrays(1, &renderer->batchVao);
+    StateBindVertexArray(renderer->batchVao);
+
+    glGenBuffers(1, &renderer->batchVbo);
+    StateBindBuffer(GL_ARRAY_BUFFER, renderer->batchVbo);
+    glBufferData(GL_ARRAY_BUFFER, GL2D_BATCH_MAX_VERTICES * sizeof(BatchVertex), NULL, GL_DYNAMIC_DRAW);
+
+    glGenBuffers(1, &renderer->batchIbo);
+    StateBindBuffer(GL_ELEMENT_ARRAY_BUFFER, renderer->batchIbo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, GL2D_BATCH_MAX_INDICES * sizeof(uint32_t), indices, GL_STATIC_DRAW);
+
+    MemFree(indices);
+
+    GL2D_VertexLayout layout = { 0 };
+    GL2D_VertexLayoutAdd(&layout, 0, GL2D_ATTRIBUTE_FLOAT, 2, false);
+    GL2D_VertexLayoutAdd(&layout, 2, GL2D_ATTRIBUTE_FLOAT, 2, false);
+    GL2D_VertexLayoutAdd(&layout, 1, GL2D_ATTRIBUTE_UINT8, 4, true);
+    GL2D_VertexLayoutAdd(&layout, 3, GL2D_ATTRIBUTE_UINT8, 1, false);
+    ApplyVertexLayout(&layout);
+
+    StateBindVertexArray(0);
+
+    int maxTextureUnits = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_IMAGE_UNITS, &maxTextureUnits);
+    renderer->batchMaxTextures = maxTextureUnits < GL2D_BATCH_MAX_TEXTURES ? (uint32_t)maxTextureUnits : GL2D_BATCH_MAX_TEXTURES;
+
+    int samplers[GL2D_BATCH_MAX_TEXTURES];
+
+    for (int i = 0; i < GL2D_BATCH_MAX_TEXTURES; i++) {
+        samplers[i] = i;
+    }
+
+    GLuint program = GetShader(renderer->batchShader)->id;
+    StateUseProgram(program);
+    glUniform1iv(glGetUniformLocation(program, "textures"), GL2D_BATCH_MAX_TEXTURES, samplers);
+
+    renderer->batchProjection = GL2D_ShaderGetUniform(renderer->batchShader, "projection");
+
+    return true;
+}
+
+static bool InitInstancing(GL2D_Renderer renderer) {
+    renderer->instanceShader = GL2D_CreateShaderFromSource(instanceVertexSource, instanceFragmentSource);
+
+    if (renderer->instanceShader == GL2D_INVALID_HANDLE) {
+        return false;
+    }
+
+    renderer->instanceProjection = GL2D_ShaderGetUniform(renderer->instanceShader, "projection");
+    renderer->instanceStream = GL2D_CreateStreamBuffer(GL2D_STREAM_VERTICES, GL2D_INSTANCE_STREAM_SIZE);
+
+    if (renderer->instanceStream == NULL) {
+        return false;
+    }
+
+    // same winding as the batch quads, so the first six batch indices draw one instance
+    const float corners[] = { -0.5f, -0.5f, -0.5f, 0.5f, 0.5f, 0.5f, 0.5f, -0.5f };
+
+    glGenVertexArrays(1, &renderer->instanceVao);
+    StateBindVertexArray(renderer->instanceVao);
+
+    glGenBuffers(1, &renderer->instanceCornerVbo);
+    StateBindBuffer(GL_ARRAY_BUFFER, renderer->instanceCornerVbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    StateBindBuffer(GL_ELEMENT_ARRAY_BUFFER, renderer->batchIbo);
+
+    for (uint32_t i = 1; i <= 4; i++) {
+        glEnableVertexAttribArray(i);
+        glVertexAttribDivisor(i, 1);
+    }
+
+    StateBindVertexArray(0);
+
+    return true;
+}
+
+static void FlushBatch(GL2D_Renderer renderer) {
+    if (renderer->batchQuadCount == 0) {
+        return;
+    }
+
+    // orphan the previous storage so the driver doesn't stall on draws still reading it
+    StateBindBuffer(GL_ARRAY_BUFFER, renderer->batchVbo);
+    glBufferData(GL_ARRAY_BUFFER, GL2D_BATCH_MAX_VERTICES * sizeof(BatchVertex), NULL, GL_DYNAMIC_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, renderer->batchQuadCount * 4 * sizeof(BatchVertex), renderer->batchVertices);
+    CountBufferUpload(renderer->batchQuadCount * 4 * sizeof(BatchVertex));
+
+    for (uint32_t i = 0; i < renderer->batchTextureCount; i++) {
+        Texture* texture = PoolGet(&texturePool, renderer->batchTextures[i]);
+
+        // a texture destroyed mid-batch samples as unbound instead of touching a dead id
+        StateBindTexture(i, texture != NULL ? texture->id : 0);
+    }
+
+    StateUseProgram(((Shader*)PoolGet(&shaderPool, renderer->batchShader))->id);
+    StateBindVertexArray(renderer->batchVao);
+    glDrawElements(GL_TRIANGLES, renderer->batchQuadCount * 6, GL_UNSIGNED_INT, 0);
+    CountDraw(renderer->batchQuadCount * 2, 0);
+
+    renderer->batchQuadCount = 0;
+    renderer->batchTextureCount = 0;
+}
+
+GL2D_API void GL2D_BeginBatch(GL2D_Renderer renderer, GL2D_Matrix4f projection) {
+    if (renderer->batchActive) {
+        fprintf(stderr, "ERROR: GL2D_BeginBatch called twice without GL2D_EndBatch\n");
+        return;
+    }
+
+    renderer->batchActive = true;
+    renderer->batchSerial++;
+    renderer->batchQuadCount = 0;
+    renderer->batchTextureCount = 0;
+    renderer->projection = projection;
+
+    if (renderer->software != NULL) {
+        return;
+    }
+
+    // quads may be mirrored by negative scales, so they are never culled
+    StateEnable(GL_CULL_FACE, false);
+
+    GL2D_BindShader(renderer->batchShader);
+    GL2D_ShaderSetUniformMat4(renderer->batchShader, renderer->batchProjection, projection);
+}
+
+GL2D_API void GL2D_DrawQuad(GL2D_Renderer renderer, GL2D_Transform transform, GL2D_Texture texture, GL2D_Color color) {
+    GL2D_DrawQuadAffine(renderer, GL2D_TransformToAffine(transform), texture, color);
+}
+
+GL2D_API void GL2D_DrawQuadAffine(GL2D_Renderer renderer, GL2D_Affine2D affine, GL2D_Texture texture, GL2D_Color color) {
+    GL2D_DrawQuadAffineUV(renderer, affine, texture, (GL2D_Rectf) { 0, 0, 1, 1 }, color);
+}
+
+GL2D_API void GL2D_DrawQuadUV(GL2D_Renderer renderer, GL2D_Transform transform, GL2D_Texture texture, GL2D_Rectf uv, GL2D_Color color) {
+    GL2D_DrawQuadAffineUV(renderer, GL2D_TransformToAffine(transform), texture, uv, color);
+}
+
+GL2D_API void GL2D_DrawSprite(GL2D_Renderer renderer, GL2D_Transform transform, GL2D_TextureAtlas atlas, GL2D_AtlasRegion region, GL2D_Color color) {
+    GL2D_AtlasSprite sprite = GL2D_AtlasGetSprite(atlas, region);
+
+    if (sprite.texture == GL2D_INVALID_HANDLE) {
+        return;
+    }
+
+    GL2D_DrawQuadAffineUV(renderer, GL2D_TransformToAffine(transform), sprite.texture, sprite.uv, color);
+}
+
+// the unit quad is centered on the origin, so each corner is the translation +/- half of each axis
+static void QuadCorners(const GL2D_Affine2D* affine, GL2D_Rectf uv, float positions[4][2], float texCoords[4][2]) {
+    float halfX[2] = { affine->data[0][0] * 0.5f, affine->data[0][1] * 0.5f };
+    float halfY[2] = { affine->data[1][0] * 0.5f, affine->data[1][1] * 0.5f };
+
+    positions[0][0] = affine->data[2][0] - halfX[0] - halfY[0];
+    positions[0][1] = affine->data[2][1] - halfX[1] - halfY[1];
+    positions[1][0] = affine->data[2][0] - halfX[0] + halfY[0];
+    positions[1][1] = affine->data[2][1] - halfX[1] + halfY[1];
+    positions[2][0] = affine->data[2][0] + halfX[0] + halfY[0];
+    positions[2][1] = affine->data[2][1] + halfX[1] + halfY[1];
+    positions[3][0] = affine->data[2][0] + halfX[0] - halfY[0];
+    positions[3][1] = affine->data[2][1] + halfX[1] - halfY[1];
+
+    texCoords[0][0] = uv.x;
+    texCoords[0][1] = uv.y;
+    texCoords[1][0] = uv.x;
+    texCoords[1][1] = uv.y + uv.height;
+    texCoords[2][0] = uv.x + uv.width;
+    texCoords[2][1] = uv.y + uv.height;
+    texCoords[3][0] = uv.x + uv.width;
+    texCoords[3][1] = uv.y;
+}
+
+// may flush the batch when every texture slot is taken
+static uint32_t BatchTextureIndex(GL2D_Renderer renderer, GL2D_Texture texture) {
+    uint32_t texIndex = 0;
+
+    while (texIndex < renderer->batchTextureCount && renderer->batchTextures[texIndex] != texture) {
+        texIndex++;
+    }
+
+    if (texIndex == renderer->batchTextureCount) {
+        if (renderer->batchTextureCount == renderer->batchMaxTextures) {
+            FlushBatch(renderer);
+            texIndex = 0;
+        }
+
+        renderer->batchTextures[renderer->batchTextureCount++] = texture;
+    }
+
+    return texIndex;
+}
+
+GL2D_API void GL2D_DrawQuadAffineUV(GL2D_Renderer renderer, GL2D_Affine2D affine, GL2D_Texture texture, GL2D_Rectf uv, GL2D_Color color) {
+    if (!renderer->batchActive) {
+        fprintf(stderr, "ERROR: GL2D_DrawQuad called outside of GL2D_BeginBatch/GL2D_EndBatch\n");
+        return;
+    }
+
+    if (renderer->software != NULL) {
+        SoftwareAddQuad(renderer, &affine, texture, uv, color);
+        return;
+    }
+
+    if (renderer->batchQuadCount == GL2D_BATCH_MAX_QUADS) {
+        FlushBatch(renderer);
+    }
+
+    uint32_t texIndex = BatchTextureIndex(renderer, texture != GL2D_INVALID_HANDLE ? texture : renderer->whiteTexture);
+
+    float positions[4][2];
+    float texCoords[4][2];
+    QuadCorners(&affine, uv, positions, texCoords);
+
+    BatchVertex* vertex = &renderer->batchVertices[renderer->batchQuadCount * 4];
+
+    for (uint32_t i = 0; i < 4; i++, vertex++) {
+        vertex->position[0] = positions[i][0];
+        vertex->position[1] = positions[i][1];
+        vertex->texCoord[0] = texCoords[i][0];
+        vertex->texCoord[1] = texCoords[i][1];
+        vertex->color = color;
+        vertex->texIndex = (uint8_t)texIndex;
+    }
+
+    renderer->batchQuadCount++;
+}
+
+GL2D_API void GL2D_DrawInstanced(GL2D_Renderer renderer, GL2D_Texture texture, const GL2D_SpriteInstance* instances, uint32_t count) {
+    GL2D_DrawInstancedWithShader(renderer, renderer->instanceShader, texture, instances, count);
+}
+
+// Custom shaders get the same attribute locations as the built-in one (see instanceVertexSource),
+// a "projection" uniform and the texture on unit 0.
+GL2D_API void GL2D_DrawInstancedWithShader(GL2D_Renderer renderer, GL2D_Shader shader, GL2D_Texture texture, const GL2D_SpriteInstance* instances, uint32_t count) {
+    if (!renderer->batchActive) {
+        fprintf(stderr, "ERROR: GL2D_DrawInstanced called outside of GL2D_BeginBatch/GL2D_EndBatch\n");
+        return;
+    }
+
+    // no shaders on the software backend, instances become plain quads of the built-in look
+    if (renderer->software != NULL) {
+        for (uint32_t i = 0; i < count; i++) {
+            SoftwareAddQuad(renderer, &instances[i].transform, texture, instances[i].uv, instances[i].color);
+        }
+
+        return;
+    }
+
+    if (count == 0 || GetShader(shader) == NULL) {
+        return;
+    }
+
+    // quads already in the batch were submitted first and have to stay underneath
+    FlushBatch(renderer);
+
+    Texture* bound = PoolGet(&texturePool, texture);
+
+    if (bound == NULL) {
+        bound = PoolGet(&texturePool, renderer->whiteTexture);
+    }
+
+    GL2D_Uniform projection = shader == renderer->instanceShader ? renderer->instanceProjection : GL2D_ShaderGetUniform(shader, "projection");
+
+    GL2D_BindShader(shader);
+    GL2D_ShaderSetUniformMat4(shader, projection, renderer->projection);
+    StateBindTexture(0, bound->id);
+    StateBindVertexArray(renderer->instanceVao);
+
+    for (uint32_t first = 0; first < count; first += GL2D_INSTANCES_PER_DRAW) {
+        uint32_t chunk = count - first < GL2D_INSTANCES_PER_DRAW ? count - first : GL2D_INSTANCES_PER_DRAW;
+        uint64_t offset;
+
+        if (!GL2D_StreamBufferWrite(renderer->instanceStream, instances + first, chunk * sizeof(GL2D_SpriteInstance), 16, &offset)) {
+            return;
+        }
+
+        // no base instance in 3.3, so the pointers are moved to each chunk's range instead
+        GL2D_BindStreamBuffer(renderer->instanceStream);
+        glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(GL2D_SpriteInstance), (void*)(uintptr_t)(offset + offsetof(GL2D_SpriteInstance, transform)));
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(GL2D_SpriteInstance), (void*)(uintptr_t)(offset + offsetof(GL2D_SpriteInstance, transform) + 4 * sizeof(float)));
+        glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(GL2D_SpriteInstance), (void*)(uintptr_t)(offset + offsetof(GL2D_SpriteInstance, uv)));
+        glVertexAttribPointer(4, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(GL2D_SpriteInstance), (void*)(uintptr_t)(offset + offsetof(GL2D_SpriteInstance, color)));
+        glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, chunk);
+        CountDraw(chunk * 2, chunk);
+    }
+}
+
+GL2D_API void GL2D_EndBatch(GL2D_Renderer renderer) {
+    if (!renderer->batchActive) {
+        return;
+    }
+
+    if (renderer->software != NULL) {
+        SoftwareFlush(renderer);
+        ReleaseBatchFonts(renderer);
+        renderer->batchActive = false;
+        return;
+    }
+
+    FlushBatch(renderer);
+    ReleaseBatchFonts(renderer);
+
+    StateEnable(GL_CULL_FACE, true);
+    renderer->batchActive = false;
+}
+
+// Primitives are tessellated on the CPU into quads of the shared batch, so they go out in the
+// same draws as the sprites around them. Fans fold into quads as well: the fan triangles 0 i i+1
+// and 0 i+1 i+2 are exactly the quad 0 i i+1 i+2, a lone last triangle repeats its corner.
+// Curves get as many segments as keep them within PRIMITIVE_TOLERANCE pixels of the true shape
+// under the batch projection. Circles and rounded rects are cached by their parameters in a
+// direct mapped table, relative to their position, so drawing one again is a copy into the batch.
+// Polylines and polygons are their points, hashing those would cost as much as tessellating them.
+#define PRIMITIVE_CACHE_SIZE 256
+#define PRIMITIVE_TOLERANCE 0.25f
+#define PRIMITIVE_MIN_SEGMENTS 8
+#define PRIMITIVE_MAX_SEGMENTS 512
+#define PRIMITIVE_MITER_LIMIT 4.0f
+
+enum {
+    PRIMITIVE_CIRCLE = 1,
+    PRIMITIVE_CIRCLE_OUTLINE,
+    PRIMITIVE_ROUNDED_RECT,
+    PRIMITIVE_ROUNDED_RECT_OUTLINE,
+};
+
+typedef struct PrimitiveKey {
+    uint32_t kind;
+    uint32_t segments;
+    float width;
+    float height;
+    float radius;
+    float thickness;
+} PrimitiveKey;
+
+typedef struct PrimitiveMesh {
+    GL2D_Vector2f* corners;
+    uint32_t quadCount;
+    uint32_t quadCapacity;
+} PrimitiveMesh;
+
+typedef struct PrimitiveShape {
+    PrimitiveKey key;
+    PrimitiveMesh mesh;
+} PrimitiveShape;
+
+typedef struct PrimitiveCache {
+    PrimitiveShape shapes[PRIMITIVE_CACHE_SIZE];
+    PrimitiveMesh transient;
+    GL2D_Vector2f* path;
+    uint32_t pathCapacity;
+} PrimitiveCache;
+
+static void FreePrimitives(GL2D_Renderer renderer) {
+    PrimitiveCache* cache = renderer->primitives;
+
+    if (cache == NULL) {
+        return;
+    }
+
+    for (uint32_t i = 0; i < PRIMITIVE_CACHE_SIZE; i++) {
+        MemFree(cache->shapes[i].mesh.corners);
+    }
+
+    MemFree(cache->transient.corners);
+    MemFree(cache->path);
+    MemFree(cache);
+    renderer->primitives = NULL;
+}
+
+static bool PrimitiveCanDraw(GL2D_Renderer renderer, const char* function) {
+    if (!renderer->batchActive) {
+        fprintf(stderr, "ERROR: %s called outside of GL2D_BeginBatch/GL2D_EndBatch\n", function);
+        return false;
+    }
+
+    if (renderer->primitives == NULL) {
+        renderer->primitives = MemCalloc(1, sizeof(PrimitiveCache));
+
+        if (renderer->primitives == NULL) {
+            fprintf(stderr, "ERROR: Couldn't allocate primitive cache\n");
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Pixels per world unit along the world axis the projection stretches the most
+static float PrimitivePixelScale(GL2D_Renderer renderer) {
+    const GL2D_Matrix4f* m = &renderer->projection;
+    GL2D_Rect viewport = renderer->software != NULL ? SoftwareGetViewport(renderer) : renderer->viewport;
+    float axisX = hypotf(m->data[0][0] * viewport.z, m->data[0][1] * viewport.w);
+    float axisY = hypotf(m->data[1][0] * viewport.z, m->data[1][1] * viewport.w);
+
+    return fmaxf(axisX, axisY) * 0.5f;
+}
+
+// A multiple of four, so rounded rect corners get a quarter each
+static uint32_t CircleSegments(float pixelRadius) {
+    if (!(pixelRadius > PRIMITIVE_TOLERANCE)) {
+        return PRIMITIVE_MIN_SEGMENTS;
+    }
+
+    // each chord may cut PRIMITIVE_TOLERANCE pixels into the arc it replaces
+    float segments = ceilf((float)PI / acosf(1 - PRIMITIVE_TOLERANCE / pixelRadius));
+    segments = fminf(fmaxf(segments, PRIMITIVE_MIN_SEGMENTS), PRIMITIVE_MAX_SEGMENTS);
+
+    return ((uint32_t)segments + 3) & ~3u;
+}
+
+static bool PrimitiveMeshReserve(PrimitiveMesh* mesh, uint32_t quadCount) {
+    mesh->quadCount = 0;
+
+    if (quadCount > mesh->quadCapacity) {
+        GL2D_Vector2f* corners = MemRealloc(mesh->corners, quadCount * 4 * sizeof(GL2D_Vector2f));
+
+        if (corners == NULL) {
+            fprintf(stderr, "ERROR: Couldn't allocate %u primitive quads\n", quadCount);
+            return false;
+        }
+
+        mesh->corners = corners;
+        mesh->quadCapacity = quadCount;
+    }
+
+    return true;
+}
+
+static void PrimitiveMeshAdd(PrimitiveMesh* mesh, GL2D_Vector2f a, GL2D_Vector2f b, GL2D_Vector2f c, GL2D_Vector2f d) {
+    GL2D_Vector2f* corner = &mesh->corners[mesh->quadCount++ * 4];
+
+    corner[0] = a;
+    corner[1] = b;
+    corner[2] = c;
+    corner[3] = d;
+}
+
+static GL2D_Vector2f* PrimitivePath(PrimitiveCache* cache, uint32_t count) {
+    if (count > cache->pathCapacity) {
+        GL2D_Vector2f* path = MemRealloc(cache->path, count * sizeof(GL2D_Vector2f));
+
+        if (path == NULL) {
+            fprintf(stderr, "ERROR: Couldn't allocate primitive path of %u points\n", count);
+            return NULL;
+        }
+
+        cache->path = path;
+        cache->pathCapacity = count;
+    }
+
+    return cache->path;
+}
+
+static bool FillConvex(PrimitiveMesh* mesh, const GL2D_Vector2f* points, uint32_t count) {
+    if (!PrimitiveMeshReserve(mesh, count >= 3 ? (count - 1) / 2 : 0)) {
+        return false;
+    }
+
+    for (uint32_t i = 1; i + 1 < count; i += 2) {
+        PrimitiveMeshAdd(mesh, points[0], points[i], points[i + 1], points[i + 2 < count ? i + 2 : i + 1]);
+    }
+
+    return true;
+}
+
+// Joins two closed loops of the same length point by point
+static bool FillBetweenLoops(PrimitiveMesh* mesh, const GL2D_Vector2f* outer, const GL2D_Vector2f* inner, uint32_t count) {
+    if (!PrimitiveMeshReserve(mesh, count)) {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t next = i + 1 < count ? i + 1 : 0;
+        PrimitiveMeshAdd(mesh, outer[i], outer[next], inner[next], inner[i]);
+    }
+
+    return true;
+}
+
+static void CirclePath(GL2D_Vector2f* path, uint32_t segments, float radius) {
+    for (uint32_t i = 0; i < segments; i++) {
+        float sine;
+        float cosine;
+
+        SinCos(2 * (float)PI * i / segments, &sine, &cosine);
+        path[i] = (GL2D_Vector2f) { cosine * radius, sine * radius };
+    }
+}
+
+// Walks the corners clockwise on screen from the top left, each arc centered radius in from its
+// corner. Sharp corners, or offsets reaching past the arc center, put every point of the corner
+// on its diagonal instead, which keeps the loops of an outline the same length.
+static void RoundedRectPath(GL2D_Vector2f* path, const PrimitiveKey* key, float offset) {
+    const float centers[4][2] = {
+        { key->radius, key->radius },
+        { key->width - key->radius, key->radius },
+        { key->width - key->radius, key->height - key->radius },
+        { key->radius, key->height - key->radius },
+    };
+    const float diagonals[4][2] = { { -1, -1 }, { 1, -1 }, { 1, 1 }, { -1, 1 } };
+
+    for (uint32_t corner = 0; corner < 4; corner++) {
+        for (uint32_t i = 0; i <= key->segments; i++) {
+            float directionX = diagonals[corner][0];
+            float directionY = diagonals[corner][1];
+
+            if (key->radius > 0 && offset >= 0) {
+                SinCos((float)PI * (1 + 0.5f * corner + 0.5f * i / key->segments), &directionY, &directionX);
+            }
+
+            *path++ = (GL2D_Vector2f) { centers[corner][0] + directionX * offset, centers[corner][1] + directionY * offset };
+        }
+    }
+}
+
+static bool TessellatePrimitive(PrimitiveCache* cache, const PrimitiveKey* key, PrimitiveMesh* mesh) {
+    uint32_t count = key->kind == PRIMITIVE_CIRCLE || key->kind == PRIMITIVE_CIRCLE_OUTLINE ? key->segments : 4 * (key->segments + 1);
+    GL2D_Vector2f* path = PrimitivePath(cache, count * 2);
+    float halfThickness = key->thickness * 0.5f;
+
+    if (path == NULL) {
+        return false;
+    }
+
+    switch (key->kind) {
+        case PRIMITIVE_CIRCLE:
+            CirclePath(path, count, key->radius);
+            return FillConvex(mesh, path, count);
+        case PRIMITIVE_CIRCLE_OUTLINE:
+            CirclePath(path, count, key->radius + halfThickness);
+            CirclePath(path + count, count, fmaxf(key->radius - halfThickness, 0));
+            return FillBetweenLoops(mesh, path, path + count, count);
+        case PRIMITIVE_ROUNDED_RECT:
+            RoundedRectPath(path, key, key->radius);
+            return FillConvex(mesh, path, count);
+        default:
+            RoundedRectPath(path, key, key->radius + halfThickness);
+            RoundedRectPath(path + count, key, key->radius - halfThickness);
+            return FillBetweenLoops(mesh, path, path + count, count);
+    }
+}
+
+static const PrimitiveMesh* GetPrimitiveMesh(GL2D_Renderer renderer, const PrimitiveKey* key) {
+    PrimitiveCache* cache = renderer->primitives;
+    PrimitiveShape* shape = &cache->shapes[HashBytes(key, sizeof(PrimitiveKey)) % PRIMITIVE_CACHE_SIZE];
+
+    if (memcmp(&shape->key, key, sizeof(PrimitiveKey)) == 0) {
+        return &shape->mesh;
+    }
+
+    // cleared first, a failed tessellation must not leave the slot matching the new key
+    memset(&shape->key, 0, sizeof(PrimitiveKey));
+
+    if (!TessellatePrimitive(cache, key, &shape->mesh)) {
+        return NULL;
+    }
+
+    shape->key = *key;
+
+    return &shape->mesh;
+}
+
+static void EmitPrimitive(GL2D_Renderer renderer, const PrimitiveMesh* mesh, GL2D_Vector2f offset, GL2D_Color color) {
+    const GL2D_Vector2f* corners = mesh->corners;
+    uint32_t quadCount = mesh->quadCount;
+
+    if (renderer->software != NULL) {
+        const float texCoords[4][2] = { { 0 } };
+
+        for (uint32_t i = 0; i < quadCount; i++, corners += 4) {
+            const float positions[4][2] = {
+                { corners[0].x + offset.x, corners[0].y + offset.y },
+                { corners[1].x + offset.x, corners[1].y + offset.y },
+                { corners[2].x + offset.x, corners[2].y + offset.y },
+                { corners[3].x + offset.x, corners[3].y + offset.y },
+            };
+
+            SoftwareAddCorners(renderer, positions, texCoords, renderer->whiteTexture, color);
+        }
+
+        return;
+    }
+
+    while (quadCount > 0) {
+        if (renderer->batchQuadCount == GL2D_BATCH_MAX_QUADS) {
+            FlushBatch(renderer);
+        }
+
+        uint32_t texIndex = BatchTextureIndex(renderer, renderer->whiteTexture);
+        uint32_t room = GL2D_BATCH_MAX_QUADS - renderer->batchQuadCount;
+        uint32_t count = quadCount < room ? quadCount : room;
+        BatchVertex* vertex = &renderer->batchVertices[renderer->batchQuadCount * 4];
+
+        for (uint32_t i = 0; i < count * 4; i++, vertex++) {
+            vertex->position[0] = corners[i].x + offset.x;
+            vertex->position[1] = corners[i].y + offset.y;
+            vertex->texCoord[0] = 0;
+            vertex->texCoord[1] = 0;
+            vertex->color = color;
+            vertex->texIndex = (uint8_t)texIndex;
+        }
+
+        renderer->batchQuadCount += count;
+        corners += count * 4;
+        quadCount -= count;
+    }
+}
+
+GL2D_API void GL2D_DrawLine(GL2D_Renderer renderer, GL2D_Vector2f from, GL2D_Vector2f to, float thickness, GL2D_Color color) {
+    if (!PrimitiveCanDraw(renderer, "GL2D_DrawLine")) {
+        return;
+    }
+
+    float length = hypotf(to.x - from.x, to.y - from.y);
+
+    if (length == 0) {
+        return;
+    }
+
+    float normalX = (from.y - to.y) / length * thickness * 0.5f;
+    float normalY = (to.x - from.x) / length * thickness * 0.5f;
+    GL2D_Vector2f corners[4] = {
+        { from.x + normalX, from.y + normalY },
+        { to.x + normalX, to.y + normalY },
+        { to.x - normalX, to.y - normalY },
+        { from.x - normalX, from.y - normalY },
+    };
+    PrimitiveMesh mesh = { corners, 1, 1 };
+
+    EmitPrimitive(renderer, &mesh, (GL2D_Vector2f) { 0, 0 }, color);
+}
+
+typedef struct StrokeJoin {
+    GL2D_Vector2f inLeft;
+    GL2D_Vector2f inRight;
+    GL2D_Vector2f outLeft;
+    GL2D_Vector2f outRight;
+    bool bevel;
+    bool bevelLeft;
+} StrokeJoin;
+
+// Miters the corner at points[i] unless it is sharper than PRIMITIVE_MITER_LIMIT allows, then the
+// segments keep square ends and a bevel triangle closes the gap on the outside of the turn.
+static StrokeJoin GetStrokeJoin(const GL2D_Vector2f* points, uint32_t count, uint32_t i, bool closed, float halfThickness) {
+    GL2D_Vector2f point = points[i];
+    bool hasIn = closed || i > 0;
+    bool hasOut = closed || i + 1 < count;
+    GL2D_Vector2f previous = points[hasIn ? (i > 0 ? i - 1 : count - 1) : i];
+    GL2D_Vector2f next = points[hasOut ? (i + 1 < count ? i + 1 : 0) : i];
+    float inLength = hypotf(point.x - previous.x, point.y - previous.y);
+    float outLength = hypotf(next.x - point.x, next.y - point.y);
+    StrokeJoin join = { 0 };
+
+    // the left normal of each direction, an open end borrows the one of its only segment
+    GL2D_Vector2f inNormal = { 0, 0 };
+    GL2D_Vector2f outNormal = { 0, 0 };
+
+    if (hasIn) {
+        inNormal = (GL2D_Vector2f) { (previous.y - point.y) / inLength, (point.x - previous.x) / inLength };
+    }
+
+    if (hasOut) {
+        outNormal = (GL2D_Vector2f) { (point.y - next.y) / outLength, (next.x - point.x) / outLength };
+    }
+
+    if (!hasIn) {
+        inNormal = outNormal;
+    }
+
+    if (!hasOut) {
+        outNormal = inNormal;
+    }
+
+    float miterX = inNormal.x + outNormal.x;
+    float miterY = inNormal.y + outNormal.y;
+    float miterLength = hypotf(miterX, miterY);
+    float cosine = miterLength > 0 ? (miterX * outNormal.x + miterY * outNormal.y) / miterLength : 0;
+
+    if (cosine > 1.0f / PRIMITIVE_MITER_LIMIT) {
+        float scale = halfThickness / (cosine * miterLength);
+
+        join.inLeft = join.outLeft = (GL2D_Vector2f) { point.x + miterX * scale, point.y + miterY * scale };
+        join.inRight = join.outRight = (GL2D_Vector2f) { point.x - miterX * scale, point.y - miterY * scale };
+
+        return join;
+    }
+
+    join.inLeft = (GL2D_Vector2f) { point.x + inNormal.x * halfThickness, point.y + inNormal.y * halfThickness };
+    join.inRight = (GL2D_Vector2f) { point.x - inNormal.x * halfThickness, point.y - inNormal.y * halfThickness };
+    join.outLeft = (GL2D_Vector2f) { point.x + outNormal.x * halfThickness, point.y + outNormal.y * halfThickness };
+    join.outRight = (GL2D_Vector2f) { point.x - outNormal.x * halfThickness, point.y - outNormal.y * halfThickness };
+    join.bevel = true;
+
+    // turning towards the left normal leaves the gap on the right
+    join.bevelLeft = inNormal.x * outNormal.y - inNormal.y * outNormal.x < 0;
+
+    return join;
+}
+
+GL2D_API void GL2D_DrawPolyline(GL2D_Renderer renderer, const GL2D_Vector2f* points, uint32_t count, float thickness, bool closed, GL2D_Color color) {
+    if (!PrimitiveCanDraw(renderer, "GL2D_DrawPolyline")) {
+        return;
+    }
+
+    PrimitiveCache* cache = renderer->primitives;
+    GL2D_Vector2f* path = PrimitivePath(cache, count);
+
+    if (path == NULL) {
+        return;
+    }
+
+    // repeated points have no direction to offset along
+    uint32_t unique = 0;
+
+    for (uint32_t i = 0; i < count; i++) {
+        if (unique == 0 || points[i].x != path[unique - 1].x || points[i].y != path[unique - 1].y) {
+            path[unique++] = points[i];
+        }
+    }
+
+    if (closed && unique > 1 && path[0].x == path[unique - 1].x && path[0].y == path[unique - 1].y) {
+        unique--;
+    }
+
+    closed = closed && unique > 2;
+
+    uint32_t segments = closed ? unique : unique - 1;
+
+    if (unique < 2 || !PrimitiveMeshReserve(&cache->transient, segments + unique)) {
+        return;
+    }
+
+    float halfThickness = thickness * 0.5f;
+    StrokeJoin first = GetStrokeJoin(path, unique, 0, closed, halfThickness);
+    StrokeJoin join = first;
+
+    for (uint32_t i = 0; i < segments; i++) {
+        uint32_t end = i + 1 < unique ? i + 1 : 0;
+        StrokeJoin next = end == 0 ? first : GetStrokeJoin(path, unique, end, closed, halfThickness);
+
+        PrimitiveMeshAdd(&cache->transient, join.outLeft, next.inLeft, next.inRight, join.outRight);
+
+        if (next.bevel) {
+            GL2D_Vector2f from = next.bevelLeft ? next.inLeft : next.inRight;
+            GL2D_Vector2f to = next.bevelLeft ? next.outLeft : next.outRight;
+
+            PrimitiveMeshAdd(&cache->transient, path[end], from, to, to);
+        }
+
+        join = next;
+    }
+
+    EmitPrimitive(renderer, &cache->transient, (GL2D_Vector2f) { 0, 0 }, color);
+}
+
+GL2D_API void GL2D_DrawConvexPolygon(GL2D_Renderer renderer, const GL2D_Vector2f* points, uint32_t count, GL2D_Color color) {
+    if (!PrimitiveCanDraw(renderer, "GL2D_DrawConvexPolygon")) {
+        return;
+    }
+
+    if (FillConvex(&renderer->primitives->transient, points, count)) {
+        EmitPrimitive(renderer, &renderer->primitives->transient, (GL2D_Vector2f) { 0, 0 }, color);
+    }
+}
+
+GL2D_API void GL2D_DrawCircle(GL2D_Renderer renderer, GL2D_Vector2f center, float radius, GL2D_Color color) {
+    if (!PrimitiveCanDraw(renderer, "GL2D_DrawCircle") || !(radius > 0)) {
+        return;
+    }
+
+    PrimitiveKey key = { PRIMITIVE_CIRCLE, CircleSegments(radius * PrimitivePixelScale(renderer)), 0, 0, radius, 0 };
+    const PrimitiveMesh* mesh = GetPrimitiveMesh(renderer, &key);
+
+    if (mesh != NULL) {
+        EmitPrimitive(renderer, mesh, center, color);
+    }
+}
+
+// The outline is centered on radius, thickness / 2 to either side.
+GL2D_API void GL2D_DrawCircleOutline(GL2D_Renderer renderer, GL2D_Vector2f center, float radius, float thickness, GL2D_Color color) {
+    if (!PrimitiveCanDraw(renderer, "GL2D_DrawCircleOutline") || !(radius > 0) || !(thickness > 0)) {
+        return;
+    }
+
+    PrimitiveKey key = { PRIMITIVE_CIRCLE_OUTLINE, CircleSegments((radius + thickness * 0.5f) * PrimitivePixelScale(renderer)), 0, 0, radius, thickness };
+    const PrimitiveMesh* mesh = GetPrimitiveMesh(renderer, &key);
+
+    if (mesh != NULL) {
+        EmitPrimitive(renderer, mesh, center, color);
+    }
+}
+
+static void DrawRoundedRect(GL2D_Renderer renderer, uint32_t kind, GL2D_Rectf rect, float radius, float thickness, GL2D_Color color) {
+    if (!(rect.width > 0) || !(rect.height > 0)) {
+        return;
+    }
+
+    radius = fminf(fmaxf(radius, 0), fminf(rect.width, rect.height) * 0.5f);
+
+    float pixelRadius = (radius + thickness * 0.5f) * PrimitivePixelScale(renderer);
+    PrimitiveKey key = { kind, radius > 0 ? CircleSegments(pixelRadius) / 4 : 0, rect.width, rect.height, radius, thickness };
+    const PrimitiveMesh* mesh = GetPrimitiveMesh(renderer, &key);
+
+    if (mesh != NULL) {
+        EmitPrimitive(renderer, mesh, (GL2D_Vector2f) { rect.x, rect.y }, color);
+    }
+}
+
+// The rect is its top left corner and size, the radius is clamped to half the shorter side.
+GL2D_API void GL2D_DrawRoundedRect(GL2D_Renderer renderer, GL2D_Rectf rect, float radius, GL2D_Color color) {
+    if (PrimitiveCanDraw(renderer, "GL2D_DrawRoundedRect")) {
+        DrawRoundedRect(renderer, PRIMITIVE_ROUNDED_RECT, rect, radius, 0, color);
+    }
+}
+
+GL2D_API void GL2D_DrawRoundedRectOutline(GL2D_Renderer renderer, GL2D_Rectf rect, float radius, float thickness, GL2D_Color color) {
+    if (PrimitiveCanDraw(renderer, "GL2D_DrawRoundedRectOutline") && thickness > 0) {
+        DrawRoundedRect(renderer, PRIMITIVE_ROUNDED_RECT_OUTLINE, rect, radius, thickness, color);
+    }
+}
+
+// Fonts rasterize glyphs on first use into equal cells of one atlas texture sized for the font's
+// largest glyph, so the cache can drop any glyph for any other. The least recently used glyph goes
+// first, but never one drawn since the current batch began: the software backend samples the
+// atlas only at GL2D_EndBatch. Glyphs are white with coverage, or distance for SDF fonts, in alpha.
+// Pixel projections with y pointing down are assumed, text grows down and to the right.
+#define FONT_DEFAULT_ATLAS_SIZE 1024
+#define FONT_SDF_PADDING 4
+#define FONT_SDF_ON_EDGE 128
+#define FONT_RUN_CACHE_SIZE 256
+#define FONT_NO_CELL UINT32_MAX
+
+static const char* textFragmentSource = "#version 330 core\n"
+"out vec4 FragColor;\n"
+"in vec4 ourColor;\n"
+"in vec2 TexCoord;\n"
+"uniform sampler2D tex;\n"
+"void main() {\n"
+"    float distance = texture(tex, TexCoord).a;\n"
+"    float width = max(fwidth(distance) * 0.75, 0.0001);\n"
+"    FragColor = vec4(ourColor.rgb, ourColor.a * smoothstep(0.5 - width, 0.5 + width, distance));\n"
+"}";
+
+typedef struct FontGlyph {
+    uint32_t codepoint;
+    int32_t glyph;
+    float offsetX;
+    float offsetY;
+    float width;
+    float height;
+    float advance;
+    uint64_t lastUse;
+    uint32_t next;
+} FontGlyph;
+
+typedef struct RunGlyph {
+    float x;
+    float y;
+    uint32_t cell;
+} RunGlyph;
+
+// Layouts of recently drawn strings, a label that doesn't change is hashed and compared instead of
+// being laid out again. A run stays valid until the cache evicts any glyph.
+typedef struct TextRun {
+    uint64_t hash;
+    char* text;
+    uint32_t length;
+    uint32_t textCapacity;
+    RunGlyph* glyphs;
+    uint32_t glyphCount;
+    uint32_t glyphCapacity;
+    GL2D_Vector2f size;
+    uint32_t generation;
+    bool valid;
+    bool complete;
+} TextRun;
+
+struct GL2D_Font {
+    stbtt_fontinfo info;
+    uint8_t* data;
+    float pixelHeight;
+    float scale;
+    float ascent;
+    float lineHeight;
+    bool sdf;
+    GL2D_Texture texture;
+    uint32_t atlasSize;
+    uint32_t cellWidth;
+    uint32_t cellHeight;
+    uint32_t columns;
+    FontGlyph* cells;
+    uint32_t cellCount;
+    uint32_t usedCells;
+    uint32_t* buckets;
+    uint32_t bucketMask;
+    uint8_t* scratch;
+    uint64_t useClock;
+    uint64_t batchFirstUse;
+    uint32_t batchSerial;
+    uint32_t generation;
+    TextRun runs[FONT_RUN_CACHE_SIZE];
+};
+
+GL2D_API GL2D_Font GL2D_CreateFontFromMemory(const uint8_t* data, uint64_t size, const GL2D_FontDesc* desc) {
+    GL2D_Font font = MemAlloc(sizeof(struct GL2D_Font));
+
+    if (font == NULL) {
+        fprintf(stderr, "ERROR: Couldn't allocate font\n");
+        return NULL;
+    }
+
+    memset(font, 0, sizeof(struct GL2D_Font));
+
+    // nothing is protected from eviction until GL2D_DrawText starts a batch's use of the font
+    font->batchFirstUse = UINT64_MAX;
+
+    // stb_truetype reads the file on every lookup, the font keeps its own copy
+    font->data = MemAlloc(size);
+
+    if (font->data == NULL) {
+        fprintf(stderr, "ERROR: Couldn't allocate font\n");
+        MemFree(font);
+        return NULL;
+    }
+
+    memcpy(font->data, data, size);
+
+    int offset = stbtt_GetFontOffsetForIndex(font->data, 0);
+
+    if (offset < 0 || !stbtt_InitFont(&font->info, font->data, offset)) {
+        fprintf(stderr, "ERROR: Couldn't parse font\n");
+        GL2D_DestroyFont(font);
+        return NULL;
+    }
+
+    int ascent, descent, lineGap, x0, y0, x1, y1;
+    stbtt_GetFontVMetrics(&font->info, &ascent, &descent, &lineGap);
+    stbtt_GetFontBoundingBox(&font->info, &x0, &y0, &x1, &y1);
+
+    // no shaders on the software backend, distance fields would show up as blurred glyphs
+    font->sdf = desc->sdf && !SoftwareActive();
+    font->pixelHeight = desc->pixelHeight > 0 ? desc->pixelHeight : 32;
+    font->scale = stbtt_ScaleForPixelHeight(&font->info, font->pixelHeight);
+    font->ascent = ascent * font->scale;
+    font->lineHeight = (ascent - descent + lineGap) * font->scale;
+    font->atlasSize = desc->atlasSize > 0 ? desc->atlasSize : FONT_DEFAULT_ATLAS_SIZE;
+
+    // a texel of empty border on each side keeps filtering from reaching into the next cell
+    uint32_t padding = font->sdf ? FONT_SDF_PADDING + 1 : 1;
+    font->cellWidth = (uint32_t)ceilf((x1 - x0) * font->scale) + 2 + padding * 2;
+    font->cellHeight = (uint32_t)ceilf((y1 - y0) * font->scale) + 2 + padding * 2;
+    font->columns = font->atlasSize / font->cellWidth;
+    font->cellCount = font->columns * (font->atlasSize / font->cellHeight);
+
+    if (font->cellCount == 0) {
+        fprintf(stderr, "ERROR: %.0f pixel glyphs don't fit a %u pixel font atlas\n", font->pixelHeight, font->atlasSize);
+        GL2D_DestroyFont(font);
+        return NULL;
+    }
+
+    uint32_t bucketCount = 1;
+
+    while (bucketCount < font->cellCount * 2) {
+        bucketCount *= 2;
+    }
+
+    font->bucketMask = bucketCount - 1;
+    font->cells = MemCalloc(font->cellCount, sizeof(FontGlyph));
+    font->buckets = MemAlloc(bucketCount * sizeof(uint32_t));
+    font->scratch = MemAlloc((uint64_t)font->cellWidth * font->cellHeight * 4);
+
+    uint8_t* clear = MemCalloc((uint64_t)font->atlasSize * font->atlasSize, 4);
+
+    if (font->cells == NULL || font->buckets == NULL || font->scratch == NULL || clear == NULL) {
+        fprintf(stderr, "ERROR: Couldn't allocate font\n");
+        MemFree(clear);
+        GL2D_DestroyFont(font);
+        return NULL;
+    }
+
+    // every byte 0xFF is FONT_NO_CELL
+    memset(font->buckets, 0xFF, bucketCount * sizeof(uint32_t));
+
+    font->texture = GL2D_CreateTextureFromPixels(clear, font->atlasSize, font->atlasSize);
+    MemFree(clear);
+
+    if (font->texture == GL2D_INVALID_HANDLE) {
+        GL2D_DestroyFont(font);
+        return NULL;
+    }
+
+    return font;
+}
+
+GL2D_API GL2D_Font GL2D_CreateFontFromFile(const char* path, const GL2D_FontDesc* desc) {
+    uint64_t size = 0;
+    char* data = ReadEntireFile(path, &size);
+
+    if (data == NULL) {
+        return NULL;
+    }
+
+    GL2D_Font font = GL2D_CreateFontFromMemory((const uint8_t*)data, size, desc);
+    MemFree(data);
+
+    return font;
+}
+
+GL2D_API void GL2D_DestroyFont(GL2D_Font font) {
+    for (uint32_t i = 0; i < FONT_RUN_CACHE_SIZE; i++) {
+        MemFree(font->runs[i].text);
+        MemFree(font->runs[i].glyphs);
+    }
+
+    if (font->texture != GL2D_INVALID_HANDLE) {
+        GL2D_DestroyTexture(font->texture);
+    }
+
+    MemFree(font->cells);
+    MemFree(font->buckets);
+    MemFree(font->scratch);
+    MemFree(font->data);
+    MemFree(font);
+}
+
+GL2D_API GL2D_Texture GL2D_GetFontTexture(GL2D_Font font) {
+    return font->texture;
+}
+
+static uint32_t FontBucket(GL2D_Font font, uint32_t codepoint) {
+    return (codepoint * 2654435761u) & font->bucketMask;
+}
+
+static void FontUnlinkGlyph(GL2D_Font font, uint32_t cell) {
+    uint32_t* link = &font->buckets[FontBucket(font, font->cells[cell].codepoint)];
+
+    while (*link != cell) {
+        link = &font->cells[*link].next;
+    }
+
+    *link = font->cells[cell].next;
+}
+
+static void FontUploadCell(GL2D_Font font, uint32_t cell) {
+    uint32_t x = (cell % font->columns) * font->cellWidth;
+    uint32_t y = (cell / font->columns) * font->cellHeight;
+    Texture* texture = PoolGet(&texturePool, font->texture);
+
+    if (texture == NULL) {
+        return;
+    }
+
+    if (texture->pixels != NULL) {
+        for (uint32_t row = 0; row < font->cellHeight; row++) {
+            memcpy(texture->pixels + ((uint64_t)(y + row) * font->atlasSize + x) * 4, font->scratch + (uint64_t)row * font->cellWidth * 4, font->cellWidth * 4);
+        }
+
+        return;
+    }
+
+    StateBindTextureForUpdate(texture->id);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, font->cellWidth, font->cellHeight, GL_RGBA, GL_UNSIGNED_BYTE, font->scratch);
+    CountTextureUpload((uint64_t)font->cellWidth * font->cellHeight * 4);
+}
+
+// Returns the cell holding the codepoint's glyph, rasterizing it into a free or evicted cell first.
+static uint32_t FontGetGlyph(GL2D_Font font, uint32_t codepoint) {
+    for (uint32_t cell = font->buckets[FontBucket(font, codepoint)]; cell != FONT_NO_CELL; cell = font->cells[cell].next) {
+        if (font->cells[cell].codepoint == codepoint) {
+            font->cells[cell].lastUse = font->useClock;
+            return cell;
+        }
+    }
+
+    uint32_t cell = font->usedCells;
+
+    if (cell < font->cellCount) {
+        font->usedCells++;
+    }
+    else {
+        cell = 0;
+
+        for (uint32_t i = 1; i < font->cellCount; i++) {
+            cell = font->cells[i].lastUse < font->cells[cell].lastUse ? i : cell;
+        }
+
+        if (font->cells[cell].lastUse >= font->batchFirstUse) {
+            fprintf(stderr, "ERROR: Font atlas is full of glyphs drawn in this batch, use a bigger atlas\n");
+            return FONT_NO_CELL;
+        }
+
+        FontUnlinkGlyph(font, cell);
+        font->generation++;
+    }
+
+    FontGlyph* glyph = &font->cells[cell];
+    int advance, bearing, width = 0, height = 0, offsetX = 0, offsetY = 0;
+    uint8_t* bitmap;
+
+    glyph->glyph = stbtt_FindGlyphIndex(&font->info, (int)codepoint);
+    stbtt_GetGlyphHMetrics(&font->info, glyph->glyph, &advance, &bearing);
+
+    if (font->sdf) {
+        bitmap = stbtt_GetGlyphSDF(&font->info, font->scale, glyph->glyph, FONT_SDF_PADDING, FONT_SDF_ON_EDGE, (float)FONT_SDF_ON_EDGE / FONT_SDF_PADDING, &width, &height, &offsetX, &offsetY);
+    }
+    else {
+        bitmap = stbtt_GetGlyphBitmap(&font->info, font->scale, font->scale, glyph->glyph, &width, &height, &offsetX, &offsetY);
+    }
+
+    // a glyph outside the font's bounding box is clipped to its cell
+    int stride = width;
+    width = width < (int)font->cellWidth - 2 ? width : (int)font->cellWidth - 2;
+    height = height < (int)font->cellHeight - 2 ? height : (int)font->cellHeight - 2;
+
+    memset(font->scratch, 0, (uint64_t)font->cellWidth * font->cellHeight * 4);
+
+    for (int row = 0; row < height && bitmap != NULL; row++) {
+        uint8_t* destination = font->scratch + ((uint64_t)(row + 1) * font->cellWidth + 1) * 4;
+
+        for (int column = 0; column < width; column++, destination += 4) {
+            destination[0] = destination[1] = destination[2] = 255;
+            destination[3] = bitmap[row * stride + column];
+        }
+    }
+
+    stbtt_FreeBitmap(bitmap, NULL);
+    FontUploadCell(font, cell);
+
+    glyph->codepoint = codepoint;
+    glyph->offsetX = (float)offsetX;
+    glyph->offsetY = (float)offsetY;
+    glyph->width = bitmap != NULL ? (float)width : 0;
+    glyph->height = bitmap != NULL ? (float)height : 0;
+    glyph->advance = advance * font->scale;
+    glyph->lastUse = font->useClock;
+    glyph->next = font->buckets[FontBucket(font, codepoint)];
+    font->buckets[FontBucket(font, codepoint)] = cell;
+
+    return cell;
+}
+
+static uint32_t DecodeUTF8(const uint8_t** text, const uint8_t* end) {
+    const uint8_t* bytes = *text;
+    uint32_t length = bytes[0] < 0x80 ? 1 : (bytes[0] >> 5) == 0x6 ? 2 : (bytes[0] >> 4) == 0xE ? 3 : (bytes[0] >> 3) == 0x1E ? 4 : 0;
+    uint32_t codepoint = length == 1 ? bytes[0] : length == 2 ? bytes[0] & 0x1F : length == 3 ? bytes[0] & 0x0F : bytes[0] & 0x07;
+
+    if (length == 0 || bytes + length > end) {
+        *text = bytes + 1;
+        return 0xFFFD;
+    }
+
+    for (uint32_t i = 1; i < length; i++) {
+        if ((bytes[i] & 0xC0) != 0x80) {
+            *text = bytes + i;
+            return 0xFFFD;
+        }
+
+        codepoint = (codepoint << 6) | (bytes[i] & 0x3F);
+    }
+
+    *text = bytes + length;
+
+    return codepoint;
+}
+
+static bool LayoutText(GL2D_Font font, TextRun* run, const char* text, uint32_t length) {
+    const uint8_t* cursor = (const uint8_t*)text;
+    const uint8_t* end = cursor + length;
+    float penX = 0, baseline = font->ascent, width = 0;
+    int32_t previous = -1;
+
+    run->glyphCount = 0;
+    run->complete = true;
+
+    while (cursor < end) {
+        uint32_t codepoint = DecodeUTF8(&cursor, end);
+
+        if (codepoint == '\n') {
+            width = fmaxf(width, penX);
+            penX = 0;
+            baseline += font->lineHeight;
+            previous = -1;
+            continue;
+        }
+
+        uint32_t cell = FontGetGlyph(font, codepoint);
+
+        if (cell == FONT_NO_CELL) {
+            run->complete = false;
+            continue;
+        }
+
+        const FontGlyph* glyph = &font->cells[cell];
+
+        if (previous >= 0) {
+            penX += stbtt_GetGlyphKernAdvance(&font->info, previous, glyph->glyph) * font->scale;
+        }
+
+        if (glyph->width > 0 && glyph->height > 0) {
+            if (run->glyphCount == run->glyphCapacity) {
+                uint32_t capacity = run->glyphCapacity == 0 ? 32 : run->glyphCapacity * 2;
+                RunGlyph* glyphs = MemRealloc(run->glyphs, capacity * sizeof(RunGlyph));
+
+                if (glyphs == NULL) {
+                    fprintf(stderr, "ERROR: Couldn't allocate text run\n");
+                    return false;
+                }
+
+                run->glyphs = glyphs;
+                run->glyphCapacity = capacity;
+            }
+
+            run->glyphs[run->glyphCount++] = (RunGlyph) { penX + glyph->offsetX, baseline + glyph->offsetY, cell };
+        }
+
+        penX += glyph->advance;
+        previous = glyph->glyph;
+    }
+
+    run->size = (GL2D_Vector2f) { fmaxf(width, penX), baseline - font->ascent + font->lineHeight };
+    run->generation = font->generation;
+
+    return true;
+}
+
+// Finds the cached layout of the string or lays it out into the slot its hash maps to.
+static const TextRun* GetTextRun(GL2D_Font font, const char* text) {
+    uint32_t length = (uint32_t)strlen(text);
+    uint64_t hash = HashBytes(text, length);
+    TextRun* run = &font->runs[hash % FONT_RUN_CACHE_SIZE];
+
+    font->useClock++;
+
+    // a run that lost glyphs to a full atlas is laid out again, the cells may have freed up since
+    if (run->valid && run->complete && run->hash == hash && run->length == length && run->generation == font->generation && memcmp(run->text, text, length) == 0) {
+        // the glyphs are still in their cells, they only need marking as used
+        for (uint32_t i = 0; i < run->glyphCount; i++) {
+            font->cells[run->glyphs[i].cell].lastUse = font->useClock;
+        }
+
+        return run;
+    }
+
+    if (length + 1 > run->textCapacity) {
+        char* copy = MemRealloc(run->text, length + 1);
+
+        if (copy == NULL) {
+            fprintf(stderr, "ERROR: Couldn't allocate text run\n");
+            return NULL;
+        }
+
+        run->text = copy;
+        run->textCapacity = length + 1;
+    }
+
+    memcpy(run->text, text, length + 1);
+    run->hash = hash;
+    run->length = length;
+    run->valid = LayoutText(font, run, text, length);
+
+    // evictions made while laying out this run only ever hit glyphs the run doesn't use
+    return run->valid ? run : NULL;
+}
+
+GL2D_API GL2D_Vector2f GL2D_MeasureText(GL2D_Font font, const char* text, float size) {
+    const TextRun* run = GetTextRun(font, text);
+    float scale = size / font->pixelHeight;
+
+    if (run == NULL) {
+        return (GL2D_Vector2f) { 0, 0 };
+    }
+
+    return (GL2D_Vector2f) { run->size.x * scale, run->size.y * scale };
+}
+
+static GL2D_Shader GetTextShader(GL2D_Renderer renderer) {
+    if (renderer->textShader == GL2D_INVALID_HANDLE) {
+        renderer->textShader = GL2D_CreateShaderFromSource(instanceVertexSource, textFragmentSource);
+    }
+
+    return renderer->textShader;
+}
+
+// Once a batch has ended its glyphs are no longer referenced, so measuring or prewarming text
+// before the next batch may evict any of them.
+static void ReleaseBatchFonts(GL2D_Renderer renderer) {
+    for (uint32_t i = 0; i < renderer->batchFontCount; i++) {
+        GL2D_Font font = renderer->batchFonts[i];
+
+        // another renderer may have started its own batch with the font since
+        if (font->batchSerial == renderer->batchSerial) {
+            font->batchFirstUse = UINT64_MAX;
+        }
+    }
+
+    renderer->batchFontCount = 0;
+}
+
+// Draws the whole string with one instanced draw, the top left of its first line at position.
+GL2D_API void GL2D_DrawText(GL2D_Renderer renderer, GL2D_Font font, const char* text, GL2D_Vector2f position, float size, GL2D_Color color) {
+    if (!renderer->batchActive) {
+        fprintf(stderr, "ERROR: GL2D_DrawText called outside of GL2D_BeginBatch/GL2D_EndBatch\n");
+        return;
+    }
+
+    if (font->batchSerial != renderer->batchSerial) {
+        // the renderer remembers the font so GL2D_EndBatch can lift the protection again
+        if (renderer->batchFontCount == renderer->batchFontCapacity) {
+            uint32_t capacity = renderer->batchFontCapacity == 0 ? 8 : renderer->batchFontCapacity * 2;
+            GL2D_Font* fonts = MemRealloc(renderer->batchFonts, capacity * sizeof(GL2D_Font));
+
+            if (fonts == NULL) {
+                fprintf(stderr, "ERROR: Couldn't allocate batch font list\n");
+                return;
+            }
+
+            renderer->batchFonts = fonts;
+            renderer->batchFontCapacity = capacity;
+        }
+
+        renderer->batchFonts[renderer->batchFontCount++] = font;
+        font->batchSerial = renderer->batchSerial;
+        font->batchFirstUse = font->useClock + 1;
+    }
+
+    const TextRun* run = GetTextRun(font, text);
+
+    if (run == NULL || run->glyphCount == 0) {
+        return;
+    }
+
+    GL2D_SpriteInstance* instances = GL2D_FrameArenaAlloc(renderer->frameArena, run->glyphCount * sizeof(GL2D_SpriteInstance), 16);
+
+    if (instances == NULL) {
+        fprintf(stderr, "ERROR: Couldn't allocate text instances\n");
+        return;
+    }
+
+    float scale = size / font->pixelHeight;
+    float inverseAtlas = 1.0f / font->atlasSize;
+
+    for (uint32_t i = 0; i < run->glyphCount; i++) {
+        const RunGlyph* placed = &run->glyphs[i];
+        const FontGlyph* glyph = &font->cells[placed->cell];
+        GL2D_SpriteInstance* instance = &instances[i];
+
+        // the unit quad is centered, the glyph bitmap sits one texel into its cell
+        instance->transform.data[0][0] = glyph->width * scale;
+        instance->transform.data[0][1] = 0;
+        instance->transform.data[1][0] = 0;
+        instance->transform.data[1][1] = glyph->height * scale;
+        instance->transform.data[2][0] = position.x + (placed->x + glyph->width * 0.5f) * scale;
+        instance->transform.data[2][1] = position.y + (placed->y + glyph->height * 0.5f) * scale;
+        instance->uv.x = ((placed->cell % font->columns) * font->cellWidth + 1) * inverseAtlas;
+        instance->uv.y = ((placed->cell / font->columns) * font->cellHeight + 1) * inverseAtlas;
+        instance->uv.width = glyph->width * inverseAtlas;
+        instance->uv.height = glyph->height * inverseAtlas;
+        instance->color = color;
+    }
+
+    GL2D_Shader shader = font->sdf ? GetTextShader(renderer) : renderer->instanceShader;
+    GL2D_DrawInstancedWithShader(renderer, shader, font->texture, instances, run->glyphCount);
+}
+
+// Each frame in flight owns a chain of blocks, newest first. Resetting a frame that overflowed
+// folds its chain into one block big enough for it, so a steady workload stops allocating.
+typedef struct ArenaBlock {
+    struct ArenaBlock* next;
+    uint64_t size;
+    uint64_t used;
+} ArenaBlock;
+
+typedef struct ArenaFrame {
+    ArenaBlock* blocks;
+    uint64_t used;
+} ArenaFrame;
+
+struct GL2D_FrameArena {
+    ArenaFrame frames[GL2D_FRAME_ARENA_MAX_FRAMES];
+    uint32_t frameCount;
+    uint32_t frameIndex;
+    uint64_t blockSize;
+    uint64_t highWater;
+    uint64_t heapAllocations;
+};
+
+#define ARENA_DEFAULT_ALIGNMENT 16
+
+static ArenaBlock* ArenaNewBlock(GL2D_FrameArena arena, uint64_t size) {
+    ArenaBlock* block = MemAlloc(sizeof(ArenaBlock) + size);
+
+    if (block == NULL) {
+        fprintf(stderr, "ERROR: Couldn't allocate frame arena block of %llu bytes\n", (unsigned long long)size);
+        return NULL;
+    }
+
+    block->next = NULL;
+    block->size = size;
+    block->used = 0;
+    arena->heapAllocations++;
+
+    return block;
+}
+
+static void ArenaFreeBlocks(ArenaBlock* block) {
+    while (block != NULL) {
+        ArenaBlock* next = block->next;
+        MemFree(block);
+        block = next;
+    }
+}
+
+GL2D_API GL2D_FrameArena GL2D_CreateFrameArena(uint64_t blockSize, uint32_t frameCount) {
+    GL2D_FrameArena arena = MemAlloc(sizeof(struct GL2D_FrameArena));
+
+    if (arena == NULL) {
+        fprintf(stderr, "ERROR: Couldn't allocate frame arena\n");
+        return NULL;
+    }
+
+    memset(arena, 0, sizeof(struct GL2D_FrameArena));
+
+    arena->blockSize = blockSize > 0 ? blockSize : GL2D_DEFAULT_FRAME_ARENA_SIZE;
+    arena->frameCount = frameCount < 1 ? 1 : (frameCount > GL2D_FRAME_ARENA_MAX_FRAMES ? GL2D_FRAME_ARENA_MAX_FRAMES : frameCount);
+
+    for (uint32_t i = 0; i < arena->frameCount; i++) {
+        arena->frames[i].blocks = ArenaNewBlock(arena, arena->blockSize);
+
+        if (arena->frames[i].blocks == NULL) {
+            GL2D_DestroyFrameArena(arena);
+            return NULL;
+        }
+    }
+
+    return arena;
+}
+
+GL2D_API void GL2D_DestroyFrameArena(GL2D_FrameArena arena) {
+    if (arena == NULL) {
+        return;
+    }
+
+    for (uint32_t i = 0; i < arena->frameCount; i++) {
+        ArenaFreeBlocks(arena->frames[i].blocks);
+    }
+
+    MemFree(arena);
+}
+
+// Memory stays valid until the arena has moved on frameCount frames, so a frame's data can still
+// be read while the next ones are recorded. Alignment must be a power of two, 0 means 16.
+GL2D_API void* GL2D_FrameArenaAlloc(GL2D_FrameArena arena, uint64_t size, uint64_t alignment) {
+    ArenaFrame* frame = &arena->frames[arena->frameIndex];
+    ArenaBlock* block = frame->blocks;
+
+    alignment = alignment > 0 ? alignment : ARENA_DEFAULT_ALIGNMENT;
+
+    uintptr_t base = (uintptr_t)(block + 1) + block->used;
+    uint64_t padding = ((base + alignment - 1) & ~(uintptr_t)(alignment - 1)) - base;
+
+    if (block->used + padding + size > block->size) {
+        uint64_t blockSize = size + alignment > arena->blockSize ? size + alignment : arena->blockSize;
+        ArenaBlock* overflow = ArenaNewBlock(arena, blockSize);
+
+        if (overflow == NULL) {
+            return NULL;
+        }
+
+        overflow->next = block;
+        frame->blocks = overflow;
+        block = overflow;
+
+        base = (uintptr_t)(block + 1);
+        padding = ((base + alignment - 1) & ~(uintptr_t)(alignment - 1)) - base;
+    }
+
+    void* memory = (uint8_t*)(block + 1) + block->used + padding;
+    block->used += padding + size;
+    frame->used += padding + size;
+
+    if (frame->used > arena->highWater) {
+        arena->highWater = frame->used;
+    }
+
+    return memory;
+}
+
+GL2D_API void GL2D_FrameArenaNextFrame(GL2D_FrameArena arena) {
+    arena->frameIndex = (arena->frameIndex + 1) % arena->frameCount;
+
+    ArenaFrame* frame = &arena->frames[arena->frameIndex];
+
+    if (frame->blocks->next != NULL) {
+        uint64_t total = 0;
+
+        for (ArenaBlock* block = frame->blocks; block != NULL; block = block->next) {
+            total += block->size;
+        }
+
+        total = (total + arena->blockSize - 1) / arena->blockSize * arena->blockSize;
+        ArenaBlock* merged = ArenaNewBlock(arena, total);
+
+        // on failure the chain is kept and simply reused as is
+        if (merged != NULL) {
+            ArenaFreeBlocks(frame->blocks);
+            frame->blocks = merged;
+        }
+    }
+
+    for (ArenaBlock* block = frame->blocks; block != NULL; block = block->next) {
+        block->used = 0;
+    }
+
+    frame->used = 0;
+}
+
+GL2D_API GL2D_FrameArenaStats GL2D_FrameArenaGetStats(GL2D_FrameArena arena) {
+    GL2D_FrameArenaStats stats = { 0 };
+
+    stats.used = arena->frames[arena->frameIndex].used;
+    stats.highWater = arena->highWater;
+    stats.heapAllocations = arena->heapAllocations;
+
+    for (uint32_t i = 0; i < arena->frameCount; i++) {
+        for (ArenaBlock* block = arena->frames[i].blocks; block != NULL; block = block->next) {
+            stats.capacity += block->size;
+            stats.blockCount++;
+        }
+    }
+
+    return stats;
+}
+
+// Sort key, most significant bits first:
+//   layer (8) | translucent (1) | opaque:      shader (12) | texture (12) | depth (24) | unused (7)
+//                               | translucent: inverted depth (24) | shader (12) | texture (12) | unused (7)
+// Opaque draws group by material and go front-to-back inside a material so early depth rejection
+// helps, translucent draws have to go back-to-front and only group materials at equal depth.
+#define SORT_KEY_LAYER_SHIFT 56
+#define SORT_KEY_TRANSLUCENT_SHIFT 55
+#define SORT_KEY_ID_MASK 0xFFF
+#define SORT_KEY_DEPTH_MAX 0xFFFFFF
+
+typedef struct SortItem {
+    uint64_t key;
+    uint32_t index;
+} SortItem;
+
+struct GL2D_RenderQueue {
+    GL2D_DrawCommand* commands;
+    SortItem* items;
+    uint32_t count;
+    uint32_t capacity;
+};
+
+static uint64_t MakeSortKey(const GL2D_DrawCommand* command) {
+    // the low bits of a handle are its pool slot, dense and stable for the handle's lifetime
+    uint64_t shader = command->shader & SORT_KEY_ID_MASK;
+    uint64_t texture = command->texture & SORT_KEY_ID_MASK;
+    float clamped = command->depth < 0 ? 0 : (command->depth > 1 ? 1 : command->depth);
+    uint64_t depth = (uint64_t)(clamped * SORT_KEY_DEPTH_MAX);
+    uint64_t key = (uint64_t)command->layer << SORT_KEY_LAYER_SHIFT;
+
+    if (command->translucent) {
+        key |= 1ULL << SORT_KEY_TRANSLUCENT_SHIFT;
+        key |= (SORT_KEY_DEPTH_MAX - depth) << 31;
+        key |= shader << 19;
+        key |= texture << 7;
+    }
+    else {
+        key |= shader << 43;
+        key |= texture << 31;
+        key |= depth << 7;
+    }
+
+    return key;
+}
+
+// LSD radix sort over bytes, stable, so draws with equal keys keep their submission order.
+// Bytes every key agrees on are skipped.
+static SortItem* RadixSort(SortItem* items, SortItem* scratch, uint32_t count) {
+    for (uint32_t shift = 0; shift < 64; shift += 8) {
+        uint32_t histogram[256] = { 0 };
+
+        for (uint32_t i = 0; i < count; i++) {
+            histogram[(items[i].key >> shift) & 0xFF]++;
+        }
+
+        if (histogram[(items[0].key >> shift) & 0xFF] == count) {
+            continue;
+        }
+
+        uint32_t offset = 0;
+
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t bucket = histogram[i];
+            histogram[i] = offset;
+            offset += bucket;
+        }
+
+        for (uint32_t i = 0; i < count; i++) {
+            scratch[histogram[(items[i].key >> shift) & 0xFF]++] = items[i];
+        }
+
+        SortItem* swap = items;
+        items = scratch;
+        scratch = swap;
+    }
+
+    return items;
+}
+
+GL2D_API GL2D_RenderQueue GL2D_CreateRenderQueue(uint32_t capacity) {
+    GL2D_RenderQueue queue = MemAlloc(sizeof(struct GL2D_RenderQueue));
+
+    if (queue == NULL) {
+        fprintf(stderr, "ERROR: Couldn't allocate render queue\n");
+        return NULL;
+    }
+
+    memset(queue, 0, sizeof(struct GL2D_RenderQueue));
+
+    capacity = capacity > 0 ? capacity : 256;
+    queue->commands = MemAlloc(capacity * sizeof(GL2D_DrawCommand));
+    queue->items = MemAlloc(capacity * sizeof(SortItem));
+
+    if (queue->commands == NULL || queue->items == NULL) {
+        fprintf(stderr, "ERROR: Couldn't allocate render queue\n");
+        GL2D_DestroyRenderQueue(queue);
+        return NULL;
+    }
+
+    queue->capacity = capacity;
+
+    return queue;
+}
+
+GL2D_API void GL2D_DestroyRenderQueue(GL2D_RenderQueue queue) {
+    MemFree(queue->commands);
+    MemFree(queue->items);
+    MemFree(queue);
+}
+
+GL2D_API void GL2D_RenderQueuePush(GL2D_RenderQueue queue, const GL2D_DrawCommand* command) {
+    if (queue->count == queue->capacity) {
+        uint32_t capacity = queue->capacity * 2;
+        GL2D_DrawCommand* commands = MemRealloc(queue->commands, capacity * sizeof(GL2D_DrawCommand));
+        queue->commands = commands != NULL ? commands : queue->commands;
+
+        SortItem* items = MemRealloc(queue->items, capacity * sizeof(SortItem));
+        queue->items = items != NULL ? items : queue->items;
+
+        if (commands == NULL || items == NULL) {
+            fprintf(stderr, "ERROR: Couldn't grow render queue, dropping draw\n");
+            return;
+        }
+
+        queue->capacity = capacity;
+    }
+
+    queue->commands[queue->count] = *command;
+    queue->items[queue->count] = (SortItem) { MakeSortKey(command), queue->count };
+    queue->count++;
+}
+
+GL2D_API void GL2D_RenderQueueClear(GL2D_RenderQueue queue) {
+    queue->count = 0;
+}
+
+GL2D_API uint32_t GL2D_RenderQueueGetCount(GL2D_RenderQueue queue) {
+    return queue->count;
+}
+
+// Sorts and draws everything pushed since the last submit, then empties the queue. The state cache
+// turns every repeated shader, texture or vertex array in the sorted run into a no-op.
+GL2D_API void GL2D_RenderQueueSubmit(GL2D_Renderer renderer, GL2D_RenderQueue queue) {
+    if (!RequireGL("GL2D_RenderQueueSubmit")) {
+        queue->count = 0;
+        return;
+    }
+
+    if (queue->count == 0) {
+        return;
+    }
+
+    if (renderer->batchActive) {
+        FlushBatch(renderer);
+    }
+
+    // the sort's ping-pong buffer only lives for this submit
+    SortItem* scratch = GL2D_FrameArenaAlloc(renderer->frameArena, queue->count * sizeof(SortItem), 0);
+
+    if (scratch == NULL) {
+        fprintf(stderr, "ERROR: Couldn't allocate render queue scratch\n");
+        return;
+    }
+
+    const SortItem* sorted = RadixSort(queue->items, scratch, queue->count);
+
+    for (uint32_t i = 0; i < queue->count; i++) {
+        const GL2D_DrawCommand* command = &queue->commands[sorted[i].index];
+        Shader* shader = PoolGet(&shaderPool, command->shader);
+        VertexArray* vertexArray = PoolGet(&vertexArrayPool, command->vertexArray);
+
+        // commands recorded against resources destroyed since are dropped
+        if (shader == NULL || vertexArray == NULL) {
+            continue;
+        }
+
+        StateEnable(GL_BLEND, command->translucent);
+        StateDepthMask(!command->translucent);
+        StateUseProgram(shader->id);
+
+        Texture* texture = PoolGet(&texturePool, command->texture);
+
+        if (texture != NULL) {
+            StateBindTexture(texture->slot, texture->id);
+        }
+
+        if (command->transformUniform != GL2D_INVALID_UNIFORM) {
+            GL2D_ShaderSetUniformMat4(command->shader, command->transformUniform, command->transform);
+        }
+
+        StateBindVertexArray(vertexArray->id);
+
+        if (command->indexed) {
+            glDrawElements(GL_TRIANGLES, command->count, GL_UNSIGNED_INT, (void*)((uintptr_t)command->first * sizeof(uint32_t)));
+        }
+        else {
+            glDrawArrays(GL_TRIANGLES, command->first, command->count);
+        }
+
+        CountDraw(command->count / 3, 0);
+    }
+
+    StateDepthMask(true);
+    StateEnable(GL_BLEND, true);
+
+    queue->count = 0;
+}
+
+// Command buffers record into memory owned by the buffer alone, so any number of threads can record
+// at once without locks as long as each buffer is only touched by one thread. Nothing is resolved or
+// validated while recording, handles are looked up when the render thread submits.
+// Commands are packed back to back, each a header followed by its payload, all 4 byte aligned.
+#define COMMAND_BIND_SHADER 0
+#define COMMAND_BIND_TEXTURE 1
+#define COMMAND_BIND_VERTEX_ARRAY 2
+#define COMMAND_UNIFORM_INT 3
+#define COMMAND_UNIFORM_FLOAT 4
+#define COMMAND_UNIFORM_VEC2 5
+#define COMMAND_UNIFORM_MAT4 6
+#define COMMAND_DRAW 7
+#define COMMAND_DRAW_INDEXED 8
+#define COMMAND_DRAW_QUAD 9
+
+typedef struct CommandHeader {
+    uint16_t type;
+    uint16_t size;
+} CommandHeader;
+
+typedef struct UniformCommand {
+    GL2D_Uniform uniform;
+    float values[16];
+} UniformCommand;
+
+typedef struct DrawRangeCommand {
+    uint32_t first;
+    uint32_t count;
+} DrawRangeCommand;
+
+typedef struct QuadCommand {
+    GL2D_Affine2D affine;
+    GL2D_Texture texture;
+    GL2D_Rectf uv;
+    GL2D_Color color;
+} QuadCommand;
+
+struct GL2D_CommandBuffer {
+    uint8_t* data;
+    uint64_t used;
+    uint64_t capacity;
+    uint32_t count;
+};
+
+GL2D_API GL2D_CommandBuffer GL2D_CreateCommandBuffer(uint64_t size) {
+    GL2D_CommandBuffer buffer = MemAlloc(sizeof(struct GL2D_CommandBuffer));
+
+    if (buffer == NULL) {
+        fprintf(stderr, "ERROR: Couldn't allocate command buffer\n");
+        return NULL;
+    }
+
+    memset(buffer, 0, sizeof(struct GL2D_CommandBuffer));
+
+    size = size > 0 ? size : 64 * 1024;
+    buffer->data = MemAlloc(size);
+
+    if (buffer->data == NULL) {
+        fprintf(stderr, "ERROR: Couldn't allocate command buffer\n");
+        MemFree(buffer);
+        return NULL;
+    }
+
+    buffer->capacity = size;
+
+    return buffer;
+}
+
+GL2D_API void GL2D_DestroyCommandBuffer(GL2D_CommandBuffer buffer) {
+    MemFree(buffer->data);
+    MemFree(buffer);
+}
+
+GL2D_API void GL2D_CommandBufferReset(GL2D_CommandBuffer buffer) {
+    buffer->used = 0;
+    buffer->count = 0;
+}
+
+GL2D_API uint32_t GL2D_CommandBufferGetCount(GL2D_CommandBuffer buffer) {
+    return buffer->count;
+}
+
+static void* RecordCommand(GL2D_CommandBuffer buffer, uint16_t type, uint64_t payloadSize) {
+    uint64_t size = (sizeof(CommandHeader) + payloadSize + 3) & ~(uint64_t)3;
+
+    if (buffer->used + size > buffer->capacity) {
+        uint64_t capacity = buffer->capacity * 2 >= buffer->used + size ? buffer->capacity * 2 : buffer->used + size;
+        uint8_t* data = MemRealloc(buffer->data, capacity);
+
+        if (data == NULL) {
+            fprintf(stderr, "ERROR: Couldn't grow command buffer, dropping command\n");
+            return NULL;
+        }
+
+        buffer->data = data;
+        buffer->capacity = capacity;
+    }
+
+    CommandHeader* header = (CommandHeader*)(buffer->data + buffer->used);
+    header->type = type;
+    header->size = (uint16_t)size;
+
+    buffer->used += size;
+    buffer->count++;
+
+    return header + 1;
+}
+
+static void RecordHandle(GL2D_CommandBuffer buffer, uint16_t type, uint32_t handle) {
+    uint32_t* payload = RecordCommand(buffer, type, sizeof(uint32_t));
+
+    if (payload != NULL) {
+        *payload = handle;
+    }
+}
+
+static void RecordUniform(GL2D_CommandBuffer buffer, uint16_t type, GL2D_Uniform uniform, const float* values, uint32_t count) {
+    UniformCommand* payload = RecordCommand(buffer, type, sizeof(GL2D_Uniform) + count * sizeof(float));
+
+    if (payload != NULL) {
+        payload->uniform = uniform;
+        memcpy(payload->values, values, count * sizeof(float));
+    }
+}
+
+static void RecordDraw(GL2D_CommandBuffer buffer, uint16_t type, uint32_t first, uint32_t count) {
+    DrawRangeCommand* payload = RecordCommand(buffer, type, sizeof(DrawRangeCommand));
+
+    if (payload != NULL) {
+        *payload = (DrawRangeCommand) { first, count };
+    }
+}
+
+GL2D_API void GL2D_CommandBufferBindShader(GL2D_CommandBuffer buffer, GL2D_Shader shader) {
+    RecordHandle(buffer, COMMAND_BIND_SHADER, shader);
+}
+
+GL2D_API void GL2D_CommandBufferBindTexture(GL2D_CommandBuffer buffer, GL2D_Texture texture) {
+    RecordHandle(buffer, COMMAND_BIND_TEXTURE, texture);
+}
+
+GL2D_API void GL2D_CommandBufferBindVertexArray(GL2D_CommandBuffer buffer, GL2D_VertexArray vao) {
+    RecordHandle(buffer, COMMAND_BIND_VERTEX_ARRAY, vao);
+}
+
+GL2D_API void GL2D_CommandBufferSetUniformInt(GL2D_CommandBuffer buffer, GL2D_Uniform uniform, int value) {
+    float bits;
+    memcpy(&bits, &value, sizeof(float));
+    RecordUniform(buffer, COMMAND_UNIFORM_INT, uniform, &bits, 1);
+}
+
+GL2D_API void GL2D_CommandBufferSetUniformFloat(GL2D_CommandBuffer buffer, GL2D_Uniform uniform, float value) {
+    RecordUniform(buffer, COMMAND_UNIFORM_FLOAT, uniform, &value, 1);
+}
+
+GL2D_API void GL2D_CommandBufferSetUniformVec2(GL2D_CommandBuffer buffer, GL2D_Uniform uniform, GL2D_Vector2f value) {
+    float values[2] = { value.x, value.y };
+    RecordUniform(buffer, COMMAND_UNIFORM_VEC2, uniform, values, 2);
+}
+
+GL2D_API void GL2D_CommandBufferSetUniformMat4(GL2D_CommandBuffer buffer, GL2D_Uniform uniform, GL2D_Matrix4f value) {
+    RecordUniform(buffer, COMMAND_UNIFORM_MAT4, uniform, &value.data[0][0], 16);
+}
+
+GL2D_API void GL2D_CommandBufferDraw(GL2D_CommandBuffer buffer, uint32_t first, uint32_t count) {
+    RecordDraw(buffer, COMMAND_DRAW, first, count);
+}
+
+GL2D_API void GL2D_CommandBufferDrawIndexed(GL2D_CommandBuffer buffer, uint32_t first, uint32_t count) {
+    RecordDraw(buffer, COMMAND_DRAW_INDEXED, first, count);
+}
+
+GL2D_API void GL2D_CommandBufferDrawQuad(GL2D_CommandBuffer buffer, GL2D_Affine2D affine, GL2D_Texture texture, GL2D_Rectf uv, GL2D_Color color) {
+    QuadCommand* payload = RecordCommand(buffer, COMMAND_DRAW_QUAD, sizeof(QuadCommand));
+
+    if (payload != NULL) {
+        *payload = (QuadCommand) { affine, texture, uv, color };
+    }
+}
+
+// Replays the buffers in array order, which makes the result independent of the order the
+// recording threads finished in, then empties them. Every buffer starts with nothing bound.
+// Quads go into the renderer's batch and need an active GL2D_BeginBatch like GL2D_DrawQuad, other
+// draws flush the batch first. Draws missing a live shader or vertex array are dropped.
+GL2D_API void GL2D_SubmitCommandBuffers(GL2D_Renderer renderer, const GL2D_CommandBuffer* buffers, uint32_t count) {
+    bool glOnly = false;
+
+    for (uint32_t i = 0; i < count; i++) {
+        GL2D_CommandBuffer buffer = buffers[i];
+        Shader* shader = NULL;
+        GL2D_Shader shaderHandle = GL2D_INVALID_HANDLE;
+        Texture* texture = NULL;
+        VertexArray* vertexArray = NULL;
+
+        for (uint64_t offset = 0; offset < buffer->used;) {
+            const CommandHeader* header = (const CommandHeader*)(buffer->data + offset);
+            const void* payload = header + 1;
+            offset += header->size;
+
+            if (header->type == COMMAND_DRAW_QUAD) {
+                const QuadCommand* quad = payload;
+                GL2D_DrawQuadAffineUV(renderer, quad->affine, quad->texture, quad->uv, quad->color);
+                continue;
+            }
+
+            if (renderer->software != NULL) {
+                glOnly = true;
+                continue;
+            }
+
+            switch (header->type) {
+                case COMMAND_BIND_SHADER:
+                    shaderHandle = *(const uint32_t*)payload;
+                    shader = PoolGet(&shaderPool, shaderHandle);
+                    break;
+                case COMMAND_BIND_TEXTURE:
+                    texture = PoolGet(&texturePool, *(const uint32_t*)payload);
+                    break;
+                case COMMAND_BIND_VERTEX_ARRAY:
+                    vertexArray = PoolGet(&vertexArrayPool, *(const uint32_t*)payload);
+                    break;
+                case COMMAND_UNIFORM_INT:
+                case COMMAND_UNIFORM_FLOAT:
+                case COMMAND_UNIFORM_VEC2:
+                case COMMAND_UNIFORM_MAT4: {
+                    const UniformCommand* uniform = payload;
+
+                    if (shader == NULL) {
+                        break;
+                    }
+
+                    // the batch may have switched programs since the bind was recorded
+                    StateUseProgram(shader->id);
+
+                    if (header->type == COMMAND_UNIFORM_INT) {
+                        int value;
+                        memcpy(&value, uniform->values, sizeof(int));
+                        GL2D_ShaderSetUniformInt(shaderHandle, uniform->uniform, value);
+                    }
+                    else if (header->type == COMMAND_UNIFORM_FLOAT) {
+                        GL2D_ShaderSetUniformFloat(shaderHandle, uniform->uniform, uniform->values[0]);
+                    }
+                    else if (header->type == COMMAND_UNIFORM_VEC2) {
+                        GL2D_ShaderSetUniformVec2(shaderHandle, uniform->uniform, (GL2D_Vector2f) { uniform->values[0], uniform->values[1] });
+                    }
+                    else {
+                        GL2D_Matrix4f matrix;
+                        memcpy(&matrix.data[0][0], uniform->values, sizeof(matrix.data));
+                        GL2D_ShaderSetUniformMat4(shaderHandle, uniform->uniform, matrix);
+                    }
+
+                    break;
+                }
+                case COMMAND_DRAW:
+                case COMMAND_DRAW_INDEXED: {
+                    const DrawRangeCommand* draw = payload;
+
+                    if (shader == NULL || vertexArray == NULL) {
+                        break;
+                    }
+
+                    if (renderer->batchActive) {
+                        FlushBatch(renderer);
+                    }
+
+                    StateUseProgram(shader->id);
+
+                    if (texture != NULL) {
+                        StateBindTexture(texture->slot, texture->id);
+                    }
+
+                    StateBindVertexArray(vertexArray->id);
+
+                    if (header->type == COMMAND_DRAW_INDEXED) {
+                        glDrawElements(GL_TRIANGLES, draw->count, GL_UNSIGNED_INT, (void*)((uintptr_t)draw->first * sizeof(uint32_t)));
+                    }
+                    else {
+                        glDrawArrays(GL_TRIANGLES, draw->first, draw->count);
+                    }
+
+                    CountDraw(draw->count / 3, 0);
+                    break;
+                }
+            }
+        }
+
+        GL2D_CommandBufferReset(buffer);
+    }
+
+    if (glOnly) {
+        RequireGL("GL2D_SubmitCommandBuffers");
+    }
+}
+
+// Loose uniform grid: every item lives in the one cell holding its center, so a move that stays in
+// the cell only rewrites the bounds and any other move is a swap-remove and an append. Each cell
+// keeps its items' bounds packed together, a query reads a few contiguous runs instead of chasing
+// items all over memory. An item fits a cell when neither side is longer than the cell, queries
+// then only have to widen by half a cell. Larger items go to an overflow cell that every query
+// walks. Items outside the grid bounds are kept in the border cells, correct but slower.
+#define SPATIAL_OVERSIZED UINT32_MAX
+#define SPATIAL_MAX_CELLS (1u << 24)
+
+typedef struct SpatialEntry {
+    float minX;
+    float minY;
+    float maxX;
+    float maxY;
+    uint32_t userData;
+    uint32_t item;
+} SpatialEntry;
+
+typedef struct SpatialCell {
+    SpatialEntry* entries;
+    uint32_t count;
+    uint32_t capacity;
+} SpatialCell;
+
+typedef struct SpatialItem {
+    uint32_t cell;
+    uint32_t entry;
+    uint16_t generation;
+    bool live;
+} SpatialItem;
+
+struct GL2D_SpatialGrid {
+    float originX;
+    float originY;
+    float cellSize;
+    float inverseCellSize;
+    uint32_t columns;
+    uint32_t rows;
+    SpatialCell* cells;
+    SpatialCell oversized;
+    SpatialItem* items;
+    uint32_t itemCount;
+    uint32_t itemCapacity;
+    uint32_t* freeItems;
+    uint32_t freeItemCount;
+    uint32_t liveCount;
+};
+
+GL2D_API GL2D_SpatialGrid GL2D_CreateSpatialGrid(GL2D_Rectf bounds, float cellSize) {
+    if (!(cellSize > 0) || !(bounds.width > 0) || !(bounds.height > 0)) {
+        fprintf(stderr, "ERROR: Spatial grid needs a positive cell size and bounds\n");
+        return NULL;
+    }
+
+    double columns = ceil(bounds.width / cellSize);
+    double rows = ceil(bounds.height / cellSize);
+
+    if (columns * rows > SPATIAL_MAX_CELLS) {
+        fprintf(stderr, "ERROR: Spatial grid of %.0fx%.0f cells is too large, use a bigger cell size\n", columns, rows);
+        return NULL;
+    }
+
+    GL2D_SpatialGrid grid = MemAlloc(sizeof(struct GL2D_SpatialGrid));
+
+    if (grid == NULL) {
+        fprintf(stderr, "ERROR: Couldn't allocate spatial grid\n");
+        return NULL;
+    }
+
+    memset(grid, 0, sizeof(struct GL2D_SpatialGrid));
+
+    grid->originX = bounds.x;
+    grid->originY = bounds.y;
+    grid->cellSize = cellSize;
+    grid->inverseCellSize = 1.0f / cellSize;
+    grid->columns = (uint32_t)columns;
+    grid->rows = (uint32_t)rows;
+    grid->cells = MemCalloc((uint64_t)grid->columns * grid->rows, sizeof(SpatialCell));
+
+    if (grid->cells == NULL) {
+        fprintf(stderr, "ERROR: Couldn't allocate spatial grid\n");
+        MemFree(grid);
+        return NULL;
+    }
+
+    return grid;
+}
+
+GL2D_API void GL2D_DestroySpatialGrid(GL2D_SpatialGrid grid) {
+    for (uint64_t i = 0; i < (uint64_t)grid->columns * grid->rows; i++) {
+        MemFree(grid->cells[i].entries);
+    }
+
+    MemFree(grid->oversized.entries);
+    MemFree(grid->cells);
+    MemFree(grid->items);
+    MemFree(grid->freeItems);
+    MemFree(grid);
+}
+
+static uint32_t SpatialColumn(const GL2D_SpatialGrid grid, float x) {
+    float column = floorf((x - grid->originX) * grid->inverseCellSize);
+    return column < 0 ? 0 : (column >= (float)grid->columns ? grid->columns - 1 : (uint32_t)column);
+}
+
+static uint32_t SpatialRow(const GL2D_SpatialGrid grid, float y) {
+    float row = floorf((y - grid->originY) * grid->inverseCellSize);
+    return row < 0 ? 0 : (row >= (float)grid->rows ? grid->rows - 1 : (uint32_t)row);
+}
+
+static uint32_t SpatialCellIndex(const GL2D_SpatialGrid grid, GL2D_Rectf bounds) {
+    if (bounds.width > grid->cellSize || bounds.height > grid->cellSize) {
+        return SPATIAL_OVERSIZED;
+    }
+
+    return SpatialRow(grid, bounds.y + bounds.height * 0.5f) * grid->columns + SpatialColumn(grid, bounds.x + bounds.width * 0.5f);
+}
+
+static SpatialCell* GetSpatialCell(GL2D_SpatialGrid grid, uint32_t cell) {
+    return cell == SPATIAL_OVERSIZED ? &grid->oversized : &grid->cells[cell];
+}
+
+static void SpatialSetBounds(SpatialEntry* entry, GL2D_Rectf bounds) {
+    entry->minX = bounds.x;
+    entry->minY = bounds.y;
+    entry->maxX = bounds.x + bounds.width;
+    entry->maxY = bounds.y + bounds.height;
+}
+
+static bool SpatialAppend(GL2D_SpatialGrid grid, uint32_t index, uint32_t cellIndex, const SpatialEntry* entry) {
+    SpatialCell* cell = GetSpatialCell(grid, cellIndex);
+
+    if (cell->count == cell->capacity) {
+        uint32_t capacity = cell->capacity == 0 ? 8 : cell->capacity * 2;
+        SpatialEntry* entries = MemRealloc(cell->entries, capacity * sizeof(SpatialEntry));
+
+        if (entries == NULL) {
+            fprintf(stderr, "ERROR: Couldn't allocate spatial grid cell\n");
+            return false;
+        }
+
+        cell->entries = entries;
+        cell->capacity = capacity;
+    }
+
+    cell->entries[cell->count] = *entry;
+    grid->items[index].cell = cellIndex;
+    grid->items[index].entry = cell->count++;
+
+    return true;
+}
+
+static void SpatialRemoveEntry(GL2D_SpatialGrid grid, uint32_t index) {
+    SpatialItem* item = &grid->items[index];
+    SpatialCell* cell = GetSpatialCell(grid, item->cell);
+    uint32_t last = --cell->count;
+
+    if (item->entry != last) {
+        cell->entries[item->entry] = cell->entries[last];
+        grid->items[cell->entries[item->entry].item].entry = item->entry;
+    }
+}
+
+// An id kept past GL2D_SpatialGridRemove carries the old generation, so it can't move or remove
+// whichever item later takes its slot.
+static SpatialItem* GetSpatialItem(GL2D_SpatialGrid grid, GL2D_SpatialItem item) {
+    uint32_t index = item & HANDLE_INDEX_MASK;
+
+    if (index >= grid->itemCount || !grid->items[index].live || grid->items[index].generation != item >> HANDLE_INDEX_BITS) {
+        return NULL;
+    }
+
+    return &grid->items[index];
+}
+
+GL2D_API GL2D_SpatialItem GL2D_SpatialGridInsert(GL2D_SpatialGrid grid, GL2D_Rectf bounds, uint32_t userData) {
+    if (grid->freeItemCount == 0 && grid->itemCount == grid->itemCapacity) {
+        uint32_t capacity = grid->itemCapacity == 0 ? 256 : grid->itemCapacity * 2;
+
+        if (capacity > HANDLE_INDEX_MASK + 1) {
+            fprintf(stderr, "ERROR: Too many spatial grid items\n");
+            return GL2D_INVALID_SPATIAL_ITEM;
+        }
+
+        SpatialItem* items = MemRealloc(grid->items, capacity * sizeof(SpatialItem));
+
+        if (items == NULL) {
+            fprintf(stderr, "ERROR: Couldn't allocate spatial grid items\n");
+            return GL2D_INVALID_SPATIAL_ITEM;
+        }
+
+        grid->items = items;
+
+        uint32_t* freeItems = MemRealloc(grid->freeItems, capacity * sizeof(uint32_t));
+
+        if (freeItems == NULL) {
+            fprintf(stderr, "ERROR: Couldn't allocate spatial grid items\n");
+            return GL2D_INVALID_SPATIAL_ITEM;
+        }
+
+        grid->freeItems = freeItems;
+        grid->itemCapacity = capacity;
+    }
+
+    uint32_t index = grid->freeItemCount > 0 ? grid->freeItems[grid->freeItemCount - 1] : grid->itemCount;
+    SpatialEntry entry = { .userData = userData, .item = index };
+    SpatialSetBounds(&entry, bounds);
+
+    if (!SpatialAppend(grid, index, SpatialCellIndex(grid, bounds), &entry)) {
+        return GL2D_INVALID_SPATIAL_ITEM;
+    }
+
+    if (grid->freeItemCount > 0) {
+        grid->freeItemCount--;
+    }
+    else {
+        grid->itemCount++;
+        grid->items[index].generation = 1;
+    }
+
+    grid->items[index].live = true;
+    grid->liveCount++;
+
+    return ((uint32_t)grid->items[index].generation << HANDLE_INDEX_BITS) | index;
+}
+
+GL2D_API void GL2D_SpatialGridRemove(GL2D_SpatialGrid grid, GL2D_SpatialItem item) {
+    SpatialItem* removed = GetSpatialItem(grid, item);
+
+    if (removed == NULL) {
+        return;
+    }
+
+    uint32_t index = item & HANDLE_INDEX_MASK;
+
+    SpatialRemoveEntry(grid, index);
+    removed->live = false;
+    removed->generation = NextGeneration(removed->generation);
+    grid->freeItems[grid->freeItemCount++] = index;
+    grid->liveCount--;
+}
+
+GL2D_API void GL2D_SpatialGridMove(GL2D_SpatialGrid grid, GL2D_SpatialItem item, GL2D_Rectf bounds) {
+    SpatialItem* moved = GetSpatialItem(grid, item);
+
+    if (moved == NULL) {
+        return;
+    }
+
+    uint32_t index = item & HANDLE_INDEX_MASK;
+    uint32_t cellIndex = SpatialCellIndex(grid, bounds);
+    SpatialEntry* entry = &GetSpatialCell(grid, moved->cell)->entries[moved->entry];
+
+    if (cellIndex == moved->cell) {
+        SpatialSetBounds(entry, bounds);
+        return;
+    }
+
+    SpatialEntry copy = *entry;
+    SpatialSetBounds(&copy, bounds);
+
+    // the old cell already has room for the entry, so a failed append can always fall back to it
+    SpatialRemoveEntry(grid, index);
+
+    if (!SpatialAppend(grid, index, cellIndex, &copy)) {
+        SpatialAppend(grid, index, moved->cell, &copy);
+    }
+}
+
+GL2D_API uint32_t GL2D_SpatialGridGetCount(GL2D_SpatialGrid grid) {
+    return grid->liveCount;
+}
+
+static uint32_t SpatialCollect(const SpatialCell* cell, GL2D_Rectf area, uint32_t* results, uint32_t count, uint32_t capacity) {
+    float maxX = area.x + area.width;
+    float maxY = area.y + area.height;
+
+    for (uint32_t i = 0; i < cell->count && count < capacity; i++) {
+        const SpatialEntry* entry = &cell->entries[i];
+
+        if (entry->maxX >= area.x && entry->minX <= maxX && entry->maxY >= area.y && entry->minY <= maxY) {
+            results[count++] = entry->userData;
+        }
+    }
+
+    return count;
+}
+
+// Writes the user data of up to capacity items whose bounds touch the area and returns how many
+// were written. Costs the cells the area covers plus the oversized items, not the whole grid.
+GL2D_API uint32_t GL2D_SpatialGridQuery(GL2D_SpatialGrid grid, GL2D_Rectf area, uint32_t* results, uint32_t capacity) {
+    float margin = grid->cellSize * 0.5f;
+    uint32_t firstColumn = SpatialColumn(grid, area.x - margin);
+    uint32_t lastColumn = SpatialColumn(grid, area.x + area.width + margin);
+    uint32_t firstRow = SpatialRow(grid, area.y - margin);
+    uint32_t lastRow = SpatialRow(grid, area.y + area.height + margin);
+    uint32_t count = SpatialCollect(&grid->oversized, area, results, 0, capacity);
+
+    for (uint32_t row = firstRow; row <= lastRow; row++) {
+        for (uint32_t column = firstColumn; column <= lastColumn; column++) {
+            count = SpatialCollect(&grid->cells[row * grid->columns + column], area, results, count, capacity);
+        }
+    }
+
+    return count;
+}
+
+// The camera looks at position, sees size world units at zoom 1 and turns the view by rotation
+// degrees. Y points down like the pixel projections used with GL2D_BeginBatch.
+GL2D_API GL2D_Matrix4f GL2D_CameraGetMatrix(const GL2D_Camera* camera) {
+    GL2D_Matrix4f result = GL2D_Mat4InitIdentity();
+    float radSine;
+    float radCos;
+
+    SinCos(camera->rotation * (float)(PI / 180), &radSine, &radCos);
+
+    float scaleX = 2 * camera->zoom / camera->size.x;
+    float scaleY = 2 * camera->zoom / camera->size.y;
+
+    result.data[0][0] = radCos * scaleX;
+    result.data[1][0] = radSine * scaleX;
+    result.data[0][1] = radSine * scaleY;
+    result.data[1][1] = -radCos * scaleY;
+    result.data[2][2] = -1.0f;
+    result.data[3][0] = -(result.data[0][0] * camera->position.x + result.data[1][0] * camera->position.y);
+    result.data[3][1] = -(result.data[0][1] * camera->position.x + result.data[1][1] * camera->position.y);
+
+    return result;
+}
+
+// World space bounds of the clip space square, rotated views get the box around the rotated rect.
+static bool ClipRectToWorld(const GL2D_Matrix4f* matrix, GL2D_Rectf* rect) {
+    GL2D_Matrix4f inverse;
+    GL2D_Vector2f corners[4] = { { -1, -1 }, { 1, -1 }, { 1, 1 }, { -1, 1 } };
+
+    if (!GL2D_Mat4InverseTo(&inverse, matrix)) {
+        return false;
+    }
+
+    GL2D_Mat4TransformPoints(&inverse, corners, corners, 4);
+
+    float minX = corners[0].x, maxX = corners[0].x;
+    float minY = corners[0].y, maxY = corners[0].y;
+
+    for (uint32_t i = 1; i < 4; i++) {
+        minX = fminf(minX, corners[i].x);
+        maxX = fmaxf(maxX, corners[i].x);
+        minY = fminf(minY, corners[i].y);
+        maxY = fmaxf(maxY, corners[i].y);
+    }
+
+    *rect = (GL2D_Rectf) { minX, minY, maxX - minX, maxY - minY };
+
+    return true;
+}
+
+GL2D_API GL2D_Rectf GL2D_CameraGetVisibleRect(const GL2D_Camera* camera) {
+    GL2D_Matrix4f matrix = GL2D_CameraGetMatrix(camera);
+    GL2D_Rectf rect;
+
+    if (!ClipRectToWorld(&matrix, &rect)) {
+        return (GL2D_Rectf) { camera->position.x, camera->position.y, 0, 0 };
+    }
+
+    return rect;
+}
+
+GL2D_API uint32_t GL2D_CameraQueryVisible(const GL2D_Camera* camera, GL2D_SpatialGrid grid, uint32_t* results, uint32_t capacity) {
+    return GL2D_SpatialGridQuery(grid, GL2D_CameraGetVisibleRect(camera), results, capacity);
+}
+
+// Tiles live in chunkSize x chunkSize chunks, each with its own static vertex buffer that is only
+// rebuilt when a tile in it changed and the chunk is about to be drawn. Every chunk shares one
+// index buffer, so a visible chunk costs a single draw call and nothing per tile on the CPU.
+// Vertices hold tile corners relative to the chunk plus unorm uvs, 8 bytes each. Animated tiles
+// carry a slot whose uv offset is a shader uniform, advancing them never touches the buffers.
+#define TILEMAP_DEFAULT_CHUNK_SIZE 32
+#define TILEMAP_MAX_CHUNK_SIZE 128
+#define TILEMAP_MAX_ANIMATIONS 64
+
+static const char* tilemapVertexSource = "#version 330 core\n"
+"layout (location = 0) in vec3 aCorner;\n"
+"layout (location = 1) in vec2 aTexCoord;\n"
+"out vec4 ourColor;\n"
+"out vec2 TexCoord;\n"
+"uniform mat4 projection;\n"
+"uniform vec2 origin;\n"
+"uniform vec2 chunkTile;\n"
+"uniform float tileSize;\n"
+"uniform vec2 animationOffsets[64];\n"
+"void main() {\n"
+"    vec2 position = origin + (chunkTile + aCorner.xy) * tileSize;\n"
+"    gl_Position = projection * vec4(position, 0.0, 1.0);\n"
+"    ourColor = vec4(1.0);\n"
+"    TexCoord = aTexCoord + animationOffsets[int(aCorner.z)];\n"
+"}";
+
+typedef struct TilemapVertex {
+    uint8_t corner[2];
+    uint8_t animation;
+    uint8_t padding;
+    uint16_t texCoord[2];
+} TilemapVertex;
+
+typedef struct TilemapChunk {
+    GL2D_VertexBuffer vbo;
+    GL2D_VertexArray vao;
+    uint32_t quadCount;
+    bool dirty;
+} TilemapChunk;
+
+typedef struct TilemapAnimation {
+    uint16_t tile;
+    uint16_t frameCount;
+    float frameDuration;
+} TilemapAnimation;
+
+struct GL2D_Tilemap {
+    uint32_t width;
+    uint32_t height;
+    float tileSize;
+    GL2D_Texture tileset;
+    uint32_t tilesetColumns;
+    uint32_t tilesetRows;
+    uint32_t chunkSize;
+    uint32_t chunkColumns;
+    uint32_t chunkRows;
+    uint16_t* tiles;
+    TilemapChunk* chunks;
+    TilemapVertex* vertices;
+    GL2D_IndexBuffer ibo;
+    GL2D_VertexLayout layout;
+    uint8_t* animationSlots;
+    TilemapAnimation animations[TILEMAP_MAX_ANIMATIONS];
+    float animationOffsets[TILEMAP_MAX_ANIMATIONS][2];
+    uint32_t animationCount;
+    double time;
+};
+
+// Tile ids start at 1 and count across the tileset rows from uv (0, 0), 0 leaves the cell empty.
+GL2D_API GL2D_Tilemap GL2D_CreateTilemap(const GL2D_TilemapDesc* desc) {
+    uint32_t chunkSize = desc->chunkSize > 0 ? desc->chunkSize : TILEMAP_DEFAULT_CHUNK_SIZE;
+
+    if (desc->width == 0 || desc->height == 0 || desc->tileSize <= 0 || desc->tilesetColumns == 0 || desc->tilesetRows == 0) {
+        fprintf(stderr, "ERROR: Invalid tilemap description\n");
+        return NULL;
+    }
+
+    if (desc->tilesetColumns * desc->tilesetRows > UINT16_MAX || chunkSize > TILEMAP_MAX_CHUNK_SIZE) {
+        fprintf(stderr, "ERROR: Tilemaps hold at most %d tileset tiles in chunks of up to %d tiles\n", UINT16_MAX, TILEMAP_MAX_CHUNK_SIZE);
+        return NULL;
+    }
+
+    GL2D_Tilemap map = MemAlloc(sizeof(struct GL2D_Tilemap));
+
+    if (map == NULL) {
+        fprintf(stderr, "ERROR: Couldn't allocate tilemap\n");
+        return NULL;
+    }
+
+    memset(map, 0, sizeof(struct GL2D_Tilemap));
+
+    map->width = desc->width;
+    map->height = desc->height;
+    map->tileSize = desc->tileSize;
+    map->tileset = desc->tileset;
+    map->tilesetColumns = desc->tilesetColumns;
+    map->tilesetRows = desc->tilesetRows;
+    map->chunkSize = chunkSize;
+    map->chunkColumns = (desc->width + chunkSize - 1) / chunkSize;
+    map->chunkRows = (desc->height + chunkSize - 1) / chunkSize;
+    map->animationCount = 1;
+    map->tiles = MemCalloc((uint64_t)desc->width * desc->height, sizeof(uint16_t));
+    map->chunks = MemCalloc(map->chunkColumns * map->chunkRows, sizeof(TilemapChunk));
+    map->vertices = MemAlloc(chunkSize * chunkSize * 4 * sizeof(TilemapVertex));
+    map->animationSlots = MemCalloc(desc->tilesetColumns * desc->tilesetRows + 1, sizeof(uint8_t));
+
+    if (map->tiles == NULL || map->chunks == NULL || map->vertices == NULL || map->animationSlots == NULL) {
+        fprintf(stderr, "ERROR: Couldn't allocate tilemap of %ux%u tiles\n", desc->width, desc->height);
+        GL2D_DestroyTilemap(map);
+        return NULL;
+    }
+
+    GL2D_VertexLayoutAdd(&map->layout, 0, GL2D_ATTRIBUTE_UINT8, 3, false);
+    GL2D_VertexLayoutAdd(&map->layout, 1, GL2D_ATTRIBUTE_UINT16, 2, true);
+
+    return map;
+}
+
+GL2D_API void GL2D_DestroyTilemap(GL2D_Tilemap map) {
+    if (map == NULL) {
+        return;
+    }
+
+    if (map->chunks != NULL) {
+        for (uint32_t i = 0; i < map->chunkColumns * map->chunkRows; i++) {
+            if (map->chunks[i].vbo != GL2D_INVALID_HANDLE) {
+                GL2D_DestroyVertexBuffer(map->chunks[i].vbo);
+            }
+        }
+    }
+
+    if (map->ibo != GL2D_INVALID_HANDLE) {
+        GL2D_DestroyIndexBuffer(map->ibo);
+    }
+
+    MemFree(map->tiles);
+    MemFree(map->chunks);
+    MemFree(map->vertices);
+    MemFree(map->animationSlots);
+    MemFree(map);
+}
+
+GL2D_API void GL2D_TilemapSetTile(GL2D_Tilemap map, uint32_t x, uint32_t y, uint16_t tile) {
+    if (x >= map->width || y >= map->height || tile > map->tilesetColumns * map->tilesetRows) {
+        fprintf(stderr, "ERROR: Tile %u at %u, %u is outside of the tilemap or its tileset\n", tile, x, y);
+        return;
+    }
+
+    uint16_t* cell = &map->tiles[(uint64_t)y * map->width + x];
+
+    if (*cell != tile) {
+        *cell = tile;
+        map->chunks[(y / map->chunkSize) * map->chunkColumns + x / map->chunkSize].dirty = true;
+    }
+}
+
+GL2D_API uint16_t GL2D_TilemapGetTile(GL2D_Tilemap map, uint32_t x, uint32_t y) {
+    if (x >= map->width || y >= map->height) {
+        return GL2D_EMPTY_TILE;
+    }
+
+    return map->tiles[(uint64_t)y * map->width + x];
+}
+
+static void UpdateTilemapAnimation(GL2D_Tilemap map, uint32_t slot) {
+    const TilemapAnimation* animation = &map->animations[slot];
+
+    if (animation->frameCount == 0) {
+        map->animationOffsets[slot][0] = 0;
+        map->animationOffsets[slot][1] = 0;
+        return;
+    }
+
+    uint32_t frame = (uint32_t)fmod(map->time / animation->frameDuration, animation->frameCount);
+    uint32_t base = animation->tile - 1u;
+    uint32_t shown = base + frame;
+
+    map->animationOffsets[slot][0] = ((float)(shown % map->tilesetColumns) - (float)(base % map->tilesetColumns)) / map->tilesetColumns;
+    map->animationOffsets[slot][1] = ((float)(shown / map->tilesetColumns) - (float)(base / map->tilesetColumns)) / map->tilesetRows;
+}
+
+static void MarkTilemapDirty(GL2D_Tilemap map) {
+    for (uint32_t i = 0; i < map->chunkColumns * map->chunkRows; i++) {
+        map->chunks[i].dirty = true;
+    }
+}
+
+// The animation shows frameCount consecutive tileset tiles starting at tile, wherever tile is
+// placed. Fewer than two frames turns it off. Slots are baked into the vertices, so assigning or
+// freeing one rebuilds each chunk before it is drawn next.
+GL2D_API void GL2D_TilemapSetAnimation(GL2D_Tilemap map, uint16_t tile, uint32_t frameCount, float frameDuration) {
+    if (tile == GL2D_EMPTY_TILE || tile - 1u + frameCount > map->tilesetColumns * map->tilesetRows) {
+        fprintf(stderr, "ERROR: Animation of tile %u runs past the end of the tileset\n", tile);
+        return;
+    }
+
+    uint32_t slot = map->animationSlots[tile];
+
+    if (frameCount < 2 || frameDuration <= 0) {
+        if (slot != 0) {
+            map->animations[slot].frameCount = 0;
+            map->animationSlots[tile] = 0;
+            UpdateTilemapAnimation(map, slot);
+            MarkTilemapDirty(map);
+        }
+
+        return;
+    }
+
+    if (slot == 0) {
+        for (slot = 1; slot < map->animationCount && map->animations[slot].frameCount > 0; slot++);
+
+        if (slot == TILEMAP_MAX_ANIMATIONS) {
+            fprintf(stderr, "ERROR: Tilemaps hold at most %d animated tiles\n", TILEMAP_MAX_ANIMATIONS - 1);
+            return;
+        }
+
+        map->animationCount = slot == map->animationCount ? slot + 1 : map->animationCount;
+        map->animationSlots[tile] = (uint8_t)slot;
+        MarkTilemapDirty(map);
+    }
+
+    map->animations[slot] = (TilemapAnimation) { tile, (uint16_t)frameCount, frameDuration };
+    UpdateTilemapAnimation(map, slot);
+}
+
+GL2D_API void GL2D_TilemapAdvance(GL2D_Tilemap map, float seconds) {
+    map->time = fmax(map->time + seconds, 0.0);
+
+    for (uint32_t slot = 1; slot < map->animationCount; slot++) {
+        UpdateTilemapAnimation(map, slot);
+    }
+}
+
+static GL2D_Shader GetTilemapShader(GL2D_Renderer renderer) {
+    if (renderer->tilemapShader == GL2D_INVALID_HANDLE) {
+        renderer->tilemapShader = GL2D_CreateShaderFromSource(tilemapVertexSource, instanceFragmentSource);
+    }
+
+    return renderer->tilemapShader;
+}
+
+// Half a texel keeps linear filtering from pulling in the neighbouring tiles of the tileset.
+static GL2D_Rectf TileTexCoords(GL2D_Tilemap map, uint16_t tile) {
+    Texture* texture = PoolGet(&texturePool, map->tileset);
+    uint32_t index = tile - 1u;
+    float insetU = texture != NULL && texture->size.x > 0 ? 0.5f / texture->size.x : 0;
+    float insetV = texture != NULL && texture->size.y > 0 ? 0.5f / texture->size.y : 0;
+
+    return (GL2D_Rectf) {
+        (float)(index % map->tilesetColumns) / map->tilesetColumns + insetU,
+        (float)(index / map->tilesetColumns) / map->tilesetRows + insetV,
+        1.0f / map->tilesetColumns - 2 * insetU,
+        1.0f / map->tilesetRows - 2 * insetV,
+    };
+}
+
+static uint16_t TexCoordToUnorm(float value) {
+    return (uint16_t)(value * UINT16_MAX + 0.5f);
+}
+
+// Binds vertex array 0 first, the element buffer binding would otherwise land in whichever
+// vertex array happens to be bound.
+static bool InitTilemapIndices(GL2D_Tilemap map) {
+    uint32_t indexCount = map->chunkSize * map->chunkSize * 6;
+    uint32_t* indices = MemAlloc(indexCount * sizeof(uint32_t));
+
+    if (indices == NULL) {
+        fprintf(stderr, "ERROR: Couldn't allocate tilemap indices\n");
+        return false;
+    }
+
+    for (uint32_t i = 0, offset = 0; i < indexCount; i += 6, offset += 4) {
+        indices[i + 0] = offset + 0;
+        indices[i + 1] = offset + 1;
+        indices[i + 2] = offset + 2;
+        indices[i + 3] = offset + 2;
+        indices[i + 4] = offset + 3;
+        indices[i + 5] = offset + 0;
+    }
+
+    StateBindVertexArray(0);
+    map->ibo = GL2D_CreateIndexBuffer(indices, indexCount * sizeof(uint32_t));
+    MemFree(indices);
+
+    return map->ibo != GL2D_INVALID_HANDLE;
+}
+
+static void RebuildTilemapChunk(GL2D_Tilemap map, uint32_t column, uint32_t row) {
+    TilemapChunk* chunk = &map->chunks[row * map->chunkColumns + column];
+    uint32_t firstX = column * map->chunkSize;
+    uint32_t firstY = row * map->chunkSize;
+    uint32_t endX = firstX + map->chunkSize < map->width ? firstX + map->chunkSize : map->width;
+    uint32_t endY = firstY + map->chunkSize < map->height ? firstY + map->chunkSize : map->height;
+    TilemapVertex* vertex = map->vertices;
+
+    for (uint32_t y = firstY; y < endY; y++) {
+        const uint16_t* tiles = &map->tiles[(uint64_t)y * map->width];
+
+        for (uint32_t x = firstX; x < endX; x++) {
+            if (tiles[x] == GL2D_EMPTY_TILE) {
+                continue;
+            }
+
+            GL2D_Rectf uv = TileTexCoords(map, tiles[x]);
+            uint16_t left = TexCoordToUnorm(uv.x);
+            uint16_t top = TexCoordToUnorm(uv.y);
+            uint16_t right = TexCoordToUnorm(uv.x + uv.width);
+            uint16_t bottom = TexCoordToUnorm(uv.y + uv.height);
+            uint8_t cornerX = (uint8_t)(x - firstX);
+            uint8_t cornerY = (uint8_t)(y - firstY);
+            uint8_t animation = map->animationSlots[tiles[x]];
+
+            // same corner order and uv layout as the batch quads
+            vertex[0] = (TilemapVertex) { { cornerX, cornerY }, animation, 0, { left, top } };
+            vertex[1] = (TilemapVertex) { { cornerX, cornerY + 1 }, animation, 0, { left, bottom } };
+            vertex[2] = (TilemapVertex) { { cornerX + 1, cornerY + 1 }, animation, 0, { right, bottom } };
+            vertex[3] = (TilemapVertex) { { cornerX + 1, cornerY }, animation, 0, { right, top } };
+            vertex += 4;
+        }
+    }
+
+    chunk->quadCount = (uint32_t)(vertex - map->vertices) / 4;
+    chunk->dirty = false;
+
+    if (chunk->quadCount == 0) {
+        return;
+    }
+
+    uint64_t size = chunk->quadCount * 4 * sizeof(TilemapVertex);
+
+    if (chunk->vbo == GL2D_INVALID_HANDLE) {
+        chunk->vbo = GL2D_CreateVertexBuffer(map->vertices, size);
+        chunk->vao = GL2D_GetVertexArray(&map->layout, chunk->vbo, map->ibo);
+
+        if (chunk->vao == GL2D_INVALID_HANDLE) {
+            chunk->quadCount = 0;
+            chunk->dirty = true;
+        }
+
+        return;
+    }
+
+    // respecifying the whole store keeps the vertex array valid and never stalls on the old one
+    StateBindBuffer(GL_ARRAY_BUFFER, ((VertexBuffer*)PoolGet(&vertexBufferPool, chunk->vbo))->id);
+    glBufferData(GL_ARRAY_BUFFER, size, map->vertices, GL_STATIC_DRAW);
+    CountBufferUpload(size);
+}
+
+static bool TilemapRange(float min, float max, float extent, uint32_t count, uint32_t* first, uint32_t* last) {
+    float lowest = floorf(min / extent);
+    float highest = floorf(max / extent);
+
+    if (highest < 0 || lowest >= count) {
+        return false;
+    }
+
+    *first = lowest < 0 ? 0 : (uint32_t)lowest;
+    *last = highest >= count ? count - 1 : (uint32_t)highest;
+
+    return true;
+}
+
+// No shaders on the software backend, the visible tiles go through as plain quads
+static void DrawTilemapSoftware(GL2D_Renderer renderer, GL2D_Tilemap map, GL2D_Vector2f position, GL2D_Rectf visible) {
+    uint32_t firstX, lastX, firstY, lastY;
+
+    if (!TilemapRange(visible.x - position.x, visible.x + visible.width - position.x, map->tileSize, map->width, &firstX, &lastX) ||
+        !TilemapRange(visible.y - position.y, visible.y + visible.height - position.y, map->tileSize, map->height, &firstY, &lastY)) {
+        return;
+    }
+
+    GL2D_Affine2D affine = { { { map->tileSize, 0 }, { 0, map->tileSize }, { 0, 0 } } };
+
+    for (uint32_t y = firstY; y <= lastY; y++) {
+        for (uint32_t x = firstX; x <= lastX; x++) {
+            uint16_t tile = map->tiles[(uint64_t)y * map->width + x];
+
+            if (tile == GL2D_EMPTY_TILE) {
+                continue;
+            }
+
+            GL2D_Rectf uv = TileTexCoords(map, tile);
+            uint8_t animation = map->animationSlots[tile];
+
+            uv.x += map->animationOffsets[animation][0];
+            uv.y += map->animationOffsets[animation][1];
+            affine.data[2][0] = position.x + (x + 0.5f) * map->tileSize;
+            affine.data[2][1] = position.y + (y + 0.5f) * map->tileSize;
+            SoftwareAddQuad(renderer, &affine, map->tileset, uv, GL2D_COLOR_WHITE);
+        }
+    }
+}
+
+// Draws the chunks the batch projection can see with one draw call each, the map's top left
+// corner at position. Dirty chunks are rebuilt here, chunks out of view wait until they show up.
+GL2D_API void GL2D_DrawTilemap(GL2D_Renderer renderer, GL2D_Tilemap map, GL2D_Vector2f position) {
+    if (!renderer->batchActive) {
+        fprintf(stderr, "ERROR: GL2D_DrawTilemap called outside of GL2D_BeginBatch/GL2D_EndBatch\n");
+        return;
+    }
+
+    GL2D_Rectf visible;
+    uint32_t firstColumn, lastColumn, firstRow, lastRow;
+    float extent = map->chunkSize * map->tileSize;
+
+    if (!ClipRectToWorld(&renderer->projection, &visible)) {
+        return;
+    }
+
+    if (renderer->software != NULL) {
+        DrawTilemapSoftware(renderer, map, position, visible);
+        return;
+    }
+
+    if (!TilemapRange(visible.x - position.x, visible.x + visible.width - position.x, extent, map->chunkColumns, &firstColumn, &lastColumn) ||
+        !TilemapRange(visible.y - position.y, visible.y + visible.height - position.y, extent, map->chunkRows, &firstRow, &lastRow)) {
+        return;
+    }
+
+    GL2D_Shader shader = GetTilemapShader(renderer);
+    Shader* program = GetShader(shader);
+
+    if (program == NULL || (map->ibo == GL2D_INVALID_HANDLE && !InitTilemapIndices(map))) {
+        return;
+    }
+
+    // quads already in the batch were submitted first and have to stay underneath
+    FlushBatch(renderer);
+
+    Texture* tileset = PoolGet(&texturePool, map->tileset);
+
+    if (tileset == NULL) {
+        tileset = PoolGet(&texturePool, renderer->whiteTexture);
+    }
+
+    GL2D_Uniform chunkTile = GL2D_ShaderGetUniform(shader, "chunkTile");
+    GL2D_Uniform animationOffsets = GL2D_ShaderGetUniform(shader, "animationOffsets");
+
+    GL2D_BindShader(shader);
+    GL2D_ShaderSetUniformMat4(shader, GL2D_ShaderGetUniform(shader, "projection"), renderer->projection);
+    GL2D_ShaderSetUniformVec2(shader, GL2D_ShaderGetUniform(shader, "origin"), position);
+    GL2D_ShaderSetUniformFloat(shader, GL2D_ShaderGetUniform(shader, "tileSize"), map->tileSize);
+    StateBindTexture(0, tileset->id);
+
+    if (animationOffsets != GL2D_INVALID_UNIFORM) {
+        glUniform2fv(program->uniforms[animationOffsets].location, map->animationCount, &map->animationOffsets[0][0]);
+    }
+
+    for (uint32_t row = firstRow; row <= lastRow; row++) {
+        for (uint32_t column = firstColumn; column <= lastColumn; column++) {
+            TilemapChunk* chunk = &map->chunks[row * map->chunkColumns + column];
+
+            if (chunk->dirty) {
+                RebuildTilemapChunk(map, column, row);
+            }
+
+            if (chunk->quadCount == 0) {
+                continue;
+            }
+
+            // whole tile coordinates keep the edges shared by neighbouring chunks bit identical
+            GL2D_ShaderSetUniformVec2(shader, chunkTile, (GL2D_Vector2f) { (float)(column * map->chunkSize), (float)(row * map->chunkSize) });
+            GL2D_BindVertexArray(chunk->vao);
+            glDrawElements(GL_TRIANGLES, chunk->quadCount * 6, GL_UNSIGNED_INT, 0);
+            CountDraw(chunk->quadCount * 2, 0);
+        }
+    }
+}
+
+// GPU scopes use GL_TIMESTAMP pairs rather than GL_TIME_ELAPSED, elapsed queries can't nest and
+// timestamps also place the scopes on the trace timeline. A frame's queries are read back once
+// they're available, the frame slot is only needed again PROFILER_FRAMES frames later.
+#define PROFILER_FRAMES 4
+#define PROFILER_MAX_SCOPES 64
+#define PROFILER_MAX_DEPTH 16
+#define PROFILER_DROPPED UINT32_MAX
+
+typedef struct ProfileRecord {
+    const char* name;
+    uint32_t depth;
+    double start;
+    double end;
+} ProfileRecord;
+
+typedef struct GPUFrame {
+    // query 0 marks the frame start, scope i owns 2i + 1 and 2i + 2
+    uint32_t queries[PROFILER_MAX_SCOPES * 2 + 1];
+    ProfileRecord records[PROFILER_MAX_SCOPES];
+    uint32_t count;
+    bool pending;
+} GPUFrame;
+
+typedef struct ProfileStack {
+    uint32_t records[PROFILER_MAX_DEPTH];
+    uint32_t depth;
+} ProfileStack;
+
+typedef struct TraceEvent {
+    const char* name;
+    uint32_t thread;
+    double start;
+    double duration;
+} TraceEvent;
+
+typedef struct TraceCounter {
+    double time;
+    GL2D_FrameStats stats;
+} TraceCounter;
+
+typedef struct Profiler {
+    ProfileRecord cpuRecords[PROFILER_MAX_SCOPES];
+    uint32_t cpuCount;
+    ProfileStack cpuStack;
+    ProfileRecord lastCpuRecords[PROFILER_MAX_SCOPES];
+    uint32_t lastCpuCount;
+    double lastFrameStart;
+    GPUFrame gpuFrames[PROFILER_FRAMES];
+    uint32_t gpuFrameIndex;
+    ProfileStack gpuStack;
+    ProfileRecord resolvedGpuRecords[PROFILER_MAX_SCOPES];
+    uint32_t resolvedGpuCount;
+    double resolvedGpuFrameStart;
+    double gpuClockOffset;
+    bool gpuTimers;
+    bool tracing;
+    double traceStart;
+    TraceEvent* events;
+    uint32_t eventCount;
+    uint32_t eventCapacity;
+    TraceCounter* counters;
+    uint32_t counterCount;
+    uint32_t counterCapacity;
+} Profiler;
+
+#define TRACE_THREAD_CPU 1
+#define TRACE_THREAD_GPU 2
+
+static void SyncGPUClock(Profiler* profiler) {
+    GLint64 timestamp = 0;
+    glGetInteger64v(GL_TIMESTAMP, &timestamp);
+    profiler->gpuClockOffset = ProfileNow() - (double)timestamp * 1e-9;
+}
+
+static bool InitProfiler(GL2D_Renderer renderer) {
+    Profiler* profiler = MemAlloc(sizeof(Profiler));
+
+    if (profiler == NULL) {
+        fprintf(stderr, "ERROR: Couldn't allocate profiler\n");
+        return false;
+    }
+
+    memset(profiler, 0, sizeof(Profiler));
+    renderer->profiler = profiler;
+
+    // the software backend has no GPU timeline, its GPU scopes are no-ops
+    profiler->gpuTimers = renderer->software == NULL;
+
+    if (!profiler->gpuTimers) {
+        return true;
+    }
+
+    for (uint32_t i = 0; i < PROFILER_FRAMES; i++) {
+        glGenQueries(PROFILER_MAX_SCOPES * 2 + 1, profiler->gpuFrames[i].queries);
+    }
+
+    SyncGPUClock(profiler);
+    glQueryCounter(profiler->gpuFrames[0].queries[0], GL_TIMESTAMP);
+
+    return true;
+}
+
+static void FreeProfiler(GL2D_Renderer renderer) {
+    Profiler* profiler = renderer->profiler;
+
+    if (profiler == NULL) {
+        return;
+    }
+
+    for (uint32_t i = 0; i < PROFILER_FRAMES && profiler->gpuTimers; i++) {
+        glDeleteQueries(PROFILER_MAX_SCOPES * 2 + 1, profiler->gpuFrames[i].queries);
+    }
+
+    MemFree(profiler->events);
+    MemFree(profiler->counters);
+    MemFree(profiler);
+    renderer->profiler = NULL;
+}
+
+// Scopes past the limits are dropped but still pushed, so every End still pairs with its Begin
+static uint32_t ProfileStackPush(ProfileStack* stack, uint32_t* count) {
+    uint32_t record = PROFILER_DROPPED;
+
+    if (*count < PROFILER_MAX_SCOPES && stack->depth < PROFILER_MAX_DEPTH) {
+        record = (*count)++;
+    }
+
+    if (stack->depth < PROFILER_MAX_DEPTH) {
+        stack->records[stack->depth] = record;
+    }
+
+    stack->depth++;
+
+    return record;
+}
+
+static uint32_t ProfileStackPop(ProfileStack* stack, const char* kind) {
+    if (stack->depth == 0) {
+        fprintf(stderr, "ERROR: GL2D_End%sScope without a matching begin\n", kind);
+        return PROFILER_DROPPED;
+    }
+
+    stack->depth--;
+
+    return stack->depth < PROFILER_MAX_DEPTH ? stack->records[stack->depth] : PROFILER_DROPPED;
+}
+
+static void TraceAddEvent(Profiler* profiler, const char* name, uint32_t thread, double start, double end) {
+    if (profiler->eventCount == profiler->eventCapacity) {
+        uint32_t capacity = profiler->eventCapacity == 0 ? 1024 : profiler->eventCapacity * 2;
+        TraceEvent* events = MemRealloc(profiler->events, capacity * sizeof(TraceEvent));
+
+        if (events == NULL) {
+            return;
+        }
+
+        profiler->events = events;
+        profiler->eventCapacity = capacity;
+    }
+
+    profiler->events[profiler->eventCount++] = (TraceEvent) { name, thread, start, end - start };
+}
+
+static void TraceAddCounter(Profiler* profiler, double time, const GL2D_FrameStats* stats) {
+    if (profiler->counterCount == profiler->counterCapacity) {
+        uint32_t capacity = profiler->counterCapacity == 0 ? 256 : profiler->counterCapacity * 2;
+        TraceCounter* counters = MemRealloc(profiler->counters, capacity * sizeof(TraceCounter));
+
+        if (counters == NULL) {
+            return;
+        }
+
+        profiler->counters = counters;
+        profiler->counterCapacity = capacity;
+    }
+
+    profiler->counters[profiler->counterCount++] = (TraceCounter) { time, *stats };
+}
+
+GL2D_API void GL2D_BeginCPUScope(GL2D_Renderer renderer, const char* name) {
+    Profiler* profiler = renderer->profiler;
+    uint32_t record = ProfileStackPush(&profiler->cpuStack, &profiler->cpuCount);
+
+    if (record != PROFILER_DROPPED) {
+        profiler->cpuRecords[record] = (ProfileRecord) { name, profiler->cpuStack.depth - 1, ProfileNow(), 0 };
+    }
+}
+
+GL2D_API void GL2D_EndCPUScope(GL2D_Renderer renderer) {
+    Profiler* profiler = renderer->profiler;
+    uint32_t record = ProfileStackPop(&profiler->cpuStack, "CPU");
+
+    if (record != PROFILER_DROPPED) {
+        profiler->cpuRecords[record].end = ProfileNow();
+    }
+}
+
+GL2D_API void GL2D_BeginGPUScope(GL2D_Renderer renderer, const char* name) {
+    Profiler* profiler = renderer->profiler;
+
+    if (!profiler->gpuTimers) {
+        return;
+    }
+
+    GPUFrame* frame = &profiler->gpuFrames[profiler->gpuFrameIndex];
+    uint32_t record = ProfileStackPush(&profiler->gpuStack, &frame->count);
+
+    if (record != PROFILER_DROPPED) {
+        frame->records[record] = (ProfileRecord) { name, profiler->gpuStack.depth - 1, 0, 0 };
+        glQueryCounter(frame->queries[record * 2 + 1], GL_TIMESTAMP);
+    }
+}
+
+GL2D_API void GL2D_EndGPUScope(GL2D_Renderer renderer) {
+    Profiler* profiler = renderer->profiler;
+
+    if (!profiler->gpuTimers) {
+        return;
+    }
+
+    GPUFrame* frame = &profiler->gpuFrames[profiler->gpuFrameIndex];
+    uint32_t record = ProfileStackPop(&profiler->gpuStack, "GPU");
+
+    if (record != PROFILER_DROPPED) {
+        glQueryCounter(frame->queries[record * 2 + 2], GL_TIMESTAMP);
+    }
+}
+
+// Never waits, a frame whose last query isn't available yet stops the walk since later frames
+// can't be done either.
+static void ResolveGPUFrames(Profiler* profiler) {
+    for (uint32_t i = 0; i < PROFILER_FRAMES; i++) {
+        GPUFrame* frame = &profiler->gpuFrames[(profiler->gpuFrameIndex + i) % PROFILER_FRAMES];
+
+        if (!frame->pending) {
+            continue;
+        }
+
+        GLuint available = 0;
+        glGetQueryObjectuiv(frame->queries[frame->count * 2], GL_QUERY_RESULT_AVAILABLE, &available);
+
+        if (!available) {
+            break;
+        }
+
+        GLuint64 timestamp = 0;
+        glGetQueryObjectui64v(frame->queries[0], GL_QUERY_RESULT, &timestamp);
+        profiler->resolvedGpuFrameStart = (double)timestamp * 1e-9;
+
+        for (uint32_t j = 0; j < frame->count; j++) {
+            ProfileRecord* record = &frame->records[j];
+
+            glGetQueryObjectui64v(frame->queries[j * 2 + 1], GL_QUERY_RESULT, &timestamp);
+            record->start = (double)timestamp * 1e-9;
+            glGetQueryObjectui64v(frame->queries[j * 2 + 2], GL_QUERY_RESULT, &timestamp);
+            record->end = (double)timestamp * 1e-9;
+
+            if (profiler->tracing) {
+                TraceAddEvent(profiler, record->name, TRACE_THREAD_GPU, record->start + profiler->gpuClockOffset, record->end + profiler->gpuClockOffset);
+            }
+        }
+
+        memcpy(profiler->resolvedGpuRecords, frame->records, frame->count * sizeof(ProfileRecord));
+        profiler->resolvedGpuCount = frame->count;
+        frame->pending = false;
+    }
+}
+
+static void ProfilerEndFrame(GL2D_Renderer renderer, double now) {
+    Profiler* profiler = renderer->profiler;
+
+    // scopes left open are closed at the frame boundary
+    while (profiler->cpuStack.depth > 0) {
+        GL2D_EndCPUScope(renderer);
+    }
+
+    while (profiler->gpuStack.depth > 0) {
+        GL2D_EndGPUScope(renderer);
+    }
+
+    for (uint32_t i = 0; i < profiler->cpuCount; i++) {
+        if (profiler->cpuRecords[i].end == 0) {
+            profiler->cpuRecords[i].end = now;
+        }
+
+        if (profiler->tracing) {
+            TraceAddEvent(profiler, profiler->cpuRecords[i].name, TRACE_THREAD_CPU, profiler->cpuRecords[i].start, profiler->cpuRecords[i].end);
+        }
+    }
+
+    memcpy(profiler->lastCpuRecords, profiler->cpuRecords, profiler->cpuCount * sizeof(ProfileRecord));
+    profiler->lastCpuCount = profiler->cpuCount;
+    profiler->lastFrameStart = renderer->frameStart;
+    profiler->cpuCount = 0;
+
+    if (profiler->tracing) {
+        TraceAddCounter(profiler, now, &renderer->frameStats);
+    }
+
+    if (!profiler->gpuTimers) {
+        return;
+    }
+
+    profiler->gpuFrames[profiler->gpuFrameIndex].pending = true;
+    profiler->gpuFrameIndex = (profiler->gpuFrameIndex + 1) % PROFILER_FRAMES;
+    ResolveGPUFrames(profiler);
+
+    // the GPU is more than PROFILER_FRAMES behind, this frame's timings are lost rather than waited on
+    GPUFrame* frame = &profiler->gpuFrames[profiler->gpuFrameIndex];
+    frame->pending = false;
+    frame->count = 0;
+    glQueryCounter(frame->queries[0], GL_TIMESTAMP);
+}
+
+// CPU scopes are from the last finished frame, GPU scopes from the newest frame the GPU has
+// finished, usually a few frames older. Times are milliseconds from the start of their frame.
+GL2D_API uint32_t GL2D_GetProfileScopes(GL2D_Renderer renderer, GL2D_ProfileScope* scopes, uint32_t capacity) {
+    Profiler* profiler = renderer->profiler;
+    uint32_t count = 0;
+
+    for (uint32_t i = 0; i < profiler->lastCpuCount && count < capacity; i++) {
+        const ProfileRecord* record = &profiler->lastCpuRecords[i];
+        scopes[count++] = (GL2D_ProfileScope) { record->name, false, record->depth, (record->start - profiler->lastFrameStart) * 1000, (record->end - record->start) * 1000 };
+    }
+
+    for (uint32_t i = 0; i < profiler->resolvedGpuCount && count < capacity; i++) {
+        const ProfileRecord* record = &profiler->resolvedGpuRecords[i];
+        scopes[count++] = (GL2D_ProfileScope) { record->name, true, record->depth, (record->start - profiler->resolvedGpuFrameStart) * 1000, (record->end - record->start) * 1000 };
+    }
+
+    return count;
+}
+
+GL2D_API void GL2D_BeginTrace(GL2D_Renderer renderer) {
+    Profiler* profiler = renderer->profiler;
+
+    profiler->tracing = true;
+    profiler->traceStart = ProfileNow();
+    profiler->eventCount = 0;
+    profiler->counterCount = 0;
+
+    if (profiler->gpuTimers) {
+        SyncGPUClock(profiler);
+    }
+}
+
+static void WriteJSONString(FILE* file, const char* string) {
+    fputc('"', file);
+
+    for (const char* c = string != NULL ? string : ""; *c != '\0'; c++) {
+        if (*c == '"' || *c == '\\') {
+            fprintf(file, "\\%c", *c);
+        }
+        else if ((unsigned char)*c < 0x20) {
+            fprintf(file, "\\u%04x", (unsigned char)*c);
+        }
+        else {
+            fputc(*c, file);
+        }
+    }
+
+    fputc('"', file);
+}
+
+// Chrome trace event format, loads in chrome://tracing or Perfetto. GPU scopes still in flight
+// when the trace ends are not included.
+GL2D_API bool GL2D_EndTrace(GL2D_Renderer renderer, const char* path) {
+    Profiler* profiler = renderer->profiler;
+
+    if (!profiler->tracing) {
+        fprintf(stderr, "ERROR: GL2D_EndTrace without GL2D_BeginTrace\n");
+        return false;
+    }
+
+    profiler->tracing = false;
+
+    FILE* file = fopen(path, "wb");
+
+    if (file == NULL) {
+        fprintf(stderr, "ERROR: Couldn't open file %s: %s\n", path, strerror(errno));
+        return false;
+    }
+
+    fprintf(file, "{\"traceEvents\":[\n");
+    fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"CPU\"}},\n", TRACE_THREAD_CPU);
+    fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"GPU\"}}", TRACE_THREAD_GPU);
+
+    for (uint32_t i = 0; i < profiler->eventCount; i++) {
+        const TraceEvent* event = &profiler->events[i];
+
+        fprintf(file, ",\n{\"name\":");
+        WriteJSONString(file, event->name);
+        fprintf(file, ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", event->thread, (event->start - profiler->traceStart) * 1e6, event->duration * 1e6);
+    }
+
+    for (uint32_t i = 0; i < profiler->counterCount; i++) {
+        const TraceCounter* counter = &profiler->counters[i];
+        const GL2D_FrameStats* stats = &counter->stats;
+        uint64_t stateChanges = stats->programChanges + stats->vertexArrayChanges + stats->bufferChanges + stats->textureChanges + stats->renderStateChanges;
+
+        fprintf(file, ",\n{\"name\":\"frame\",\"ph\":\"C\",\"pid\":1,\"ts\":%.3f,\"args\":{\"drawCalls\":%llu,\"triangles\":%llu,\"stateChanges\":%llu,\"uploadBytes\":%llu}}",
+            (counter->time - profiler->traceStart) * 1e6, (unsigned long long)stats->drawCalls, (unsigned long long)stats->triangles, (unsigned long long)stateChanges,
+            (unsigned long long)(stats->bufferBytesUploaded + stats->textureBytesUploaded));
+    }
+
+    fprintf(file, "\n]}\n");
+
+    bool written = !ferror(file);
+
+    if (fclose(file) != 0 || !written) {
+        fprintf(stderr, "ERROR: Couldn't write trace %s\n", path);
+        return false;
+    }
 
-    if (shader == NULL) {
-        printf("ERROR: can't allocate shader");
-        return NULL;
+    return true;
+}
+
+// Software backend: quads are set up as triangles when they're drawn, binned into square screen
+// tiles at GL2D_EndBatch and the tiles are rasterized in parallel on the worker pool. A tile walks
+// its triangles in submission order, so blending comes out as it does on GL without any locking
+// between tiles and the image doesn't depend on the thread count.
+// The framebuffer is RGBA8 with the top row first. State matches the GL path: GL_LEQUAL depth test
+// with depth writes, SRC_ALPHA/ONE_MINUS_SRC_ALPHA blending, bilinear sampling without mipmaps.
+#define SOFTWARE_TILE_SHIFT 6
+#define SOFTWARE_TILE_SIZE (1 << SOFTWARE_TILE_SHIFT)
+
+// Vertices snap to 1/256 pixel like most GL rasterizers and must stay within +/-2^17 pixels, which
+// keeps every edge function value exact in a double. Two triangles sharing an edge then get exactly
+// opposite values along it and the fill rule hands each pixel to one of them, so shared quad
+// diagonals never blend twice. The fill rule is top-left in GL window space, where y points up.
+#define SOFTWARE_SUBPIXEL 256.0f
+#define SOFTWARE_MAX_COORDINATE 131072.0f
+
+typedef struct SoftwareTriangle {
+    double edges[3][3];
+    bool topLeft[3];
+    float originX;
+    float originY;
+    // planes relative to the origin: value, d/dx, d/dy
+    float u[3];
+    float v[3];
+    float z[3];
+    float color[4];
+    int32_t minX;
+    int32_t minY;
+    int32_t maxX;
+    int32_t maxY;
+    GL2D_Texture texture;
+    const Texture* sampler;
+} SoftwareTriangle;
+
+typedef struct SoftwareTile {
+    uint32_t* triangles;
+    uint32_t count;
+    uint32_t capacity;
+} SoftwareTile;
+
+typedef struct SoftwareRaster {
+    uint8_t* color;
+    float* depth;
+    uint32_t width;
+    uint32_t height;
+    uint64_t depthCapacity;
+    GL2D_Rect viewport;
+    GL2D_Color clearColor;
+    SoftwareTriangle* triangles;
+    uint32_t triangleCount;
+    uint32_t triangleCapacity;
+    SoftwareTile* tiles;
+    uint32_t tilesX;
+    uint32_t tilesY;
+    uint32_t tileCapacity;
+    volatile int64_t nextTile;
+    uint32_t pendingJobs;
+    Mutex mutex;
+    Condition done;
+} SoftwareRaster;
+
+static bool SoftwareResize(SoftwareRaster* raster, uint8_t* pixels, uint32_t width, uint32_t height) {
+    uint64_t pixelCount = (uint64_t)width * height;
+
+    if (pixels == NULL || pixelCount == 0) {
+        fprintf(stderr, "ERROR: The software backend needs a framebuffer\n");
+        return false;
     }
 
-    memset(shader, 0, sizeof(struct GL2D_Shader));
+    if (pixelCount > raster->depthCapacity) {
+        float* depth = MemRealloc(raster->depth, pixelCount * sizeof(float));
 
-    char* vertexSource = ReadFile(vertexPath);
+        if (depth == NULL) {
+            fprintf(stderr, "ERROR: Couldn't allocate software depth buffer\n");
+            return false;
+        }
 
-    uint32_t vertexShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertexShader, 1, &vertexSource, NULL);
-    glCompileShader(vertexShader);
-    // check for shader compile errors
-    int success;
-    char infoLog[512];
-    glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-    if (!success)
-    {
-        glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
-        printf("ERROR::SHADER::VERTEX::COMPILATION_FAILED: %s\n", infoLog);
+        raster->depth = depth;
+        raster->depthCapacity = pixelCount;
     }
-    // fragment shader
-    uint32_t fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    char* fragmentSource = ReadFile(fragmentPath);
 
-    glShaderSource(fragmentShader, 1, &fragmentSource, NULL);
-    glCompileShader(fragmentShader);
-    // check for shader compile errors
-    glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-    if (!success)
-    {
-        glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
-        printf("ERROR::SHADER::FRAGMENT::COMPILATION_FAILED: %s\n", infoLog);
+    uint32_t tilesX = (width + SOFTWARE_TILE_SIZE - 1) >> SOFTWARE_TILE_SHIFT;
+    uint32_t tilesY = (height + SOFTWARE_TILE_SIZE - 1) >> SOFTWARE_TILE_SHIFT;
+
+    if (tilesX * tilesY > raster->tileCapacity) {
+        SoftwareTile* tiles = MemRealloc(raster->tiles, tilesX * tilesY * sizeof(SoftwareTile));
+
+        if (tiles == NULL) {
+            fprintf(stderr, "ERROR: Couldn't allocate software tiles\n");
+            return false;
+        }
+
+        memset(tiles + raster->tileCapacity, 0, (tilesX * tilesY - raster->tileCapacity) * sizeof(SoftwareTile));
+        raster->tiles = tiles;
+        raster->tileCapacity = tilesX * tilesY;
     }
-    // link shaders
-    shader->id = glCreateProgram();
-    glAttachShader(shader->id, vertexShader);
-    glAttachShader(shader->id, fragmentShader);
-    glLinkProgram(shader->id);
-    // check for linking errors
-    glGetProgramiv(shader->id, GL_LINK_STATUS, &success);
-    if (!success) {
-        glGetProgramInfoLog(shader->id, 512, NULL, infoLog);
-        printf("ERROR::SHADER::PROGRAM::LINKING_FAILED: %s\n", infoLog);
+
+    raster->color = pixels;
+    raster->width = width;
+    raster->height = height;
+    raster->tilesX = tilesX;
+    raster->tilesY = tilesY;
+    raster->viewport = (GL2D_Rect) { 0, 0, width, height };
+
+    for (uint64_t i = 0; i < pixelCount; i++) {
+        raster->depth[i] = 1.0f;
     }
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
 
-    return shader;
+    return true;
 }
 
-GL2D_API void GL2D_DestroyShader(GL2D_Shader shader) {
-    glDeleteProgram(shader->id);
-    free(shader);
+static bool InitSoftware(GL2D_Renderer renderer, const GL2D_RendererDesc* desc) {
+    SoftwareRaster* raster = MemAlloc(sizeof(SoftwareRaster));
+
+    if (raster == NULL) {
+        fprintf(stderr, "ERROR: Couldn't allocate software rasterizer\n");
+        return false;
+    }
+
+    memset(raster, 0, sizeof(SoftwareRaster));
+    MutexInit(&raster->mutex);
+    ConditionInit(&raster->done);
+    renderer->software = raster;
+
+    if (!SoftwareResize(raster, desc->framebuffer, desc->framebufferWidth, desc->framebufferHeight)) {
+        return false;
+    }
+
+    const uint8_t white[4] = { 255, 255, 255, 255 };
+    renderer->whiteTexture = GL2D_CreateTextureFromPixels(white, 1, 1);
+
+    return renderer->whiteTexture != GL2D_INVALID_HANDLE;
 }
 
-GL2D_API void GL2D_BindShader(GL2D_Shader shader) {
-    glUseProgram(shader->id);
+static void FreeSoftware(GL2D_Renderer renderer) {
+    SoftwareRaster* raster = renderer->software;
+
+    if (raster == NULL) {
+        return;
+    }
+
+    for (uint32_t i = 0; i < raster->tileCapacity; i++) {
+        MemFree(raster->tiles[i].triangles);
+    }
+
+    MutexDestroy(&raster->mutex);
+    ConditionDestroy(&raster->done);
+    MemFree(raster->tiles);
+    MemFree(raster->triangles);
+    MemFree(raster->depth);
+    MemFree(raster);
+    renderer->software = NULL;
 }
 
-GL2D_API void GL2D_ShaderSetBool(GL2D_Shader shader, const char* name, bool value) {
-    glUniform1i(glGetUniformLocation(shader->id, name), (int)value);
+GL2D_API bool GL2D_SetSoftwareFramebuffer(GL2D_Renderer renderer, uint8_t* pixels, uint32_t width, uint32_t height) {
+    if (renderer->software == NULL) {
+        fprintf(stderr, "ERROR: GL2D_SetSoftwareFramebuffer needs a software renderer\n");
+        return false;
+    }
+
+    if (renderer->batchActive) {
+        fprintf(stderr, "ERROR: GL2D_SetSoftwareFramebuffer called inside GL2D_BeginBatch/GL2D_EndBatch\n");
+        return false;
+    }
+
+    return SoftwareResize(renderer->software, pixels, width, height);
 }
 
-GL2D_API void GL2D_ShaderSetInt(GL2D_Shader shader, const char* name, int value) {
-    glUniform1i(glGetUniformLocation(shader->id, name), value);
+static void SoftwareSetViewport(GL2D_Renderer renderer, GL2D_Rect rect) {
+    renderer->software->viewport = rect;
 }
 
-GL2D_API void GL2D_ShaderSetFloat(GL2D_Shader shader, const char* name, float value) {
-    glUniform1f(glGetUniformLocation(shader->id, name), value);
+static GL2D_Rect SoftwareGetViewport(GL2D_Renderer renderer) {
+    return renderer->software->viewport;
 }
 
-GL2D_API void GL2D_ShaderSetVec2(GL2D_Shader shader, const char* name, GL2D_Vector2f value) {
-    glUniform2f(glGetUniformLocation(shader->id, name), value.x, value.y);
+static void SoftwareSetClearColor(GL2D_Renderer renderer, GL2D_Color color) {
+    renderer->software->clearColor = color;
 }
 
-GL2D_API void GL2D_ShaderSetMat4(GL2D_Shader shader, const char* name, GL2D_Matrix4f value) {
-    glUniformMatrix4fv(glGetUniformLocation(shader->id, name), 1, false, value.data);
+static void SoftwareClear(GL2D_Renderer renderer) {
+    SoftwareRaster* raster = renderer->software;
+    uint64_t pixelCount = (uint64_t)raster->width * raster->height;
+    uint8_t* color = raster->color;
+
+    for (uint64_t i = 0; i < pixelCount; i++, color += 4) {
+        memcpy(color, &raster->clearColor, 4);
+        raster->depth[i] = 1.0f;
+    }
 }
 
-GL2D_API GL2D_Texture GL2D_CreateTextureFromFile(const char* path) {
-    GL2D_Texture texture = malloc(sizeof(struct GL2D_Texture));
+// Triangles are clipped in clip space like GL does: against w > 0, the depth range and a guard
+// band around the viewport that keeps every projected vertex inside SOFTWARE_MAX_COORDINATE.
+#define SOFTWARE_CLIP_PLANES 7
+#define SOFTWARE_CLIP_MIN_W 1e-6f
+#define SOFTWARE_MAX_CLIPPED (3 + SOFTWARE_CLIP_PLANES)
 
-    if (texture == NULL) {
-        printf("ERROR: Couldn't allocate texture");
-        return NULL;
+typedef struct SoftwareVertex {
+    float clip[4];
+    float texCoord[2];
+} SoftwareVertex;
+
+static void SoftwareTransform(const GL2D_Matrix4f* m, const float position[2], const float texCoord[2], SoftwareVertex* out) {
+    float x = position[0];
+    float y = position[1];
+
+    for (uint32_t i = 0; i < 4; i++) {
+        out->clip[i] = m->data[0][i] * x + m->data[1][i] * y + m->data[3][i];
     }
 
-    memset(texture, 0, sizeof(struct GL2D_Texture));
+    out->texCoord[0] = texCoord[0];
+    out->texCoord[1] = texCoord[1];
+}
 
-    glGenTextures(1, &texture->id);
-    glBindTexture(GL_TEXTURE_2D, texture->id); // all upcoming GL_TEXTURE_2D operations now have effect on this texture object
-    // set the texture wrapping parameters
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);	// set texture wrapping to GL_REPEAT (default wrapping method)
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    // set texture filtering parameters
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    // load image, create texture and generate mipmaps
-    int width = 0, height = 0, nrChannels = 0;
-    // The FileSystem::getPath(...) is part of the GitHub repository so we can find files on any IDE/platform; replace it with your own image path.
-    stbi_set_flip_vertically_on_load(1);
-    unsigned char* data = stbi_load("assets/i.jpg", &width, &height, &nrChannels, 0);
-    if (data) {
-        if (nrChannels == 3) {
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-            glGenerateMipmap(GL_TEXTURE_2D);
+static void SoftwareClipDistances(const SoftwareRaster* raster, const SoftwareVertex* vertex, float distances[SOFTWARE_CLIP_PLANES]) {
+    // a quarter of the coordinate range on either side of the viewport in NDC units
+    float guardX = SOFTWARE_MAX_COORDINATE * 0.25f / (float)(raster->viewport.z > 0 ? raster->viewport.z : 1);
+    float guardY = SOFTWARE_MAX_COORDINATE * 0.25f / (float)(raster->viewport.w > 0 ? raster->viewport.w : 1);
+    const float* clip = vertex->clip;
+
+    distances[0] = clip[3] - SOFTWARE_CLIP_MIN_W;
+    distances[1] = guardX * clip[3] - clip[0];
+    distances[2] = guardX * clip[3] + clip[0];
+    distances[3] = guardY * clip[3] - clip[1];
+    distances[4] = guardY * clip[3] + clip[1];
+    distances[5] = clip[3] - clip[2];
+    distances[6] = clip[3] + clip[2];
+}
+
+static uint32_t SoftwareOutcode(const SoftwareRaster* raster, const SoftwareVertex* vertex) {
+    float distances[SOFTWARE_CLIP_PLANES];
+    uint32_t outcode = 0;
+
+    SoftwareClipDistances(raster, vertex, distances);
+
+    for (uint32_t i = 0; i < SOFTWARE_CLIP_PLANES; i++) {
+        outcode |= distances[i] < 0 ? 1u << i : 0;
+    }
+
+    return outcode;
+}
+
+// Sutherland-Hodgman against each plane the triangle crosses. Crossings are always interpolated
+// from the inside vertex, so both triangles of a quad cut their shared diagonal at the exact same
+// point and the fill rule still hands every pixel along it to one of them.
+static uint32_t SoftwareClipTriangle(const SoftwareRaster* raster, const SoftwareVertex input[3], uint32_t planes, SoftwareVertex output[SOFTWARE_MAX_CLIPPED]) {
+    SoftwareVertex buffers[2][SOFTWARE_MAX_CLIPPED];
+    const SoftwareVertex* polygon = input;
+    uint32_t count = 3;
+
+    for (uint32_t plane = 0; plane < SOFTWARE_CLIP_PLANES && count > 0; plane++) {
+        if (!(planes & (1u << plane))) {
+            continue;
         }
-        else if (nrChannels == 4) {
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-            glGenerateMipmap(GL_TEXTURE_2D);
+
+        SoftwareVertex* clipped = buffers[plane & 1];
+        uint32_t clippedCount = 0;
+
+        for (uint32_t i = 0; i < count; i++) {
+            const SoftwareVertex* from = &polygon[i];
+            const SoftwareVertex* to = &polygon[(i + 1) % count];
+            float fromDistances[SOFTWARE_CLIP_PLANES];
+            float toDistances[SOFTWARE_CLIP_PLANES];
+
+            SoftwareClipDistances(raster, from, fromDistances);
+            SoftwareClipDistances(raster, to, toDistances);
+
+            bool fromInside = fromDistances[plane] >= 0;
+            bool toInside = toDistances[plane] >= 0;
+
+            if (fromInside) {
+                clipped[clippedCount++] = *from;
+            }
+
+            if (fromInside != toInside) {
+                const SoftwareVertex* inside = fromInside ? from : to;
+                const SoftwareVertex* outside = fromInside ? to : from;
+                float insideDistance = fromInside ? fromDistances[plane] : toDistances[plane];
+                float outsideDistance = fromInside ? toDistances[plane] : fromDistances[plane];
+                float t = insideDistance / (insideDistance - outsideDistance);
+                SoftwareVertex* crossing = &clipped[clippedCount++];
+
+                for (uint32_t j = 0; j < 4; j++) {
+                    crossing->clip[j] = inside->clip[j] + (outside->clip[j] - inside->clip[j]) * t;
+                }
+
+                for (uint32_t j = 0; j < 2; j++) {
+                    crossing->texCoord[j] = inside->texCoord[j] + (outside->texCoord[j] - inside->texCoord[j]) * t;
+                }
+            }
         }
-        else {
-            printf("Failed to load texture\n");
+
+        polygon = clipped;
+        count = clippedCount;
+    }
+
+    memcpy(output, polygon, count * sizeof(SoftwareVertex));
+
+    return count;
+}
+
+// GL window rows count up from the bottom, framebuffer rows go down from the top
+static bool SoftwareProject(const SoftwareRaster* raster, const SoftwareVertex* vertex, float out[3]) {
+    const float* clip = vertex->clip;
+
+    if (!(clip[3] > 0)) {
+        return false;
+    }
+
+    float screenX = (float)raster->viewport.x + (clip[0] / clip[3] + 1) * 0.5f * (float)raster->viewport.z;
+    float screenY = (float)raster->height - ((float)raster->viewport.y + (clip[1] / clip[3] + 1) * 0.5f * (float)raster->viewport.w);
+
+    if (!(fabsf(screenX) < SOFTWARE_MAX_COORDINATE && fabsf(screenY) < SOFTWARE_MAX_COORDINATE)) {
+        return false;
+    }
+
+    out[0] = roundf(screenX * SOFTWARE_SUBPIXEL) / SOFTWARE_SUBPIXEL;
+    out[1] = roundf(screenY * SOFTWARE_SUBPIXEL) / SOFTWARE_SUBPIXEL;
+    out[2] = clip[2] / clip[3] * 0.5f + 0.5f;
+
+    return true;
+}
+
+static void SoftwarePlane(const double gradients[2][3], const float values[3], float plane[3]) {
+    // gradients are the edge a/b over the area, indexed by the vertex each edge is opposite to
+    plane[0] = values[0];
+    plane[1] = (float)(gradients[0][0] * values[0] + gradients[0][1] * values[1] + gradients[0][2] * values[2]);
+    plane[2] = (float)(gradients[1][0] * values[0] + gradients[1][1] * values[1] + gradients[1][2] * values[2]);
+}
+
+static void SoftwareAddTriangle(SoftwareRaster* raster, const float vertices[3][3], const float texCoords[3][2], GL2D_Texture texture, const float color[4]) {
+    double area = ((double)vertices[1][0] - vertices[0][0]) * ((double)vertices[2][1] - vertices[0][1]) -
+                  ((double)vertices[2][0] - vertices[0][0]) * ((double)vertices[1][1] - vertices[0][1]);
+
+    if (area == 0) {
+        return;
+    }
+
+    float minX = fminf(vertices[0][0], fminf(vertices[1][0], vertices[2][0]));
+    float maxX = fmaxf(vertices[0][0], fmaxf(vertices[1][0], vertices[2][0]));
+    float minY = fminf(vertices[0][1], fminf(vertices[1][1], vertices[2][1]));
+    float maxY = fmaxf(vertices[0][1], fmaxf(vertices[1][1], vertices[2][1]));
+
+    // pixel centers are at +0.5, the triangle only reaches pixels whose center it may cover
+    int32_t viewportTop = (int32_t)raster->height - (int32_t)(raster->viewport.y + raster->viewport.w);
+    int32_t clipMinX = (int32_t)raster->viewport.x > 0 ? (int32_t)raster->viewport.x : 0;
+    int32_t clipMinY = viewportTop > 0 ? viewportTop : 0;
+    int32_t clipMaxX = (int32_t)(raster->viewport.x + raster->viewport.z) < (int32_t)raster->width ? (int32_t)(raster->viewport.x + raster->viewport.z) - 1 : (int32_t)raster->width - 1;
+    int32_t clipMaxY = (int32_t)raster->height - (int32_t)raster->viewport.y - 1;
+    clipMaxY = clipMaxY < (int32_t)raster->height - 1 ? clipMaxY : (int32_t)raster->height - 1;
+
+    int32_t pixelMinX = (int32_t)ceilf(minX - 0.5f);
+    int32_t pixelMaxX = (int32_t)floorf(maxX - 0.5f);
+    int32_t pixelMinY = (int32_t)ceilf(minY - 0.5f);
+    int32_t pixelMaxY = (int32_t)floorf(maxY - 0.5f);
+
+    pixelMinX = pixelMinX > clipMinX ? pixelMinX : clipMinX;
+    pixelMinY = pixelMinY > clipMinY ? pixelMinY : clipMinY;
+    pixelMaxX = pixelMaxX < clipMaxX ? pixelMaxX : clipMaxX;
+    pixelMaxY = pixelMaxY < clipMaxY ? pixelMaxY : clipMaxY;
+
+    if (pixelMinX > pixelMaxX || pixelMinY > pixelMaxY) {
+        return;
+    }
+
+    if (raster->triangleCount == raster->triangleCapacity) {
+        uint32_t capacity = raster->triangleCapacity == 0 ? 1024 : raster->triangleCapacity * 2;
+        SoftwareTriangle* triangles = MemRealloc(raster->triangles, capacity * sizeof(SoftwareTriangle));
+
+        if (triangles == NULL) {
+            fprintf(stderr, "ERROR: Couldn't allocate software triangles\n");
+            return;
         }
+
+        raster->triangles = triangles;
+        raster->triangleCapacity = capacity;
     }
-    else {
-        printf("Failed to load texture\n");
+
+    SoftwareTriangle* triangle = &raster->triangles[raster->triangleCount++];
+    double sign = area < 0 ? -1 : 1;
+    double gradients[2][3];
+
+    for (uint32_t i = 0; i < 3; i++) {
+        const float* from = vertices[i];
+        const float* to = vertices[(i + 1) % 3];
+        double a = ((double)from[1] - to[1]) * sign;
+        double b = ((double)to[0] - from[0]) * sign;
+
+        triangle->edges[i][0] = a;
+        triangle->edges[i][1] = b;
+        triangle->edges[i][2] = ((double)from[0] * to[1] - (double)to[0] * from[1]) * sign;
+        triangle->topLeft[i] = a > 0 || (a == 0 && b < 0);
+
+        // edge i is opposite vertex i + 2
+        gradients[0][(i + 2) % 3] = a / (area * sign);
+        gradients[1][(i + 2) % 3] = b / (area * sign);
     }
-    stbi_image_free(data);
 
-    texture->size.x = width;
-    texture->size.y = height;
+    float u[3] = { texCoords[0][0], texCoords[1][0], texCoords[2][0] };
+    float v[3] = { texCoords[0][1], texCoords[1][1], texCoords[2][1] };
+    float z[3] = { vertices[0][2], vertices[1][2], vertices[2][2] };
 
-    return texture;
+    triangle->originX = vertices[0][0];
+    triangle->originY = vertices[0][1];
+    SoftwarePlane(gradients, u, triangle->u);
+    SoftwarePlane(gradients, v, triangle->v);
+    SoftwarePlane(gradients, z, triangle->z);
+    memcpy(triangle->color, color, sizeof(triangle->color));
+    triangle->minX = pixelMinX;
+    triangle->minY = pixelMinY;
+    triangle->maxX = pixelMaxX;
+    triangle->maxY = pixelMaxY;
+    triangle->texture = texture;
+    triangle->sampler = NULL;
 }
 
-GL2D_API void GL2D_DestroyTexture(GL2D_Texture texture) {
-    glDeleteTextures(1, &texture->id);
-    free(texture);
+static void SoftwareAddQuad(GL2D_Renderer renderer, const GL2D_Affine2D* affine, GL2D_Texture texture, GL2D_Rectf uv, GL2D_Color color) {
+    float positions[4][2];
+    float texCoords[4][2];
+
+    QuadCorners(affine, uv, positions, texCoords);
+    SoftwareAddCorners(renderer, positions, texCoords, texture, color);
 }
 
-GL2D_API void GL2D_BindTexture(GL2D_Texture texture) {
-    glActiveTexture(GL_TEXTURE0 +  texture->slot);
-    glBindTexture(GL_TEXTURE_2D, texture->id);
+// Projects the triangle and fans what is left of it after clipping, all of it when it's inside
+static void SoftwareAddClipped(SoftwareRaster* raster, const SoftwareVertex input[3], uint32_t planes, GL2D_Texture texture, const float color[4]) {
+    SoftwareVertex clipped[SOFTWARE_MAX_CLIPPED];
+    uint32_t count = planes == 0 ? 3 : SoftwareClipTriangle(raster, input, planes, clipped);
+    const SoftwareVertex* polygon = planes == 0 ? input : clipped;
+    float screen[SOFTWARE_MAX_CLIPPED][3];
+
+    for (uint32_t i = 0; i < count; i++) {
+        if (!SoftwareProject(raster, &polygon[i], screen[i])) {
+            return;
+        }
+    }
+
+    for (uint32_t i = 1; i + 1 < count; i++) {
+        const float vertices[3][3] = {
+            { screen[0][0], screen[0][1], screen[0][2] },
+            { screen[i][0], screen[i][1], screen[i][2] },
+            { screen[i + 1][0], screen[i + 1][1], screen[i + 1][2] },
+        };
+        const float texCoords[3][2] = {
+            { polygon[0].texCoord[0], polygon[0].texCoord[1] },
+            { polygon[i].texCoord[0], polygon[i].texCoord[1] },
+            { polygon[i + 1].texCoord[0], polygon[i + 1].texCoord[1] },
+        };
+
+        SoftwareAddTriangle(raster, vertices, texCoords, texture, color);
+    }
 }
 
-GL2D_API GL2D_VertexArray GL2D_CreateVertexArray() {
-    GL2D_VertexArray vao = malloc(sizeof(struct GL2D_VertexArray));
+static void SoftwareAddCorners(GL2D_Renderer renderer, const float positions[4][2], const float texCoords[4][2], GL2D_Texture texture, GL2D_Color color) {
+    SoftwareRaster* raster = renderer->software;
+    SoftwareVertex corners[4];
+    uint32_t outcodes[4];
 
-    if (vao == NULL) {
-        printf("ERROR: Couldn't allocate vao");
-        return NULL;
+    for (uint32_t i = 0; i < 4; i++) {
+        SoftwareTransform(&renderer->projection, positions[i], texCoords[i], &corners[i]);
+        outcodes[i] = SoftwareOutcode(raster, &corners[i]);
     }
 
-    memset(vao, 0, sizeof(struct GL2D_VertexArray));
+    // every corner beyond the same plane, nothing of the quad can be left
+    if (outcodes[0] & outcodes[1] & outcodes[2] & outcodes[3]) {
+        return;
+    }
 
-    glGenVertexArrays(1, &vao->id);
-    glBindVertexArray(vao->id);
+    const float normalized[4] = { color.r / 255.0f, color.g / 255.0f, color.b / 255.0f, color.a / 255.0f };
+    texture = texture != GL2D_INVALID_HANDLE ? texture : renderer->whiteTexture;
 
-    return vao;
+    // same split as the batch indices: 0 1 2, 2 3 0
+    const SoftwareVertex first[3] = { corners[0], corners[1], corners[2] };
+    const SoftwareVertex second[3] = { corners[2], corners[3], corners[0] };
+
+    SoftwareAddClipped(raster, first, outcodes[0] | outcodes[1] | outcodes[2], texture, normalized);
+    SoftwareAddClipped(raster, second, outcodes[2] | outcodes[3] | outcodes[0], texture, normalized);
 }
 
-GL2D_API void GL2D_DestroyVertexArray(GL2D_VertexArray vao) {
-    glDeleteVertexArrays(1, &vao->id);
+static float SoftwareWrap(float coordinate, bool repeat) {
+    return repeat ? coordinate - floorf(coordinate) : coordinate;
 }
 
-GL2D_API void GL2D_BindVertexArray(GL2D_VertexArray vao) {
-    glBindVertexArray(vao->id);
+static int32_t SoftwareTexel(int32_t coordinate, int32_t size, bool repeat) {
+    if (repeat) {
+        return coordinate < 0 ? coordinate + size : (coordinate >= size ? coordinate - size : coordinate);
+    }
+
+    return coordinate < 0 ? 0 : (coordinate >= size ? size - 1 : coordinate);
 }
 
-GL2D_API GL2D_VertexBuffer GL2D_CreateVertexBuffer(const float* vertices, uint64_t size) {
-    GL2D_VertexBuffer vbo = malloc(sizeof(struct GL2D_VertexBuffer));
+// GL_LINEAR at texel centers, a missing texture samples black like an unbound GL unit
+static void SoftwareSample(const Texture* texture, float s, float t, float out[4]) {
+    if (texture == NULL) {
+        out[0] = out[1] = out[2] = 0;
+        out[3] = 1;
+        return;
+    }
 
-    if (vbo == NULL) {
-        printf("ERROR: Couldn't allocate vbo");
-        return NULL;
+    int32_t width = (int32_t)texture->size.x;
+    int32_t height = (int32_t)texture->size.y;
+
+    if (width == 1 && height == 1) {
+        for (uint32_t i = 0; i < 4; i++) {
+            out[i] = texture->pixels[i] / 255.0f;
+        }
+
+        return;
     }
 
-    memset(vbo, 0, sizeof(struct GL2D_VertexBuffer));
+    float x = SoftwareWrap(s, texture->repeat) * width - 0.5f;
+    float y = SoftwareWrap(t, texture->repeat) * height - 0.5f;
+    float floorX = floorf(x);
+    float floorY = floorf(y);
+    float fractionX = x - floorX;
+    float fractionY = y - floorY;
+    int32_t x0 = SoftwareTexel((int32_t)floorX, width, texture->repeat);
+    int32_t x1 = SoftwareTexel((int32_t)floorX + 1, width, texture->repeat);
+    int32_t y0 = SoftwareTexel((int32_t)floorY, height, texture->repeat);
+    int32_t y1 = SoftwareTexel((int32_t)floorY + 1, height, texture->repeat);
 
-    glGenBuffers(1, &vbo->id);
-    glBindBuffer(GL_ARRAY_BUFFER, vbo->id);
-    glBufferData(GL_ARRAY_BUFFER, size, vertices, GL_STATIC_DRAW);
+    const uint8_t* p00 = texture->pixels + ((uint64_t)y0 * width + x0) * 4;
+    const uint8_t* p10 = texture->pixels + ((uint64_t)y0 * width + x1) * 4;
+    const uint8_t* p01 = texture->pixels + ((uint64_t)y1 * width + x0) * 4;
+    const uint8_t* p11 = texture->pixels + ((uint64_t)y1 * width + x1) * 4;
 
-    return vbo;
+    for (uint32_t i = 0; i < 4; i++) {
+        float top = p00[i] + (p10[i] - p00[i]) * fractionX;
+        float bottom = p01[i] + (p11[i] - p01[i]) * fractionX;
+        out[i] = (top + (bottom - top) * fractionY) / 255.0f;
+    }
 }
 
-GL2D_API void GL2D_DestroyVertexBuffer(GL2D_VertexBuffer vbo) {
-    glDeleteBuffers(1, &vbo->id);
-    free(vbo);
-}
+static void SoftwareShade(SoftwareRaster* raster, const SoftwareTriangle* triangle, int32_t x, int32_t y) {
+    float px = (float)x + 0.5f - triangle->originX;
+    float py = (float)y + 0.5f - triangle->originY;
+    float z = triangle->z[0] + triangle->z[1] * px + triangle->z[2] * py;
+    uint64_t index = (uint64_t)y * raster->width + x;
+
+    // outside the depth range is clipped on GL
+    if (z < 0 || z > 1 || z > raster->depth[index]) {
+        return;
+    }
+
+    float texel[4];
+    SoftwareSample(triangle->sampler, triangle->u[0] + triangle->u[1] * px + triangle->u[2] * py, triangle->v[0] + triangle->v[1] * px + triangle->v[2] * py, texel);
+
+    float alpha = texel[3] * triangle->color[3];
+    uint8_t* destination = raster->color + index * 4;
+
+    for (uint32_t i = 0; i < 4; i++) {
+        float source = i < 3 ? texel[i] * triangle->color[i] : alpha;
+        float blended = source * alpha + destination[i] / 255.0f * (1 - alpha);
+        blended = blended < 0 ? 0 : (blended > 1 ? 1 : blended);
+        destination[i] = (uint8_t)(blended * 255 + 0.5f);
+    }
 
-GL2D_API void GL2D_BindVertexBuffer(GL2D_VertexBuffer vbo) {
-    glBindBuffer(GL_ARRAY_BUFFER, vbo->id);
+    raster->depth[index] = z;
 }
 
-GL2D_API GL2D_IndexBuffer GL2D_CreateIndexBuffer(const uint32_t* indices, uint64_t size) {
-    GL2D_IndexBuffer ibo = malloc(sizeof(struct GL2D_IndexBuffer));
+// Coverage of the four pixels starting at x as a bit mask, the edge values are exact so the
+// comparisons decide ties the same way on every path.
+static uint32_t SoftwareCoverage(const SoftwareTriangle* triangle, double x, double y) {
+#if defined(GL2D_SIMD_SSE2)
+    __m128d inside01 = _mm_castsi128_pd(_mm_set1_epi32(-1));
+    __m128d inside23 = inside01;
 
-    if (ibo == NULL) {
-        printf("ERROR: Couldn't allocate ibo");
-        return NULL;
+    for (uint32_t i = 0; i < 3; i++) {
+        const double* edge = triangle->edges[i];
+        double start = edge[0] * x + edge[1] * y + edge[2];
+        __m128d e01 = _mm_add_pd(_mm_set1_pd(start), _mm_set_pd(edge[0], 0));
+        __m128d e23 = _mm_add_pd(_mm_set1_pd(start), _mm_set_pd(edge[0] * 3, edge[0] * 2));
+        __m128d zero = _mm_setzero_pd();
+        __m128d tie = triangle->topLeft[i] ? _mm_castsi128_pd(_mm_set1_epi32(-1)) : zero;
+
+        inside01 = _mm_and_pd(inside01, _mm_or_pd(_mm_cmpgt_pd(e01, zero), _mm_and_pd(_mm_cmpeq_pd(e01, zero), tie)));
+        inside23 = _mm_and_pd(inside23, _mm_or_pd(_mm_cmpgt_pd(e23, zero), _mm_and_pd(_mm_cmpeq_pd(e23, zero), tie)));
     }
 
-    memset(ibo, 0, sizeof(struct GL2D_IndexBuffer));
+    return (uint32_t)_mm_movemask_pd(inside01) | (uint32_t)_mm_movemask_pd(inside23) << 2;
+#else
+    uint32_t mask = 0xF;
+
+    for (uint32_t i = 0; i < 3; i++) {
+        const double* edge = triangle->edges[i];
+        double start = edge[0] * x + edge[1] * y + edge[2];
 
-    glGenBuffers(1, &ibo->id);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo->id);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, size, indices, GL_STATIC_DRAW);
+        for (uint32_t lane = 0; lane < 4; lane++) {
+            double value = start + edge[0] * lane;
+
+            if (!(value > 0 || (value == 0 && triangle->topLeft[i]))) {
+                mask &= ~(1u << lane);
+            }
+        }
+    }
 
-    return ibo;
+    return mask;
+#endif
 }
 
-GL2D_API void GL2D_DestroyIndexBuffer(GL2D_IndexBuffer ibo) {
-    glDeleteBuffers(1, &ibo->id);
-    free(ibo);
+static void SoftwareRasterTile(SoftwareRaster* raster, uint32_t tileIndex) {
+    const SoftwareTile* tile = &raster->tiles[tileIndex];
+    int32_t tileX = (int32_t)(tileIndex % raster->tilesX) << SOFTWARE_TILE_SHIFT;
+    int32_t tileY = (int32_t)(tileIndex / raster->tilesX) << SOFTWARE_TILE_SHIFT;
+
+    for (uint32_t i = 0; i < tile->count; i++) {
+        const SoftwareTriangle* triangle = &raster->triangles[tile->triangles[i]];
+        int32_t minX = triangle->minX > tileX ? triangle->minX : tileX;
+        int32_t minY = triangle->minY > tileY ? triangle->minY : tileY;
+        int32_t maxX = triangle->maxX < tileX + SOFTWARE_TILE_SIZE - 1 ? triangle->maxX : tileX + SOFTWARE_TILE_SIZE - 1;
+        int32_t maxY = triangle->maxY < tileY + SOFTWARE_TILE_SIZE - 1 ? triangle->maxY : tileY + SOFTWARE_TILE_SIZE - 1;
+
+        for (int32_t y = minY; y <= maxY; y++) {
+            // groups of four start on multiples of four, tiles do too
+            for (int32_t x = minX & ~3; x <= maxX; x += 4) {
+                uint32_t mask = SoftwareCoverage(triangle, (double)x + 0.5, (double)y + 0.5);
+
+                for (uint32_t lane = 0; mask != 0 && lane < 4; lane++) {
+                    int32_t pixel = x + (int32_t)lane;
+
+                    if ((mask & (1u << lane)) && pixel >= minX && pixel <= maxX) {
+                        SoftwareShade(raster, triangle, pixel, y);
+                    }
+                }
+            }
+        }
+    }
+}
+
+static void SoftwareRasterTiles(SoftwareRaster* raster) {
+    int64_t tileCount = (int64_t)raster->tilesX * raster->tilesY;
+    int64_t tile;
+
+    while ((tile = AtomicAdd(&raster->nextTile, 1)) < tileCount) {
+        if (raster->tiles[tile].count > 0) {
+            SoftwareRasterTile(raster, (uint32_t)tile);
+        }
+    }
+}
+
+static void SoftwareRasterJob(void* data) {
+    SoftwareRaster* raster = data;
+
+    SoftwareRasterTiles(raster);
+
+    MutexLock(&raster->mutex);
+
+    if (--raster->pendingJobs == 0) {
+        ConditionSignal(&raster->done);
+    }
+
+    MutexUnlock(&raster->mutex);
 }
 
-GL2D_API void GL2D_BindIndexBuffer(GL2D_IndexBuffer ibo) {
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo->id);
-}
\ No newline at end of file
+static void SoftwareFlush(GL2D_Renderer renderer) {
+    SoftwareRaster* raster = renderer->software;
+    uint32_t tileCount = raster->tilesX * raster->tilesY;
+    uint32_t busyTiles = 0;
+
+    if (raster->triangleCount == 0) {
+        return;
+    }
+
+    for (uint32_t i = 0; i < tileCount; i++) {
+        raster->tiles[i].count = 0;
+    }
+
+    for (uint32_t i = 0; i < raster->triangleCount; i++) {
+        SoftwareTriangle* triangle = &raster->triangles[i];
+        Texture* texture = PoolGet(&texturePool, triangle->texture);
+
+        // resolved here rather than at draw time, textures destroyed mid-batch sample black
+        triangle->sampler = texture != NULL && texture->pixels != NULL ? texture : NULL;
+
+        for (int32_t tileY = triangle->minY >> SOFTWARE_TILE_SHIFT; tileY <= triangle->maxY >> SOFTWARE_TILE_SHIFT; tileY++) {
+            for (int32_t tileX = triangle->minX >> SOFTWARE_TILE_SHIFT; tileX <= triangle->maxX >> SOFTWARE_TILE_SHIFT; tileX++) {
+                SoftwareTile* tile = &raster->tiles[(uint32_t)tileY * raster->tilesX + (uint32_t)tileX];
+
+                if (tile->count == tile->capacity) {
+                    uint32_t capacity = tile->capacity == 0 ? 64 : tile->capacity * 2;
+                    uint32_t* triangles = MemRealloc(tile->triangles, capacity * sizeof(uint32_t));
+
+                    if (triangles == NULL) {
+                        fprintf(stderr, "ERROR: Couldn't allocate software tile bin\n");
+                        continue;
+                    }
+
+                    tile->triangles = triangles;
+                    tile->capacity = capacity;
+                }
+
+                busyTiles += tile->count == 0;
+                tile->triangles[tile->count++] = i;
+            }
+        }
+    }
+
+    CountDraw(raster->triangleCount, 0);
+
+    // this thread rasterizes too, helpers only pay off with more than one busy tile
+    uint32_t helpers = busyTiles > 1 && StartWorkerPool() ? workerPool.threadCount : 0;
+    helpers = helpers < busyTiles - 1 ? helpers : busyTiles - 1;
+
+    raster->nextTile = 0;
+    raster->pendingJobs = helpers;
+
+    for (uint32_t i = 0; i < helpers; i++) {
+        if (!SubmitJob(SoftwareRasterJob, raster)) {
+            MutexLock(&raster->mutex);
+            raster->pendingJobs--;
+            MutexUnlock(&raster->mutex);
+        }
+    }
+
+    SoftwareRasterTiles(raster);
+
+    MutexLock(&raster->mutex);
+
+    while (raster->pendingJobs > 0) {
+        ConditionWait(&raster->done, &raster->mutex);
+    }
+
+    MutexUnlock(&raster->mutex);
+
+    raster->triangleCount = 0;
+}
@@ -53,6 +53,7 @@
     #define GL2D_API
 #endif
 
+#include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
 
@@ -68,6 +69,13 @@ typedef struct GL2D_Rect {
     uint32_t w;
 } GL2D_Rect;
 
+typedef struct GL2D_Rectf {
+    float x;
+    float y;
+    float width;
+    float height;
+} GL2D_Rectf;
+
 typedef struct GL2D_Transform {
     GL2D_Vector2f position;
     GL2D_Vector2f rotation;
@@ -78,6 +86,10 @@ typedef struct GL2D_Matrix4f {
     float data[4][4];
 } GL2D_Matrix4f;
 
+typedef struct GL2D_Affine2D {
+    float data[3][2];
+} GL2D_Affine2D;
+
 typedef struct GL2D_Color {
     uint8_t r;
     uint8_t g;
@@ -127,11 +139,189 @@ typedef struct GL2D_Color {
 //GL2D_COLOR_BLANK = { 0, 0, 0, 0 };
 
 typedef struct GL2D_Renderer* GL2D_Renderer;
-typedef struct GL2D_Shader* GL2D_Shader;
-typedef struct GL2D_Texture* GL2D_Texture;
-typedef struct GL2D_VertexArray* GL2D_VertexArray;
-typedef struct GL2D_VertexBuffer* GL2D_VertexBuffer;
-typedef struct GL2D_IndexBuffer* GL2D_IndexBuffer;
+typedef uint32_t GL2D_Shader;
+typedef uint32_t GL2D_Texture;
+typedef uint32_t GL2D_VertexArray;
+typedef uint32_t GL2D_VertexBuffer;
+typedef uint32_t GL2D_IndexBuffer;
+typedef struct GL2D_UniformBuffer* GL2D_UniformBuffer;
+typedef struct GL2D_StreamBuffer* GL2D_StreamBuffer;
+typedef struct GL2D_TextureAtlas* GL2D_TextureAtlas;
+typedef struct GL2D_AssetFS* GL2D_AssetFS;
+typedef struct GL2D_RenderQueue* GL2D_RenderQueue;
+typedef struct GL2D_CommandBuffer* GL2D_CommandBuffer;
+typedef struct GL2D_SpatialGrid* GL2D_SpatialGrid;
+typedef struct GL2D_Font* GL2D_Font;
+typedef struct GL2D_Tilemap* GL2D_Tilemap;
+typedef struct GL2D_FrameArena* GL2D_FrameArena;
+
+typedef int32_t GL2D_Uniform;
+
+typedef struct GL2D_StateCounters {
+    uint64_t issued;
+    uint64_t skipped;
+} GL2D_StateCounters;
+
+typedef void* (*GL2D_GLLoadProc)(const char* name);
+
+typedef struct GL2D_RendererDesc {
+    GL2D_GLLoadProc loadProc;
+    uint64_t uploadBudget;
+    uint64_t frameArenaSize;
+    uint32_t backend;
+    uint8_t* framebuffer;
+    uint32_t framebufferWidth;
+    uint32_t framebufferHeight;
+} GL2D_RendererDesc;
+
+typedef struct GL2D_FrameStats {
+    uint64_t drawCalls;
+    uint64_t triangles;
+    uint64_t instances;
+    uint64_t programChanges;
+    uint64_t vertexArrayChanges;
+    uint64_t bufferChanges;
+    uint64_t textureChanges;
+    uint64_t renderStateChanges;
+    uint64_t redundantStateChanges;
+    uint64_t bufferBytesUploaded;
+    uint64_t textureBytesUploaded;
+    uint64_t heapAllocations;
+    uint64_t heapFrees;
+    uint32_t shaderCount;
+    uint32_t textureCount;
+    double cpuFrameTime;
+} GL2D_FrameStats;
+
+typedef struct GL2D_ProfileScope {
+    const char* name;
+    bool gpu;
+    uint32_t depth;
+    double start;
+    double duration;
+} GL2D_ProfileScope;
+
+typedef uint32_t GL2D_AtlasRegion;
+
+typedef struct GL2D_AtlasSprite {
+    GL2D_Texture texture;
+    GL2D_Rectf uv;
+    GL2D_Vector2f size;
+} GL2D_AtlasSprite;
+
+typedef struct GL2D_VertexAttribute {
+    uint32_t location;
+    uint32_t type;
+    uint32_t components;
+    bool normalized;
+    uint32_t offset;
+} GL2D_VertexAttribute;
+
+#define GL2D_MAX_VERTEX_ATTRIBUTES 8
+
+typedef struct GL2D_VertexLayout {
+    GL2D_VertexAttribute attributes[GL2D_MAX_VERTEX_ATTRIBUTES];
+    uint32_t count;
+    uint32_t stride;
+} GL2D_VertexLayout;
+
+typedef struct GL2D_SpriteInstance {
+    GL2D_Affine2D transform;
+    GL2D_Rectf uv;
+    GL2D_Color color;
+} GL2D_SpriteInstance;
+
+typedef struct GL2D_ShaderCacheStats {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t rejected;
+    uint64_t stored;
+} GL2D_ShaderCacheStats;
+
+typedef struct GL2D_StreamBufferStats {
+    uint64_t allocations;
+    uint64_t bytes;
+    uint64_t wraps;
+    uint64_t stalls;
+    bool persistent;
+} GL2D_StreamBufferStats;
+
+typedef struct GL2D_AssetView {
+    const uint8_t* data;
+    uint64_t size;
+    void* buffer;
+} GL2D_AssetView;
+
+typedef struct GL2D_DrawCommand {
+    GL2D_Shader shader;
+    GL2D_Texture texture;
+    GL2D_VertexArray vertexArray;
+    uint32_t first;
+    uint32_t count;
+    bool indexed;
+    bool translucent;
+    uint8_t layer;
+    float depth;
+    GL2D_Uniform transformUniform;
+    GL2D_Matrix4f transform;
+} GL2D_DrawCommand;
+
+typedef uint32_t GL2D_SpatialItem;
+
+typedef struct GL2D_FontDesc {
+    float pixelHeight;
+    uint32_t atlasSize;
+    bool sdf;
+} GL2D_FontDesc;
+
+typedef struct GL2D_TilemapDesc {
+    uint32_t width;
+    uint32_t height;
+    float tileSize;
+    GL2D_Texture tileset;
+    uint32_t tilesetColumns;
+    uint32_t tilesetRows;
+    uint32_t chunkSize;
+} GL2D_TilemapDesc;
+
+typedef struct GL2D_Camera {
+    GL2D_Vector2f position;
+    GL2D_Vector2f size;
+    float zoom;
+    float rotation;
+} GL2D_Camera;
+
+typedef struct GL2D_FrameArenaStats {
+    uint64_t used;
+    uint64_t highWater;
+    uint64_t capacity;
+    uint32_t blockCount;
+    uint64_t heapAllocations;
+} GL2D_FrameArenaStats;
+
+#define GL2D_INVALID_HANDLE 0
+#define GL2D_INVALID_UNIFORM -1
+#define GL2D_INVALID_ATLAS_REGION 0
+#define GL2D_INVALID_SPATIAL_ITEM 0
+#define GL2D_EMPTY_TILE 0
+
+#define GL2D_DEFAULT_UPLOAD_BUDGET (4 * 1024 * 1024)
+#define GL2D_DEFAULT_FRAME_ARENA_SIZE (1024 * 1024)
+
+#define GL2D_ATTRIBUTE_FLOAT 0
+#define GL2D_ATTRIBUTE_HALF_FLOAT 1
+#define GL2D_ATTRIBUTE_INT16 2
+#define GL2D_ATTRIBUTE_UINT16 3
+#define GL2D_ATTRIBUTE_INT8 4
+#define GL2D_ATTRIBUTE_UINT8 5
+
+#define GL2D_STREAM_VERTICES 0
+#define GL2D_STREAM_INDICES 1
+
+#define GL2D_BACKEND_OPENGL 0
+#define GL2D_BACKEND_SOFTWARE 1
+
+#define GL2D_FRAME_ARENA_MAX_FRAMES 3
 
 GL2D_API bool GL2D_VecEqual(GL2D_Vector2f vector1, GL2D_Vector2f vector2);
 GL2D_API GL2D_Vector2f GL2D_VecScalarAdd(GL2D_Vector2f vector, float value);
@@ -157,13 +347,128 @@ GL2D_API GL2D_Matrix4f GL2D_Mat4Add(GL2D_Matrix4f matrix1, GL2D_Matrix4f matrix2
 GL2D_API GL2D_Matrix4f GL2D_Mat4Sub(GL2D_Matrix4f matrix1, GL2D_Matrix4f matrix2);
 GL2D_API GL2D_Matrix4f GL2D_Mat4Mult(GL2D_Matrix4f matrix1,GL2D_Matrix4f matrix2);
 GL2D_API GL2D_Vector2f GL2D_Mat4Vec2Mult(GL2D_Matrix4f matrix, GL2D_Vector2f vector);
+GL2D_API GL2D_Matrix4f GL2D_Mat4Ortho(float left, float right, float bottom, float top);
+GL2D_API GL2D_Matrix4f GL2D_Mat4Inverse(GL2D_Matrix4f matrix);
+GL2D_API void GL2D_Mat4MultTo(GL2D_Matrix4f* result, const GL2D_Matrix4f* matrix1, const GL2D_Matrix4f* matrix2);
+GL2D_API void GL2D_Mat4Vec2MultTo(GL2D_Vector2f* result, const GL2D_Matrix4f* matrix, const GL2D_Vector2f* vector);
+GL2D_API bool GL2D_Mat4InverseTo(GL2D_Matrix4f* result, const GL2D_Matrix4f* matrix);
+
+GL2D_API void GL2D_Mat4TransformPoints(const GL2D_Matrix4f* matrix, const GL2D_Vector2f* in, GL2D_Vector2f* out, size_t count);
+GL2D_API void GL2D_Mat4TransformPointsSoA(const GL2D_Matrix4f* matrix, const float* inX, const float* inY, float* outX, float* outY, size_t count);
+GL2D_API void GL2D_VecArrayAdd(const GL2D_Vector2f* in1, const GL2D_Vector2f* in2, GL2D_Vector2f* out, size_t count);
+GL2D_API void GL2D_VecArrayAddSoA(const float* inX1, const float* inY1, const float* inX2, const float* inY2, float* outX, float* outY, size_t count);
+GL2D_API void GL2D_VecArrayScale(const GL2D_Vector2f* in, float value, GL2D_Vector2f* out, size_t count);
+GL2D_API void GL2D_VecArrayScaleSoA(const float* inX, const float* inY, float value, float* outX, float* outY, size_t count);
+GL2D_API void GL2D_VecArrayRotate(const GL2D_Vector2f* in, float angle, GL2D_Vector2f* out, size_t count);
+GL2D_API void GL2D_VecArrayRotateSoA(const float* inX, const float* inY, float angle, float* outX, float* outY, size_t count);
+GL2D_API void GL2D_VecArrayNormalize(const GL2D_Vector2f* in, GL2D_Vector2f* out, size_t count);
+GL2D_API void GL2D_VecArrayNormalizeSoA(const float* inX, const float* inY, float* outX, float* outY, size_t count);
+
+GL2D_API GL2D_Affine2D GL2D_AffineIdentity();
+GL2D_API GL2D_Affine2D GL2D_TransformToAffine(GL2D_Transform transform);
+GL2D_API GL2D_Affine2D GL2D_AffineMult(GL2D_Affine2D affine1, GL2D_Affine2D affine2);
+GL2D_API void GL2D_AffineMultTo(GL2D_Affine2D* result, const GL2D_Affine2D* affine1, const GL2D_Affine2D* affine2);
+GL2D_API GL2D_Vector2f GL2D_AffineTransformPoint(GL2D_Affine2D affine, GL2D_Vector2f point);
+GL2D_API GL2D_Matrix4f GL2D_AffineToMat4(GL2D_Affine2D affine);
 
 GL2D_API void GL2D_SetViewport(GL2D_Rect rect);
 GL2D_API void GL2D_SetClearColor(GL2D_Color color);
 
 GL2D_API GL2D_Renderer GL2D_CreateRenderer();
+GL2D_API GL2D_Renderer GL2D_CreateRendererEx(const GL2D_RendererDesc* desc);
+GL2D_API bool GL2D_SetSoftwareFramebuffer(GL2D_Renderer renderer, uint8_t* pixels, uint32_t width, uint32_t height);
+GL2D_API void GL2D_DestroyRenderer(GL2D_Renderer renderer);
 GL2D_API void GL2D_UpdateRenderer(GL2D_Renderer renderer);
+GL2D_API void GL2D_SetTextureUploadBudget(GL2D_Renderer renderer, uint64_t bytesPerFrame);
+GL2D_API void GL2D_MakeRendererCurrent(GL2D_Renderer renderer);
+GL2D_API void GL2D_InvalidateStateCache(GL2D_Renderer renderer);
+GL2D_API GL2D_StateCounters GL2D_GetStateCounters(GL2D_Renderer renderer);
+GL2D_API void GL2D_ResetStateCounters(GL2D_Renderer renderer);
+GL2D_API GL2D_FrameStats GL2D_GetFrameStats(GL2D_Renderer renderer);
+GL2D_API void GL2D_BeginCPUScope(GL2D_Renderer renderer, const char* name);
+GL2D_API void GL2D_EndCPUScope(GL2D_Renderer renderer);
+GL2D_API void GL2D_BeginGPUScope(GL2D_Renderer renderer, const char* name);
+GL2D_API void GL2D_EndGPUScope(GL2D_Renderer renderer);
+GL2D_API uint32_t GL2D_GetProfileScopes(GL2D_Renderer renderer, GL2D_ProfileScope* scopes, uint32_t capacity);
+GL2D_API void GL2D_BeginTrace(GL2D_Renderer renderer);
+GL2D_API bool GL2D_EndTrace(GL2D_Renderer renderer, const char* path);
+GL2D_API uint32_t GL2D_ReportLeaks();
+GL2D_API GL2D_FrameArena GL2D_GetFrameArena(GL2D_Renderer renderer);
+
+GL2D_API void GL2D_BeginBatch(GL2D_Renderer renderer, GL2D_Matrix4f projection);
+GL2D_API void GL2D_DrawQuad(GL2D_Renderer renderer, GL2D_Transform transform, GL2D_Texture texture, GL2D_Color color);
+GL2D_API void GL2D_DrawQuadAffine(GL2D_Renderer renderer, GL2D_Affine2D affine, GL2D_Texture texture, GL2D_Color color);
+GL2D_API void GL2D_DrawQuadUV(GL2D_Renderer renderer, GL2D_Transform transform, GL2D_Texture texture, GL2D_Rectf uv, GL2D_Color color);
+GL2D_API void GL2D_DrawQuadAffineUV(GL2D_Renderer renderer, GL2D_Affine2D affine, GL2D_Texture texture, GL2D_Rectf uv, GL2D_Color color);
+GL2D_API void GL2D_DrawSprite(GL2D_Renderer renderer, GL2D_Transform transform, GL2D_TextureAtlas atlas, GL2D_AtlasRegion region, GL2D_Color color);
+GL2D_API void GL2D_DrawInstanced(GL2D_Renderer renderer, GL2D_Texture texture, const GL2D_SpriteInstance* instances, uint32_t count);
+GL2D_API void GL2D_DrawInstancedWithShader(GL2D_Renderer renderer, GL2D_Shader shader, GL2D_Texture texture, const GL2D_SpriteInstance* instances, uint32_t count);
+GL2D_API void GL2D_EndBatch(GL2D_Renderer renderer);
+
+GL2D_API GL2D_Font GL2D_CreateFontFromFile(const char* path, const GL2D_FontDesc* desc);
+GL2D_API GL2D_Font GL2D_CreateFontFromMemory(const uint8_t* data, uint64_t size, const GL2D_FontDesc* desc);
+GL2D_API void GL2D_DestroyFont(GL2D_Font font);
+GL2D_API GL2D_Texture GL2D_GetFontTexture(GL2D_Font font);
+GL2D_API GL2D_Vector2f GL2D_MeasureText(GL2D_Font font, const char* text, float size);
+GL2D_API void GL2D_DrawText(GL2D_Renderer renderer, GL2D_Font font, const char* text, GL2D_Vector2f position, float size, GL2D_Color color);
 
+GL2D_API void GL2D_DrawLine(GL2D_Renderer renderer, GL2D_Vector2f from, GL2D_Vector2f to, float thickness, GL2D_Color color);
+GL2D_API void GL2D_DrawPolyline(GL2D_Renderer renderer, const GL2D_Vector2f* points, uint32_t count, float thickness, bool closed, GL2D_Color color);
+GL2D_API void GL2D_DrawConvexPolygon(GL2D_Renderer renderer, const GL2D_Vector2f* points, uint32_t count, GL2D_Color color);
+GL2D_API void GL2D_DrawCircle(GL2D_Renderer renderer, GL2D_Vector2f center, float radius, GL2D_Color color);
+GL2D_API void GL2D_DrawCircleOutline(GL2D_Renderer renderer, GL2D_Vector2f center, float radius, float thickness, GL2D_Color color);
+GL2D_API void GL2D_DrawRoundedRect(GL2D_Renderer renderer, GL2D_Rectf rect, float radius, GL2D_Color color);
+GL2D_API void GL2D_DrawRoundedRectOutline(GL2D_Renderer renderer, GL2D_Rectf rect, float radius, float thickness, GL2D_Color color);
+
+GL2D_API GL2D_RenderQueue GL2D_CreateRenderQueue(uint32_t capacity);
+GL2D_API void GL2D_DestroyRenderQueue(GL2D_RenderQueue queue);
+GL2D_API void GL2D_RenderQueuePush(GL2D_RenderQueue queue, const GL2D_DrawCommand* command);
+GL2D_API void GL2D_RenderQueueClear(GL2D_RenderQueue queue);
+GL2D_API uint32_t GL2D_RenderQueueGetCount(GL2D_RenderQueue queue);
+GL2D_API void GL2D_RenderQueueSubmit(GL2D_Renderer renderer, GL2D_RenderQueue queue);
+
+GL2D_API GL2D_CommandBuffer GL2D_CreateCommandBuffer(uint64_t size);
+GL2D_API void GL2D_DestroyCommandBuffer(GL2D_CommandBuffer buffer);
+GL2D_API void GL2D_CommandBufferReset(GL2D_CommandBuffer buffer);
+GL2D_API uint32_t GL2D_CommandBufferGetCount(GL2D_CommandBuffer buffer);
+GL2D_API void GL2D_CommandBufferBindShader(GL2D_CommandBuffer buffer, GL2D_Shader shader);
+GL2D_API void GL2D_CommandBufferBindTexture(GL2D_CommandBuffer buffer, GL2D_Texture texture);
+GL2D_API void GL2D_CommandBufferBindVertexArray(GL2D_CommandBuffer buffer, GL2D_VertexArray vao);
+GL2D_API void GL2D_CommandBufferSetUniformInt(GL2D_CommandBuffer buffer, GL2D_Uniform uniform, int value);
+GL2D_API void GL2D_CommandBufferSetUniformFloat(GL2D_CommandBuffer buffer, GL2D_Uniform uniform, float value);
+GL2D_API void GL2D_CommandBufferSetUniformVec2(GL2D_CommandBuffer buffer, GL2D_Uniform uniform, GL2D_Vector2f value);
+GL2D_API void GL2D_CommandBufferSetUniformMat4(GL2D_CommandBuffer buffer, GL2D_Uniform uniform, GL2D_Matrix4f value);
+GL2D_API void GL2D_CommandBufferDraw(GL2D_CommandBuffer buffer, uint32_t first, uint32_t count);
+GL2D_API void GL2D_CommandBufferDrawIndexed(GL2D_CommandBuffer buffer, uint32_t first, uint32_t count);
+GL2D_API void GL2D_CommandBufferDrawQuad(GL2D_CommandBuffer buffer, GL2D_Affine2D affine, GL2D_Texture texture, GL2D_Rectf uv, GL2D_Color color);
+GL2D_API void GL2D_SubmitCommandBuffers(GL2D_Renderer renderer, const GL2D_CommandBuffer* buffers, uint32_t count);
+
+GL2D_API GL2D_SpatialGrid GL2D_CreateSpatialGrid(GL2D_Rectf bounds, float cellSize);
+GL2D_API void GL2D_DestroySpatialGrid(GL2D_SpatialGrid grid);
+GL2D_API GL2D_SpatialItem GL2D_SpatialGridInsert(GL2D_SpatialGrid grid, GL2D_Rectf bounds, uint32_t userData);
+GL2D_API void GL2D_SpatialGridRemove(GL2D_SpatialGrid grid, GL2D_SpatialItem item);
+GL2D_API void GL2D_SpatialGridMove(GL2D_SpatialGrid grid, GL2D_SpatialItem item, GL2D_Rectf bounds);
+GL2D_API uint32_t GL2D_SpatialGridGetCount(GL2D_SpatialGrid grid);
+GL2D_API uint32_t GL2D_SpatialGridQuery(GL2D_SpatialGrid grid, GL2D_Rectf area, uint32_t* results, uint32_t capacity);
+GL2D_API GL2D_Matrix4f GL2D_CameraGetMatrix(const GL2D_Camera* camera);
+GL2D_API GL2D_Rectf GL2D_CameraGetVisibleRect(const GL2D_Camera* camera);
+GL2D_API uint32_t GL2D_CameraQueryVisible(const GL2D_Camera* camera, GL2D_SpatialGrid grid, uint32_t* results, uint32_t capacity);
+
+GL2D_API GL2D_Tilemap GL2D_CreateTilemap(const GL2D_TilemapDesc* desc);
+GL2D_API void GL2D_DestroyTilemap(GL2D_Tilemap map);
+GL2D_API void GL2D_TilemapSetTile(GL2D_Tilemap map, uint32_t x, uint32_t y, uint16_t tile);
+GL2D_API uint16_t GL2D_TilemapGetTile(GL2D_Tilemap map, uint32_t x, uint32_t y);
+GL2D_API void GL2D_TilemapSetAnimation(GL2D_Tilemap map, uint16_t tile, uint32_t frameCount, float frameDuration);
+GL2D_API void GL2D_TilemapAdvance(GL2D_Tilemap map, float seconds);
+GL2D_API void GL2D_DrawTilemap(GL2D_Renderer renderer, GL2D_Tilemap map, GL2D_Vector2f position);
+
+GL2D_API GL2D_FrameArena GL2D_CreateFrameArena(uint64_t blockSize, uint32_t frameCount);
+GL2D_API void GL2D_DestroyFrameArena(GL2D_FrameArena arena);
+GL2D_API void* GL2D_FrameArenaAlloc(GL2D_FrameArena arena, uint64_t size, uint64_t alignment);
+GL2D_API void GL2D_FrameArenaNextFrame(GL2D_FrameArena arena);
+GL2D_API GL2D_FrameArenaStats GL2D_FrameArenaGetStats(GL2D_FrameArena arena);
+
+GL2D_API GL2D_Shader GL2D_CreateShaderFromSource(const char* vertexSource, const char* fragmentSource);
 GL2D_API GL2D_Shader GL2D_CreateShaderFromFiles(const char* vertexPath, const char* fragmentPath);
 GL2D_API void GL2D_DestroyShader(GL2D_Shader shader);
 GL2D_API void GL2D_BindShader(GL2D_Shader shader);
@@ -172,16 +477,60 @@ GL2D_API void GL2D_ShaderSetInt(GL2D_Shader shader, const char* name, int value)
 GL2D_API void GL2D_ShaderSetFloat(GL2D_Shader shader, const char* name, float value);
 GL2D_API void GL2D_ShaderSetVec2(GL2D_Shader shader, const char* name, GL2D_Vector2f value);
 GL2D_API void GL2D_ShaderSetMat4(GL2D_Shader shader, const char* name, GL2D_Matrix4f value);
+GL2D_API void GL2D_ShaderSetAffine(GL2D_Shader shader, const char* name, GL2D_Affine2D value);
+GL2D_API GL2D_Uniform GL2D_ShaderGetUniform(GL2D_Shader shader, const char* name);
+GL2D_API void GL2D_ShaderSetUniformBool(GL2D_Shader shader, GL2D_Uniform uniform, bool value);
+GL2D_API void GL2D_ShaderSetUniformInt(GL2D_Shader shader, GL2D_Uniform uniform, int value);
+GL2D_API void GL2D_ShaderSetUniformFloat(GL2D_Shader shader, GL2D_Uniform uniform, float value);
+GL2D_API void GL2D_ShaderSetUniformVec2(GL2D_Shader shader, GL2D_Uniform uniform, GL2D_Vector2f value);
+GL2D_API void GL2D_ShaderSetUniformMat4(GL2D_Shader shader, GL2D_Uniform uniform, GL2D_Matrix4f value);
+GL2D_API void GL2D_ShaderSetUniformAffine(GL2D_Shader shader, GL2D_Uniform uniform, GL2D_Affine2D value);
+GL2D_API bool GL2D_ShaderBindUniformBlock(GL2D_Shader shader, const char* blockName, uint32_t binding);
+GL2D_API void GL2D_SetShaderCacheEnabled(bool enabled);
+GL2D_API void GL2D_SetShaderCacheDirectory(const char* directory);
+GL2D_API GL2D_ShaderCacheStats GL2D_GetShaderCacheStats();
+
+GL2D_API GL2D_UniformBuffer GL2D_CreateUniformBuffer(uint64_t size, uint32_t binding);
+GL2D_API void GL2D_DestroyUniformBuffer(GL2D_UniformBuffer ubo);
+GL2D_API void GL2D_UpdateUniformBuffer(GL2D_UniformBuffer ubo, const void* data, uint64_t offset, uint64_t size);
 
 GL2D_API GL2D_Texture GL2D_CreateTextureFromFile(const char* path);
+GL2D_API GL2D_Texture GL2D_CreateTextureFromPixels(const uint8_t* pixels, uint32_t width, uint32_t height);
+GL2D_API GL2D_Texture GL2D_CreateTextureAsync(const char* path);
+GL2D_API bool GL2D_TextureIsReady(GL2D_Texture texture);
+GL2D_API bool GL2D_CookTexture(const char* sourcePath, const char* cookedPath);
+GL2D_API bool GL2D_CookedTextureIsStale(const char* sourcePath, const char* cookedPath);
+GL2D_API GL2D_Texture GL2D_CreateTextureFromCooked(const char* cookedPath);
+GL2D_API GL2D_Texture GL2D_CreateTextureCached(const char* sourcePath, const char* cookedPath);
 GL2D_API void GL2D_DestroyTexture(GL2D_Texture texture);
 GL2D_API void GL2D_BindTexture(GL2D_Texture texture);
 
+GL2D_API GL2D_TextureAtlas GL2D_CreateTextureAtlas(uint32_t pageWidth, uint32_t pageHeight, uint32_t padding);
+GL2D_API void GL2D_DestroyTextureAtlas(GL2D_TextureAtlas atlas);
+GL2D_API GL2D_AtlasRegion GL2D_AtlasAddPixels(GL2D_TextureAtlas atlas, const uint8_t* pixels, uint32_t width, uint32_t height);
+GL2D_API GL2D_AtlasRegion GL2D_AtlasAddFile(GL2D_TextureAtlas atlas, const char* path);
+GL2D_API void GL2D_AtlasRemove(GL2D_TextureAtlas atlas, GL2D_AtlasRegion region);
+GL2D_API GL2D_AtlasSprite GL2D_AtlasGetSprite(GL2D_TextureAtlas atlas, GL2D_AtlasRegion region);
+GL2D_API uint32_t GL2D_AtlasGetPageCount(GL2D_TextureAtlas atlas);
+GL2D_API float GL2D_AtlasGetFragmentation(GL2D_TextureAtlas atlas, uint32_t page);
+GL2D_API void GL2D_AtlasSetRepackThreshold(GL2D_TextureAtlas atlas, float fragmentation);
+GL2D_API void GL2D_AtlasRepack(GL2D_TextureAtlas atlas);
+
+GL2D_API GL2D_AssetFS GL2D_CreateAssetFS(const char* looseRoot);
+GL2D_API void GL2D_DestroyAssetFS(GL2D_AssetFS fs);
+GL2D_API bool GL2D_AssetFSMount(GL2D_AssetFS fs, const char* packPath);
+GL2D_API bool GL2D_AssetFSOpen(GL2D_AssetFS fs, const char* path, GL2D_AssetView* view);
+GL2D_API void GL2D_AssetFSClose(GL2D_AssetFS fs, GL2D_AssetView* view);
+GL2D_API bool GL2D_AssetFSExists(GL2D_AssetFS fs, const char* path);
+GL2D_API GL2D_Shader GL2D_CreateShaderFromAssets(GL2D_AssetFS fs, const char* vertexPath, const char* fragmentPath);
+GL2D_API GL2D_Texture GL2D_CreateTextureFromAsset(GL2D_AssetFS fs, const char* path);
+GL2D_API bool GL2D_WriteAssetPack(const char* packPath, const char* root, const char* const* paths, uint32_t count);
+
 GL2D_API GL2D_VertexArray GL2D_CreateVertexArray();
 GL2D_API void GL2D_DestroyVertexArray(GL2D_VertexArray vao);
 GL2D_API void GL2D_BindVertexArray(GL2D_VertexArray vao);
 
-GL2D_API GL2D_VertexBuffer GL2D_CreateVertexBuffer(const float* vertices, uint64_t size);
+GL2D_API GL2D_VertexBuffer GL2D_CreateVertexBuffer(const void* vertices, uint64_t size);
 GL2D_API void GL2D_DestroyVertexBuffer(GL2D_VertexBuffer vbo);
 GL2D_API void GL2D_BindVertexBuffer(GL2D_VertexBuffer vbo);
 
@@ -189,4 +538,18 @@ GL2D_API GL2D_IndexBuffer GL2D_CreateIndexBuffer(const uint32_t* indices, uint64
 GL2D_API void GL2D_DestroyIndexBuffer(GL2D_IndexBuffer ibo);
 GL2D_API void GL2D_BindIndexBuffer(GL2D_IndexBuffer ibo);
 
+GL2D_API void GL2D_VertexLayoutAdd(GL2D_VertexLayout* layout, uint32_t location, uint32_t type, uint32_t components, bool normalized);
+GL2D_API void GL2D_ConfigureVertexArray(GL2D_VertexArray vao, const GL2D_VertexLayout* layout, GL2D_VertexBuffer vbo, GL2D_IndexBuffer ibo);
+GL2D_API GL2D_VertexArray GL2D_GetVertexArray(const GL2D_VertexLayout* layout, GL2D_VertexBuffer vbo, GL2D_IndexBuffer ibo);
+GL2D_API uint16_t GL2D_FloatToHalf(float value);
+
+GL2D_API GL2D_StreamBuffer GL2D_CreateStreamBuffer(uint32_t type, uint64_t size);
+GL2D_API void GL2D_DestroyStreamBuffer(GL2D_StreamBuffer stream);
+GL2D_API void* GL2D_StreamBufferMap(GL2D_StreamBuffer stream, uint64_t size, uint64_t alignment, uint64_t* offset);
+GL2D_API void GL2D_StreamBufferUnmap(GL2D_StreamBuffer stream);
+GL2D_API bool GL2D_StreamBufferWrite(GL2D_StreamBuffer stream, const void* data, uint64_t size, uint64_t alignment, uint64_t* offset);
+GL2D_API void GL2D_StreamBufferEndFrame(GL2D_StreamBuffer stream);
+GL2D_API void GL2D_BindStreamBuffer(GL2D_StreamBuffer stream);
+GL2D_API GL2D_StreamBufferStats GL2D_GetStreamBufferStats(GL2D_StreamBuffer stream);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,13 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec4 ourColor;
+in vec2 TexCoord;
+
+// texture sampler
+uniform sampler2D tex;
+
+void main()
+{
+	FragColor = texture(tex, TexCoord) * ourColor;
+}
\ No newline at end of file
@@ -0,0 +1,20 @@
+#version 330 core
+layout (location = 0) in vec2 aCorner;
+layout (location = 1) in vec4 aAxes;
+layout (location = 2) in vec2 aTranslation;
+layout (location = 3) in vec4 aUV;
+layout (location = 4) in vec4 aColor;
+
+out vec4 ourColor;
+out vec2 TexCoord;
+
+uniform mat4 projection;
+
+void main()
+{
+	// the quad corner is placed by the instance affine: x axis, y axis, then translation
+	vec2 position = aTranslation + aAxes.xy * aCorner.x + aAxes.zw * aCorner.y;
+	gl_Position = projection * vec4(position, 0.0, 1.0);
+	ourColor = aColor;
+	TexCoord = aUV.xy + (aCorner + 0.5) * aUV.zw;
+}
\ No newline at end of file
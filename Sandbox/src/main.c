@@ -30,6 +30,12 @@ const char* fragmentShaderSource = "#version 330 core\n"
     "FragColor = texture(texture1, TexCoord);\n"
 "}";
 
+typedef struct SpriteVertex {
+    float position[2];
+    uint16_t texCoord[2];
+    GL2D_Color color;
+} SpriteVertex;
+
 // settings
 const unsigned int SCR_WIDTH = 800;
 const unsigned int SCR_HEIGHT = 600;
@@ -64,12 +70,13 @@ int main() {
 
     // set up vertex data (and buffer(s)) and configure vertex attributes
     // ------------------------------------------------------------------
-    float vertices[] = {
-         // positions       // colors         // texture coords
-         0.0f, 1.0f, 0.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, // top right
-         0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f, 1.0f, 0.0f, // bottom right
-        -1.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f, 0.0f, 0.0f, // bottom left
-        -1.0f, 1.0f, 0.0f, 1.0f, 1.0f, 1.0f, 0.0f, 1.0f, // top left 
+    // 16 bytes a vertex: float position, normalized uint16 texture coords, uint8 color
+    SpriteVertex vertices[] = {
+        // positions     // texture coords  // colors
+        { {  0.0f, 1.0f }, { 65535, 65535 }, { 255, 255, 255, 255 } }, // top right
+        { {  0.0f, 0.0f }, { 65535, 0 },     { 255, 255, 255, 255 } }, // bottom right
+        { { -1.0f, 0.0f }, { 0, 0 },         { 255, 255, 255, 255 } }, // bottom left
+        { { -1.0f, 1.0f }, { 0, 65535 },     { 255, 255, 255, 255 } }, // top left 
     };
 
     unsigned int indices[] = {
@@ -77,19 +84,19 @@ int main() {
         1, 2, 3  // second triangle
     };
 
-    GL2D_VertexArray VAO = GL2D_CreateVertexArray();
     GL2D_VertexBuffer VBO = GL2D_CreateVertexBuffer(vertices, sizeof(vertices));
     GL2D_IndexBuffer IBO = GL2D_CreateIndexBuffer(indices, sizeof(indices));
 
+    GL2D_VertexLayout layout = { 0 };
     // position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    // color attribute
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
+    GL2D_VertexLayoutAdd(&layout, 0, GL2D_ATTRIBUTE_FLOAT, 2, false);
     // texture coord attribute
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
-    glEnableVertexAttribArray(2);
+    GL2D_VertexLayoutAdd(&layout, 2, GL2D_ATTRIBUTE_UINT16, 2, true);
+    // color attribute
+    GL2D_VertexLayoutAdd(&layout, 1, GL2D_ATTRIBUTE_UINT8, 4, true);
+
+    // owned by the renderer's cache, it goes away with VBO/IBO
+    GL2D_VertexArray VAO = GL2D_GetVertexArray(&layout, VBO, IBO);
 
     // load and create a texture 
     // -------------------------
@@ -174,7 +181,6 @@ int main() {
 
     // optional: de-allocate all resources once they've outlived their purpose:
     // ------------------------------------------------------------------------
-    GL2D_DestroyVertexArray(VAO);
     GL2D_DestroyVertexBuffer(VBO);
     GL2D_DestroyIndexBuffer(IBO);
     GL2D_DestroyShader(shader);
@@ -29,18 +29,20 @@ workspace "GL2D"
             "%{prj.name}/external/%{cfg.system}-%{cfg.architecture}"
         }
 
-        links {
-            "GL2D/external/%{cfg.system}-%{cfg.architecture}/glad/glad",
-            "GL2D/external/%{cfg.system}-%{cfg.architecture}/stb/stb_image",
-        }
-
         filter "system:windows"
             links {
+                "GL2D/external/%{cfg.system}-%{cfg.architecture}/glad/glad",
+                "GL2D/external/%{cfg.system}-%{cfg.architecture}/stb/stb_image",
                 "opengl32",
                 "gdi32",
                 "user32",
             }   
 
+        filter "system:linux"
+            -- no prebuilt libraries here, glad is compiled in and stb is implemented by gl2d.c
+            files { "%{prj.name}/external/%{cfg.system}-%{cfg.architecture}/glad/glad.c" }
+            links { "pthread", "dl" }
+
         filter "configurations:Debug"
             defines { "GL2D_DEBUG" }
             symbols "On"
@@ -123,3 +125,117 @@ workspace "GL2D"
             defines { "GL2D_RELEASE" }
             symbols "Off"
             optimize "Full"
+
+    -- //Bench// --
+    project "Bench"
+        location "Bench"
+        kind "ConsoleApp"
+        language "C"
+        cdialect "C99"
+
+        targetdir ("bin/" .. output_dir .. "/%{prj.name}")
+        objdir ("bin-int/" .. output_dir .. "/%{prj.name}")
+
+        files {
+            "%{prj.name}/src/**.h",
+            "%{prj.name}/src/**.c",
+        }
+
+        includedirs {
+            "GL2D/src",
+            "%{prj.name}/src",
+        }
+
+        links {
+            "GL2D",
+        }
+
+        filter "system:windows"
+            systemversion "latest"
+
+        filter "system:linux"
+            -- headless runs use EGL so CI machines need no GPU or display (Mesa llvmpipe)
+            links { "m", "pthread", "dl", "EGL" }
+
+        filter "platforms:*32"
+            architecture "x32"
+
+        filter "platforms:*64"
+            architecture "x64"
+
+        filter { "platforms:Shared*", "system:windows" }
+            postbuildcommands {
+                "{COPYFILE} ../bin/" .. output_dir .. "/GL2D/GL2D.dll ../bin/" .. output_dir .. "/%{prj.name}"
+            }
+
+        filter "configurations:Debug"
+            defines { "GL2D_DEBUG" }
+            symbols "On"
+            optimize "Off"
+            
+        filter "configurations:Dev"
+            defines { "GL2D_DEV" }
+            symbols "On"
+            optimize "Debug"
+
+        filter "configurations:Release"
+            defines { "GL2D_RELEASE" }
+            symbols "Off"
+            optimize "Full"
+
+    -- //Cook// --
+    project "Cook"
+        location "Cook"
+        kind "ConsoleApp"
+        targetname "gl2d-cook"
+        language "C"
+        cdialect "C99"
+
+        targetdir ("bin/" .. output_dir .. "/%{prj.name}")
+        objdir ("bin-int/" .. output_dir .. "/%{prj.name}")
+
+        files {
+            "%{prj.name}/src/**.h",
+            "%{prj.name}/src/**.c",
+        }
+
+        includedirs {
+            "GL2D/src",
+            "%{prj.name}/src",
+        }
+
+        links {
+            "GL2D",
+        }
+
+        filter "system:windows"
+            systemversion "latest"
+
+        filter "system:linux"
+            links { "m", "pthread", "dl" }
+
+        filter "platforms:*32"
+            architecture "x32"
+
+        filter "platforms:*64"
+            architecture "x64"
+
+        filter { "platforms:Shared*", "system:windows" }
+            postbuildcommands {
+                "{COPYFILE} ../bin/" .. output_dir .. "/GL2D/GL2D.dll ../bin/" .. output_dir .. "/%{prj.name}"
+            }
+
+        filter "configurations:Debug"
+            defines { "GL2D_DEBUG" }
+            symbols "On"
+            optimize "Off"
+            
+        filter "configurations:Dev"
+            defines { "GL2D_DEV" }
+            symbols "On"
+            optimize "Debug"
+
+        filter "configurations:Release"
+            defines { "GL2D_RELEASE" }
+            symbols "Off"
+            optimize "Full"